@@ -6,7 +6,7 @@
     Author: Bret Bouchard
 
     Pure DSP implementation of Drum Machine
-    - Step sequencer with 16 tracks x 16 steps
+    - Step sequencer with 16 tracks, up to 128 steps each (per-track lengths)
     - Synthesized drum voices (kick, snare, hihat, clap, etc.)
     - Flam, roll, probability, and swing
     - Multiple drum kit types
@@ -22,33 +22,180 @@
 #include "dsp/InstrumentDSP.h"
 #include <vector>
 #include <array>
+#include <tuple>
+#include <utility>
+#include <cstdint>
 #include <memory>
+#include <atomic>
 #include <cmath>
 #include <functional>
 #include <algorithm>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <chrono>
+
+// Debug builds can assert that process()/processStereo() never touch the heap
+#ifndef DRUMMACHINE_ASSERT_NO_ALLOC
+ #define DRUMMACHINE_ASSERT_NO_ALLOC 0
+#endif
+
+// Render timing counters (getRenderProfile); 0 compiles them out
+#ifndef DRUMMACHINE_PROFILING
+ #define DRUMMACHINE_PROFILING 1
+#endif
 
 namespace DSP {
 
+// Marks a render call. With DRUMMACHINE_ASSERT_NO_ALLOC enabled, any global
+// operator new inside the scope asserts; otherwise it compiles away.
+struct RealtimeNoAllocScope
+{
+#if DRUMMACHINE_ASSERT_NO_ALLOC
+    RealtimeNoAllocScope();
+    ~RealtimeNoAllocScope();
+    static bool isActive();
+#else
+    RealtimeNoAllocScope() {}
+#endif
+};
+
+//==============================================================================
+// Lookup Tables
+//==============================================================================
+
+// Immutable tables shared by every instance in the process, built once on
+// first use (a function-local static, so thread-safe). Values between
+// points are interpolated.
+struct DrumLookupTables
+{
+    static constexpr int kSineSize = 2048;  // Points per cycle (power of two)
+    static constexpr int kPanSize = 129;    // Constant-power pan law across pan -1..1
+
+    static const DrumLookupTables& get();
+
+    // sin(2 pi * cycles), for any cycles
+    float sineCycles(float cycles) const
+    {
+        const float position = cycles * kSineSize;
+        int index = static_cast<int>(position);
+        index -= (position < static_cast<float>(index)) ? 1 : 0;  // Floor for negative phases
+        const float frac = position - static_cast<float>(index);
+        index &= kSineSize - 1;
+        return sine[index] + (sine[index + 1] - sine[index]) * frac;
+    }
+
+    float sine[kSineSize + 1];  // One cycle plus its wrap point
+    float panLeft[kPanSize];    // Gains at pan -1 ... 1
+    float panRight[kPanSize];
+
+private:
+    DrumLookupTables();
+};
+
 //==============================================================================
 // Synthesized Drum Voices
 //==============================================================================
 
+// Voice coefficients are authored per sample at kVoiceReferenceRate and
+// rescaled in prepare(), so envelopes keep their times at any sample rate.
+// Envelope levels, smoother targets and the sleep check run at control
+// rate, once per kVoiceControlBlock samples.
+static constexpr double kVoiceReferenceRate = 48000.0;
+static constexpr int kVoiceControlBlock = 32;
+
+// One-pole smoother (y = pole * y + (1 - pole) * x) fed by an input that
+// decays exponentially (x *= decay), both per sample. The output is the sum
+// of a mode decaying with the pole and one following the input: begin()
+// splits it once per control block and each sample only scales the modes.
+struct ControlSmoother
+{
+    void setup(float newPole, float newDecay);
+    void reset(float y = 0.0f) { transient = y; steady = 0.0f; }
+
+    void begin(float x)
+    {
+        const float y = transient + steady;
+        steady = coupling * x;
+        transient = y - steady;
+    }
+
+    float next()
+    {
+        transient *= pole;
+        steady *= decay;
+        return transient + steady;
+    }
+
+    float value() const { return transient + steady; }
+
+    float pole = 0.0f;
+    float decay = 1.0f;
+    float decayN = 1.0f;    // Input decay over a control block
+    float coupling = 1.0f;  // (1 - pole) / (decay - pole)
+    float transient = 0.0f;
+    float steady = 0.0f;
+};
+
+// Counter-based random numbers: value n of a stream is a hash of the
+// stream key and n (a SplitMix-style Weyl step through a lowbias32
+// finalizer). Any position is reachable directly, and neighbouring values
+// carry no dependency, so block fills vectorize.
+struct RandomStream
+{
+    static constexpr uint32_t kWeyl = 0x9e3779b9u;
+
+    static uint32_t mix(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Key for one stream of a seed (e.g. a track) at one position (a bar)
+    static uint32_t makeKey(uint32_t seed, uint32_t stream, uint32_t position = 0)
+    {
+        return mix(mix(seed + stream * kWeyl) ^ (position * 0x85ebca6bu + 1u));
+    }
+
+    static uint32_t at(uint32_t key, uint32_t counter) { return mix(key + counter * kWeyl); }
+
+    static float toUnit(uint32_t x) { return static_cast<float>(x >> 8) * (1.0f / 16777216.0f); }   // [0, 1)
+    static float toSigned(uint32_t x) { return static_cast<float>(x >> 8) * (2.0f / 16777216.0f) - 1.0f; }   // [-1, 1)
+
+    // Values counter ... counter + numValues - 1 as noise in [-1, 1); counter
+    // moves past them
+    static void fillSigned(uint32_t key, uint32_t& counter, float* out, int numValues);
+};
+
 // Kick Drum (sine wave + pitch envelope + transient) - Enhanced
 struct KickVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return amplitude > 0.0001f; }
+    float getLevel() const { return amplitude; }
 
     void setPitch(float pitch);      // Base pitch
     void setDecay(float decay);      // Decay time
     void setClick(float click);      // Transient amount
 
 private:
+    friend struct KickVoiceBank;
+    void updateControl();  // Start of each control block
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
+    float invSampleRate = 1.0f / 48000.0f;
 
     // Oscillator
     float phase = 0.0f;
@@ -57,7 +204,9 @@ private:
     // Pitch envelope
     float pitchEnvelope = 0.0f;
     float pitchDecay = 0.99f;
+    float pitchTailDecay = 0.992f;  // At sampleRate
     float pitchAmount = 0.0f;
+    bool pitchTail = false;         // Past the fast initial drop
 
     // Amplitude envelope
     float amplitude = 0.0f;
@@ -66,37 +215,100 @@ private:
     // Transient
     float transientPhase = 0.0f;
     float transientAmount = 0.3f;
+    float transientStep = 0.08f;
 
     // Parameter smoothing (prevent zipper noise)
-    float pitchSmoothing = 0.0f;
-    float amplitudeSmoothing = 0.0f;
+    float pitchPole = 0.95f;
+    float amplitudePole = 0.9f;
+    ControlSmoother pitchSmoother;  // Pitch above frequency
+    ControlSmoother amplitudeSmoother;
+    int controlCountdown = 0;
+};
+
+// Kick voices of many instances rendered side by side (DrumMachineBatch).
+// add() copies a playing voice's per-sample state into a lane; lanes sit
+// in groups of four with every field four wide, so the envelope and
+// oscillator steps of a group run as one vector operation. The table
+// lookups stay per lane, and control blocks go back to the voice itself.
+// Each lane adds into its output in the order it was added, so the result
+// matches rendering the voices one by one.
+struct KickVoiceBank
+{
+    void allocate(int maxLanes);  // Not real-time safe
+    int getNumLanes() const { return numLanes_; }
+
+    bool add(KickVoice& voice, float* output);  // false: the bank is full
+    void render(int numSamples);  // Renders, writes back and empties every lane
+
+private:
+    static constexpr int kGroupLanes = 4;
+
+    struct LaneGroup
+    {
+        // KickVoice state, one entry per lane
+        float phase[kGroupLanes] = {};
+        float frequency[kGroupLanes] = {};
+        float invSampleRate[kGroupLanes] = {};
+        float pitchPole[kGroupLanes] = {};  // pitchSmoother
+        float pitchDecay[kGroupLanes] = {};
+        float pitchTransient[kGroupLanes] = {};
+        float pitchSteady[kGroupLanes] = {};
+        float amplitudePole[kGroupLanes] = {};  // amplitudeSmoother
+        float amplitudeDecay[kGroupLanes] = {};
+        float amplitudeTransient[kGroupLanes] = {};
+        float amplitudeSteady[kGroupLanes] = {};
+        float transientPhase[kGroupLanes] = {};
+        float transientAmount[kGroupLanes] = {};
+        float transientStep[kGroupLanes] = {};
+    };
+
+    void renderGroup(int groupIndex, int start, int numSamples);  // Within one control block
+    void load(int lane);   // Lane state from its voice
+    void store(int lane);  // And back
+    void clearLane(int lane);
+
+    std::vector<LaneGroup> groups_;
+    std::vector<KickVoice*> voices_;  // nullptr once the voice sleeps
+    std::vector<float*> outputs_;
+    std::vector<int> controlCountdown_;
+    int numLanes_ = 0;
 };
 
 // Snare Drum (tuned noise + tone + snap) - Enhanced
 struct SnareVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return toneAmplitude > 0.0001f || noiseAmplitude > 0.0001f || snapAmplitude > 0.0001f; }
+    float getLevel() const { return std::max(toneAmplitude, std::max(noiseAmplitude, snapAmplitude)); }
 
     void setTone(float tone);        // Filter resonance
     void setDecay(float decay);      // Noise decay
     void setSnap(float snap);        // Transient snap
 
 private:
+    void updateControl();  // Start of each control block
+    void setNoiseDecay(float newDecay);
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
 
     // Tone (triangle wave)
     float tonePhase = 0.0f;
     float toneFreq = 180.0f;
+    float toneIncrement = 180.0f / 48000.0f;
     float toneAmplitude = 0.0f;
     float toneDecay = 0.99f;
 
     // Noise (filtered)
     float noiseAmplitude = 0.0f;
     float noiseDecay = 0.995f;
+    float noiseDecayRate = 0.995f;  // At sampleRate
+    float noiseDecayN = 1.0f;       // Over a control block
+    float noiseGain = 0.0f;         // Per sample within a control block
 
     // Filter state
     float filterState = 0.0f;
@@ -108,30 +320,40 @@ private:
 
     // Snare rattle (snares buzzing)
     float rattlePhase = 0.0f;
+    float rattleDecay = 0.994f;
+    bool rattling = false;  // Rattle draws its own noise this control block
 
     // Parameter smoothing (prevent zipper noise)
-    float filterSmoothing = 0.0f;
-    float toneSmoothing = 0.0f;
-
-    // PRNG state (deterministic)
-    mutable unsigned noiseSeed = 42;
+    float tonePole = 0.9f;
+    ControlSmoother filterSmoother;
+    ControlSmoother toneSmoother;
+    int controlCountdown = 0;
+
+    // Noise stream (deterministic)
+    static constexpr uint32_t kNoiseKey = 42u;
+    uint32_t noiseCounter = 0;
 };
 
 // Hi-Hat (high-pass filtered noise + metallic) - Enhanced
 struct HiHatVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return amplitude > 0.0001f; }
+    float getLevel() const { return amplitude; }
 
     void setTone(float tone);        // High-pass frequency
     void setDecay(float decay);      // Decay time
     void setMetallic(float metallic); // Metallic overtones
 
 private:
+    void updateControl();  // Start of each control block
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
 
     // Noise source
     float noisePhase = 0.0f;
@@ -149,30 +371,39 @@ private:
     float metalPhase2 = 0.0f;
     float metalPhase3 = 0.0f;
     float metalAmount = 0.1f;
+    float metalIncrement[3] = { 0.7f, 0.53f, 1.1f };
 
     // Parameter smoothing (prevent zipper noise)
-    float filterSmoothing = 0.0f;
-    float amplitudeSmoothing = 0.0f;
-
-    // PRNG state (deterministic)
-    mutable unsigned noiseSeed = 43;
+    float amplitudePole = 0.9f;
+    ControlSmoother filterSmoother;
+    ControlSmoother amplitudeSmoother;
+    int controlCountdown = 0;
+
+    // Noise stream (deterministic)
+    static constexpr uint32_t kNoiseKey = 43u;
+    uint32_t noiseCounter = 0;
 };
 
 // Clap (filtered noise bursts) - Enhanced
 struct ClapVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return amplitude > 0.0001f; }
+    float getLevel() const { return amplitude; }
 
     void setTone(float tone);        // Filter frequency
     void setDecay(float decay);      // Decay time
     void setNumImpulses(int num);    // Number of impulses
 
 private:
+    void updateControl();  // Start of each control block
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
 
     // Multiple noise bursts
     float amplitude = 0.0f;
@@ -181,34 +412,44 @@ private:
     int currentImpulse = 0;
     int impulseCounter = 0;
     int impulseSpacing = 500;
+    int impulseStagger = 100;
 
     // Filter
     float filterState = 0.0f;
     float filterCoeff = 0.6f;
 
     // Parameter smoothing (prevent zipper noise)
-    float filterSmoothing = 0.0f;
-    float amplitudeSmoothing = 0.0f;
-
-    // PRNG state (deterministic)
-    mutable unsigned noiseSeed = 44;
+    float amplitudePole = 0.9f;
+    ControlSmoother filterSmoother;
+    ControlSmoother amplitudeSmoother;
+    int controlCountdown = 0;
+
+    // Noise stream (deterministic)
+    static constexpr uint32_t kNoiseKey = 44u;
+    uint32_t noiseCounter = 0;
 };
 
 // Percussion (tom/cowbell type) - Enhanced
 struct PercVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return amplitude > 0.0001f; }
+    float getLevel() const { return amplitude; }
 
     void setPitch(float pitch);
     void setDecay(float decay);
     void setTone(float tone);        // Tone vs noise mix
 
 private:
+    void updateControl();  // Start of each control block
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
+    float invSampleRate = 1.0f / 48000.0f;
 
     // Tone (sine wave)
     float phase = 0.0f;
@@ -224,34 +465,44 @@ private:
     float noiseAmplitude = 0.0f;
 
     // Parameter smoothing (prevent zipper noise)
-    float pitchSmoothing = 0.0f;
-    float amplitudeSmoothing = 0.0f;
-
-    // PRNG state (deterministic)
-    mutable unsigned noiseSeed = 45;
+    float amplitudePole = 0.9f;
+    ControlSmoother pitchSmoother;
+    ControlSmoother amplitudeSmoother;
+    int controlCountdown = 0;
+
+    // Noise stream (deterministic)
+    static constexpr uint32_t kNoiseKey = 45u;
+    uint32_t noiseCounter = 0;
 };
 
 // Cymbal (metallic noise with long decay) - Enhanced
 struct CymbalVoice
 {
-    void prepare(double sampleRate);
+    void prepare(double newSampleRate);
     void reset();
     void trigger(float velocity);
     float processSample();
+    void processBlock(float* output, int numSamples);  // Adds into output
     bool isActive() const { return masterAmplitude > 0.0001f; }
+    float getLevel() const { return masterAmplitude; }
 
     void setTone(float tone);        // Brightness
     void setDecay(float decay);      // Long decay
     void setMetallic(float metallic); // FM modulation depth
 
 private:
+    void updateControl();  // Start of each control block
+
     double sampleRate = 48000.0;
+    float rateScale = 1.0f;  // kVoiceReferenceRate / sampleRate
+    float invSampleRate = 1.0f / 48000.0f;
 
     // Multiple oscillators for metallic sound
     static constexpr int numOscillators = 6;
     float phases[numOscillators] = {0};
     float frequencies[numOscillators] = {0};
     float amplitudes[numOscillators] = {0};
+    float baseIncrements[numOscillators] = {0};  // frequencies / sampleRate
 
     // Amplitude envelope
     float masterAmplitude = 0.0f;
@@ -261,9 +512,258 @@ private:
     float fmDepth = 0.0f;
     float fmPhase = 0.0f;
     float fmPhase2 = 0.0f;  // Second FM oscillator for richer metallic sound
+    float fmIncrement = 0.08f;
+    float fmIncrement2 = 0.13f;
+    float partialFmDepth[numOscillators] = {0};
 
     // Parameter smoothing (prevent zipper noise)
-    float amplitudeSmoothing = 0.0f;
+    float amplitudePole = 0.95f;
+    ControlSmoother amplitudeSmoother;
+    int controlCountdown = 0;
+};
+
+//==============================================================================
+// Polyphonic Voice Pool
+//==============================================================================
+
+// Velocity layers per voice group in the hit cache, at velocities
+// 1/kHitCacheLayers ... 1
+static constexpr int kHitCacheLayers = 8;
+
+// One pre-rendered hit (HitCache): a fresh voice triggered at velocity
+struct HitCacheLayer
+{
+    const float* samples = nullptr;
+    int length = 0;
+    float velocity = 1.0f;
+};
+
+// Voice stealing policy when every voice in a pool is sounding
+enum class VoiceStealMode : uint8_t
+{
+    Oldest,    // steal the voice triggered longest ago
+    Quietest   // steal the voice with the lowest envelope level
+};
+
+// Preallocated voice pool for one drum voice type. Voices are tagged with the
+// track that triggered them so tracks sharing a voice type render only their
+// own hits, and only voices on the active list are processed.
+template <typename Voice>
+class VoicePool
+{
+public:
+    static constexpr int kMaxVoices = 8;
+
+    void prepare(double sampleRate)
+    {
+        for (auto& v : voices_)
+            v.prepare(sampleRate);
+        numActive_ = 0;
+    }
+
+    void reset()
+    {
+        for (auto& v : voices_)
+            v.reset();
+        numActive_ = 0;
+    }
+
+    void setPolyphony(int numVoices) { polyphony_ = std::max(1, std::min(kMaxVoices, numVoices)); }
+    int getPolyphony() const { return polyphony_; }
+
+    void setStealMode(VoiceStealMode mode) { stealMode_ = mode; }
+    VoiceStealMode getStealMode() const { return stealMode_; }
+
+    // Pre-rendered hits, one per velocity layer (kHitCacheLayers), or
+    // nullptr to synthesize. Voices already playing keep their source.
+    void setHitCache(const HitCacheLayer* layers) { cache_ = layers; }
+
+    void trigger(int trackIndex, float velocity)
+    {
+        const int index = allocateVoice();
+        owner_[index] = static_cast<int8_t>(trackIndex);
+        startOrder_[index] = ++triggerCounter_;
+
+        CachedHit& cached = cached_[index];
+        cached.samples = nullptr;
+        if (cache_ == nullptr)
+        {
+            voices_[index].trigger(velocity);
+            return;
+        }
+
+        // Nearest layer, scaled to the hit's velocity
+        const HitCacheLayer& layer = cache_[selectCacheLayer(velocity)];
+        cached.samples = layer.samples;
+        cached.length = layer.length;
+        cached.position = 0;
+        cached.gain = velocity / layer.velocity;
+        voices_[index].reset();
+    }
+
+    // Adds every active voice owned by trackIndex into output
+    void render(int trackIndex, float* output, int numSamples)
+    {
+        for (int a = 0; a < numActive_; ++a)
+        {
+            const int index = activeList_[a];
+            if (owner_[index] != trackIndex)
+                continue;
+
+            CachedHit& cached = cached_[index];
+            if (cached.samples == nullptr)
+            {
+                voices_[index].processBlock(output, numSamples);
+                continue;
+            }
+
+            const int count = std::min(numSamples, cached.length - cached.position);
+            const float* input = cached.samples + cached.position;
+            for (int i = 0; i < count; ++i)
+                output[i] += input[i] * cached.gain;
+            cached.position += count;
+        }
+        compactActiveList();
+    }
+
+    // Silence every voice owned by trackIndex (e.g. when the track changes type)
+    void stopTrack(int trackIndex)
+    {
+        int write = 0;
+        for (int a = 0; a < numActive_; ++a)
+        {
+            const int index = activeList_[a];
+            if (owner_[index] == trackIndex)
+            {
+                voices_[index].reset();
+                cached_[index].samples = nullptr;
+            }
+            else
+                activeList_[write++] = static_cast<uint8_t>(index);
+        }
+        numActive_ = write;
+    }
+
+    int getActiveCount() const { return numActive_; }
+    bool hasActiveVoices() const { return numActive_ > 0; }
+
+    // Voices playing a pre-rendered hit
+    int getCachedActiveCount() const
+    {
+        int count = 0;
+        for (int a = 0; a < numActive_; ++a)
+            if (cached_[activeList_[a]].samples != nullptr)
+                ++count;
+        return count;
+    }
+
+    // Apply a parameter change to every voice in the pool
+    template <typename Fn>
+    void forEachVoice(Fn&& fn)
+    {
+        for (auto& v : voices_)
+            fn(v);
+    }
+
+    // For kernels that render the pool's voices outside render():
+    // fn(voice, trackIndex) for every active voice in render order, then
+    // releaseFinishedVoices() where render() would compact
+    template <typename Fn>
+    void forEachActiveVoice(Fn&& fn)
+    {
+        for (int a = 0; a < numActive_; ++a)
+            fn(voices_[activeList_[a]], static_cast<int>(owner_[activeList_[a]]));
+    }
+
+    void releaseFinishedVoices() { compactActiveList(); }
+    bool hasHitCache() const { return cache_ != nullptr; }
+
+private:
+    int allocateVoice()
+    {
+        // Free voice within the configured polyphony
+        for (int i = 0; i < polyphony_; ++i)
+        {
+            if (!isOnActiveList(i))
+            {
+                activeList_[numActive_++] = static_cast<uint8_t>(i);
+                return i;
+            }
+        }
+
+        // All busy: steal
+        int victim = activeList_[0];
+        for (int a = 1; a < numActive_; ++a)
+        {
+            const int index = activeList_[a];
+            const bool better = (stealMode_ == VoiceStealMode::Oldest)
+                              ? startOrder_[index] < startOrder_[victim]
+                              : getLevel(index) < getLevel(victim);
+            if (better)
+                victim = index;
+        }
+        return victim;
+    }
+
+    bool isOnActiveList(int index) const
+    {
+        for (int a = 0; a < numActive_; ++a)
+            if (activeList_[a] == index)
+                return true;
+        return false;
+    }
+
+    void compactActiveList()
+    {
+        int write = 0;
+        for (int a = 0; a < numActive_; ++a)
+        {
+            const int index = activeList_[a];
+            if (isVoiceActive(index))
+                activeList_[write++] = static_cast<uint8_t>(index);
+        }
+        numActive_ = write;
+    }
+
+    struct CachedHit
+    {
+        const float* samples = nullptr;  // nullptr: the voice synthesizes
+        int length = 0;
+        int position = 0;
+        float gain = 1.0f;
+    };
+
+    bool isVoiceActive(int index) const
+    {
+        const CachedHit& cached = cached_[index];
+        return cached.samples != nullptr ? cached.position < cached.length : voices_[index].isActive();
+    }
+
+    // Cached hits have no envelope to read; the remaining fraction stands in
+    float getLevel(int index) const
+    {
+        const CachedHit& cached = cached_[index];
+        if (cached.samples == nullptr)
+            return voices_[index].getLevel();
+        return cached.gain * static_cast<float>(cached.length - cached.position) / static_cast<float>(std::max(1, cached.length));
+    }
+
+    static int selectCacheLayer(float velocity)
+    {
+        const int layer = static_cast<int>(velocity * kHitCacheLayers + 0.5f) - 1;
+        return std::max(0, std::min(kHitCacheLayers - 1, layer));
+    }
+
+    std::array<Voice, kMaxVoices> voices_{};
+    std::array<CachedHit, kMaxVoices> cached_{};
+    const HitCacheLayer* cache_ = nullptr;
+    std::array<int8_t, kMaxVoices> owner_{};
+    std::array<uint32_t, kMaxVoices> startOrder_{};
+    std::array<uint8_t, kMaxVoices> activeList_{};
+    int numActive_ = 0;
+    int polyphony_ = 4;
+    uint32_t triggerCounter_ = 0;
+    VoiceStealMode stealMode_ = VoiceStealMode::Oldest;
 };
 
 //==============================================================================
@@ -306,32 +806,42 @@ struct DillaParams
 // Drill Mode (Aphex Twin / Drill'n'Bass)
 //==============================================================================
 
-// Deterministic RNG for drill mode
+// Deterministic RNG for drill mode, probability and drift. Draws come from
+// a RandomStream, generated kBlock values at a time; seek() jumps to any
+// stream and position.
 struct DeterministicRng
 {
-    uint32_t s = 0x12345678u;
-    explicit DeterministicRng(uint32_t seed = 0x12345678u) : s(seed ? seed : 0x12345678u) {}
+    static constexpr int kBlock = 16;
+
+    explicit DeterministicRng(uint32_t newKey = 0x12345678u) { seek(newKey); }
+
+    void seek(uint32_t newKey, uint32_t newCounter = 0)
+    {
+        key = newKey;
+        counter = newCounter;
+        index = kBlock;
+    }
 
     uint32_t nextU32()
     {
-        // xorshift32
-        uint32_t x = s;
-        x ^= x << 13;
-        x ^= x >> 17;
-        x ^= x << 5;
-        s = x;
-        return x;
+        if (index == kBlock)
+        {
+            for (int k = 0; k < kBlock; ++k)
+                block[k] = RandomStream::at(key, counter + static_cast<uint32_t>(k));
+            counter += kBlock;
+            index = 0;
+        }
+        return block[index++];
     }
 
     float next01()
     {
-        // [0,1)
-        return (nextU32() >> 8) * (1.0f / 16777216.0f);
+        return RandomStream::toUnit(nextU32());
     }
 
     float nextSigned()
     {
-        return (next01() * 2.0f) - 1.0f; // [-1,1)
+        return RandomStream::toSigned(nextU32());
     }
 
     int rangeInt(int lo, int hiInclusive)
@@ -340,6 +850,11 @@ struct DeterministicRng
         const uint32_t span = (uint32_t)(hiInclusive - lo + 1);
         return lo + (int)(nextU32() % span);
     }
+
+    uint32_t key = 0;
+    uint32_t counter = 0;  // Stream position of the next block
+    int index = kBlock;
+    uint32_t block[kBlock] = {};
 };
 
 // Drill grid subdivision types
@@ -382,48 +897,93 @@ struct DrillMode
 // Drill Intensity Automation (Compositional Sequencing)
 //==============================================================================
 
-// Automation point for drill amount over time
-struct DrillAutomationPoint
+// Automation point: an amount (0..1) that holds from its bar on
+struct BarAutomationPoint
 {
     int bar = 0;         // Bar index (0-based)
-    float amount = 0.0f; // Drill amount 0..1
+    float amount = 0.0f; // Drill, swing or Dilla amount 0..1
 };
 
-// Automation lane for drill intensity as composition
-struct DrillAutomationLane
+// Per-bar automation lane (drill intensity, swing, Dilla amount). Edited on
+// the editor thread as part of a SequencerSnapshot and published as one
+// batch; the audio thread only evaluates it, once per bar.
+struct BarAutomationLane
 {
-    std::vector<DrillAutomationPoint> points; // Sorted by bar
+    static constexpr size_t kDefaultCapacity = 64;
+
+    std::vector<BarAutomationPoint> points; // Sorted by bar, one point per bar
+
+    // Last evaluated segment. Walking forward is amortized O(1); a backward
+    // jump (pattern wrap) falls back to a binary search.
+    struct Cursor
+    {
+        int index = -2;  // Last point at or before the bar, -1: before the first, -2: unset
+    };
+
+    bool empty() const { return points.empty(); }
+    void reserve(size_t capacity) { points.reserve(capacity); }
 
-    // Evaluate drill amount at given bar (step function, no interpolation yet)
+    // Evaluate amount at given bar (step function, no interpolation yet)
     float evaluateAt(int bar) const
     {
-        if (points.empty())
-            return 0.0f;
+        const int index = static_cast<int>(upperBound(bar) - points.begin()) - 1;
+        return index >= 0 ? points[index].amount : 0.0f;
+    }
 
-        float lastAmount = 0.0f;
-        for (const auto& p : points)
+    float evaluateAt(int bar, Cursor& cursor) const
+    {
+        const int numPoints = static_cast<int>(points.size());
+        if (cursor.index < -1 || cursor.index >= numPoints
+            || (cursor.index >= 0 && bar < points[cursor.index].bar))
+        {
+            cursor.index = static_cast<int>(upperBound(bar) - points.begin()) - 1;
+        }
+        else
         {
-            if (p.bar > bar)
-                break;
-            lastAmount = p.amount;
+            while (cursor.index + 1 < numPoints && points[cursor.index + 1].bar <= bar)
+                ++cursor.index;
         }
-        return lastAmount;
+        return cursor.index >= 0 ? points[cursor.index].amount : 0.0f;
     }
 
-    // Add point (keeps sorted)
+    // Add point (sorted insert; replaces the point already on that bar)
     void addPoint(int bar, float amount)
     {
-        DrillAutomationPoint p{bar, std::max(0.0f, std::min(1.0f, amount))};
-        points.push_back(p);
-        std::sort(points.begin(), points.end(),
-                 [](const DrillAutomationPoint& a, const DrillAutomationPoint& b)
-                 { return a.bar < b.bar; });
+        const BarAutomationPoint p{bar, std::max(0.0f, std::min(1.0f, amount))};
+        auto it = upperBound(bar);
+        if (it != points.begin() && (it - 1)->bar == bar)
+            *(it - 1) = p;
+        else
+            points.insert(it, p);
+    }
+
+    // Restore the ordering after points were written directly (loading)
+    void sortPoints()
+    {
+        std::stable_sort(points.begin(), points.end(),
+                         [](const BarAutomationPoint& a, const BarAutomationPoint& b)
+                         { return a.bar < b.bar; });
     }
 
     // Clear all automation
     void clear() { points.clear(); }
+
+private:
+    std::vector<BarAutomationPoint>::const_iterator upperBound(int bar) const
+    {
+        return std::upper_bound(points.begin(), points.end(), bar,
+                                [](int b, const BarAutomationPoint& p) { return b < p.bar; });
+    }
+    std::vector<BarAutomationPoint>::iterator upperBound(int bar)
+    {
+        return std::upper_bound(points.begin(), points.end(), bar,
+                                [](int b, const BarAutomationPoint& p) { return b < p.bar; });
+    }
 };
 
+using DrillAutomationPoint = BarAutomationPoint;
+using DrillAutomationLane = BarAutomationLane;
+
 //==============================================================================
 // Automatic Drill Fills (Context-Sensitive)
 //==============================================================================
@@ -516,8 +1076,220 @@ struct PhraseDetector
     }
 };
 
-// Safety: Maximum micro-hits per audio block (prevents audio thread DOS)
-constexpr int kMaxMicroHitsPerBlock = 256;
+// Safety: Maximum micro-hits per step (prevents audio thread DOS)
+constexpr int kMaxMicroHitsPerStep = 256;
+
+// Micro-hit budget counters since reset (readable from any thread)
+struct MicroHitStats
+{
+    uint32_t scheduled = 0;       // Micro-hits placed
+    uint32_t dropped = 0;         // Cut to fit the step budget or a full hit queue
+    uint32_t thinnedBursts = 0;   // Bursts played with fewer hits than asked for
+    uint32_t limitedSteps = 0;    // Steps in which the budget kicked in
+};
+
+//==============================================================================
+// Sample-Accurate Hit Scheduling
+//==============================================================================
+
+// One voice trigger placed on the sequencer's absolute sample clock
+struct ScheduledHit
+{
+    int64_t samplePosition = 0;  // Samples since reset
+    int trackIndex = 0;
+    float velocity = 0.0f;
+    bool onGrid = true;          // Resolved from a step (follows tempo); false for live hits
+};
+
+// Hit due inside the chunk being rendered, relative to the chunk start
+struct BlockHit
+{
+    int sampleOffset = 0;
+    int trackIndex = 0;
+    float velocity = 0.0f;
+};
+
+// Host transport at the start of the block about to render (JUCE playhead,
+// AU musical context). Positions are in quarter notes.
+struct HostTransport
+{
+    bool valid = false;         // No host clock: the sequencer free-runs
+    bool playing = true;
+    double tempo = 120.0;       // BPM
+    double ppqPosition = 0.0;   // Quarter notes since the host timeline start
+};
+
+// Fixed-capacity, time-sorted queue of pending hits (no allocation on audio thread)
+// Holds groove steps, flams, rolls and drill micro-bursts. Stored latest-first
+// so the next due hit is always at the back.
+struct HitQueue
+{
+    // Room for a full micro-hit budget on top of the steps resolved ahead
+    static constexpr int capacity = 2 * kMaxMicroHitsPerStep;
+
+    bool push(const ScheduledHit& hit)
+    {
+        if (size_ >= capacity)
+            return false;
+
+        int i = size_++;
+        while (i > 0 && hits_[i - 1].samplePosition < hit.samplePosition)
+        {
+            hits_[i] = hits_[i - 1];
+            --i;
+        }
+        hits_[i] = hit;
+        return true;
+    }
+
+    bool empty() const { return size_ == 0; }
+    int size() const { return size_; }
+    const ScheduledHit& next() const { return hits_[size_ - 1]; }
+    void pop() { --size_; }
+    void clear() { size_ = 0; }
+
+    // Tempo change at sample now: step hits still ahead keep their place
+    // on the grid (ratio = new over old samples per step), which itself
+    // moves by offset samples
+    void retime(int64_t now, double ratio, double offset = 0.0)
+    {
+        for (int i = 0; i < size_; ++i)
+        {
+            ScheduledHit& hit = hits_[i];
+            if (hit.onGrid && hit.samplePosition > now)
+            {
+                const double ahead = static_cast<double>(hit.samplePosition - now) * ratio + offset;
+                hit.samplePosition = now + std::max<int64_t>(0, std::llround(ahead));
+            }
+        }
+
+        // Live hits stay where they were: restore the latest-first order
+        for (int i = 1; i < size_; ++i)
+        {
+            const ScheduledHit hit = hits_[i];
+            int j = i;
+            while (j > 0 && hits_[j - 1].samplePosition < hit.samplePosition)
+            {
+                hits_[j] = hits_[j - 1];
+                --j;
+            }
+            hits_[j] = hit;
+        }
+    }
+
+    // Transport jump: drops the hits resolved from steps, keeps live ones
+    void clearGrid()
+    {
+        int kept = 0;
+        for (int i = 0; i < size_; ++i)
+        {
+            if (!hits_[i].onGrid)
+                hits_[kept++] = hits_[i];
+        }
+        size_ = kept;
+    }
+
+private:
+    std::array<ScheduledHit, capacity> hits_{};
+    int size_ = 0;
+};
+
+// Wait-free single-writer/single-reader triple buffer. The writer fills
+// back() and publish()es it into the middle slot; the reader's acquire()
+// swaps the middle slot into front() when something new was published.
+// Slots are never freed, so the reader's thread never releases memory.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer thread
+    T& back() { return slots_[back_]; }
+    void publish() { back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+
+    // Reader thread
+    bool acquire()
+    {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0)
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    T& front() { return slots_[front_]; }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4;
+
+    std::array<T, 3> slots_{};
+    int back_ = 0;
+    int front_ = 1;
+    std::atomic<int> middle_{2};
+};
+
+//==============================================================================
+// Pre-rendered Hit Cache
+//==============================================================================
+
+// One hit per voice group and velocity layer, rendered into one buffer
+struct HitCacheBank
+{
+    static constexpr int kNumGroups = 15;            // One per Track::DrumType
+    static constexpr int kMaxHitSamples = 1 << 17;  // Longer hits are cut
+
+    uint32_t generation = 0;
+    double sampleRate = 0.0;  // 0: nothing rendered yet
+    std::vector<float> samples;
+    std::array<std::array<HitCacheLayer, kHitCacheLayers>, kNumGroups> layers{};
+};
+
+// Renders hit banks on a background thread for the audio thread to play.
+// A build starts once the requested key (kit generation, sample rate) has
+// held still for kSettleTime, so a kit being edited keeps synthesizing.
+// The audio thread acquire()s the newest bank; as the triple buffer never
+// frees, acquiring only while no voice plays the current bank keeps every
+// cached voice's samples valid.
+class HitCache
+{
+public:
+    static constexpr auto kSettleTime = std::chrono::milliseconds(50);
+
+    HitCache() = default;
+    ~HitCache() { stop(); }
+
+    HitCache(const HitCache&) = delete;
+    HitCache& operator=(const HitCache&) = delete;
+
+    // Non-RT
+    void start();
+    void stop();
+    void request(uint32_t generation, double sampleRate);
+    uint32_t getBuildCount() const { return builds_.load(std::memory_order_relaxed); }
+
+    // Audio thread
+    bool acquire() { return banks_.acquire(); }
+    const HitCacheBank& current() { return banks_.front(); }
+    bool isCurrent(uint32_t generation, double sampleRate)
+    {
+        const HitCacheBank& bank = banks_.front();
+        return bank.sampleRate == sampleRate && bank.generation == generation;
+    }
+
+    // Renders every group and layer with freshly prepared voices
+    static void render(HitCacheBank& bank, uint32_t generation, double sampleRate);
+
+private:
+    void run();
+
+    TripleBuffer<HitCacheBank> banks_;  // Builder thread writes, audio thread reads
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    uint32_t requestedGeneration_ = 0;
+    double requestedSampleRate_ = 0.0;
+    bool pending_ = false;
+    bool stopping_ = false;
+    std::atomic<uint32_t> builds_{0};
+};
 
 // Rhythm feel mode (groove vs drill)
 enum class RhythmFeelMode : uint8_t
@@ -569,6 +1341,66 @@ struct StepCell
     DrillIntent drillIntent = DrillIntent::Optional;  // Semantic intent
 };
 
+// Steps of one track, up to kMaxSteps. Only populated cells take memory:
+// a bitmask marks the stored steps and a cell's slot is its rank among
+// them, so a lookup is one popcount. Unstored steps read as a default
+// (inactive) cell.
+class TrackSteps
+{
+public:
+    static constexpr int kMaxSteps = 128;
+
+    const StepCell& operator[](int step) const
+    {
+        return isStored(step) ? cells_[rank(step)] : emptyCell();
+    }
+
+    // Read-only on purpose: reading a step never allocates. edit() stores
+    // the step first if needed - allocates, not for the audio thread.
+    StepCell& edit(int step);
+    StepCell* find(int step) { return isStored(step) ? &cells_[rank(step)] : nullptr; }  // No allocation
+
+    bool isStored(int step) const
+    {
+        return step >= 0 && step < kMaxSteps && ((stored_[step >> 6] >> (step & 63)) & 1u);
+    }
+    int getNumStored() const { return static_cast<int>(cells_.size()); }
+    int getLastStored() const;  // -1 when empty
+
+    void erase(int step);
+    void clear();
+    void compact();  // Drops stored cells equal to a default cell
+
+    // fn(step, cell) for every stored step, in step order
+    template <typename Fn>
+    void forEachStored(Fn&& fn) const { forEachStored(*this, fn); }
+    template <typename Fn>
+    void forEachStored(Fn&& fn) { forEachStored(*this, fn); }
+
+    static bool isDefault(const StepCell& cell);
+
+private:
+    static constexpr int kNumWords = kMaxSteps / 64;
+
+    std::array<uint64_t, kNumWords> stored_{};
+    std::vector<StepCell> cells_;  // Stored steps in step order
+
+    // Self is TrackSteps or const TrackSteps
+    template <typename Self, typename Fn>
+    static void forEachStored(Self& self, Fn& fn)
+    {
+        int slot = 0;
+        for (int word = 0; word < kNumWords; ++word)
+            for (uint64_t bits = self.stored_[word]; bits != 0; bits &= bits - 1)
+                fn(word * 64 + lowestBit(bits), self.cells_[slot++]);
+    }
+
+    static const StepCell& emptyCell();
+    static int countBits(uint64_t bits);
+    static int lowestBit(uint64_t bits);
+    int rank(int step) const;
+};
+
 struct Track
 {
     enum class DrumType
@@ -592,7 +1424,8 @@ struct Track
 
     DrumType type = DrumType::Kick;
     TimingRole timingRole = TimingRole::Pocket;  // Pocket/Push/Pull
-    std::array<StepCell, 16> steps{};
+    TrackSteps steps;
+    int length = 0;  // Steps before this track loops (polymeter); 0 = pattern length
     float volume = 0.8f;
     float pan = 0.0f;
     int pitch = 0;  // MIDI pitch offset
@@ -601,6 +1434,153 @@ struct Track
     TrackDrillOverride drillOverride;
 };
 
+// The 16 tracks that make up one pattern
+using DrumPattern = std::array<Track, 16>;
+
+//==============================================================================
+// Voice Registry
+//==============================================================================
+
+static constexpr int kNumDrumVoiceTypes = 15;  // Track::DrumType values
+static_assert(static_cast<int>(Track::DrumType::Special) + 1 == kNumDrumVoiceTypes, "Special is the last drum type");
+static_assert(HitCacheBank::kNumGroups == kNumDrumVoiceTypes, "one hit cache group per drum type");
+
+// The voice that plays a drum type and its pool defaults, fixed at compile
+// time. Specialize for a type to give it its own voice: its pool, render
+// kernel, dispatch and hit cache layers all follow from this table.
+template <Track::DrumType Type>
+struct DrumVoiceTraits
+{
+    using Voice = PercVoice;
+    static constexpr int polyphony = 3;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Kick>
+{
+    using Voice = KickVoice;
+    static constexpr int polyphony = 2;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Snare>
+{
+    using Voice = SnareVoice;
+    static constexpr int polyphony = 4;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Special>
+{
+    using Voice = SnareVoice;
+    static constexpr int polyphony = 3;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::HiHatClosed>
+{
+    using Voice = HiHatVoice;
+    static constexpr int polyphony = 3;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::HiHatOpen> : DrumVoiceTraits<Track::DrumType::HiHatClosed> {};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Shaker>
+{
+    using Voice = HiHatVoice;
+    static constexpr int polyphony = 4;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Tambourine> : DrumVoiceTraits<Track::DrumType::Shaker> {};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Clap>
+{
+    using Voice = ClapVoice;
+    static constexpr int polyphony = 3;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+// Long cymbal tails: replace the one that has faded most
+template <> struct DrumVoiceTraits<Track::DrumType::Crash>
+{
+    using Voice = CymbalVoice;
+    static constexpr int polyphony = 3;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Quietest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Ride> : DrumVoiceTraits<Track::DrumType::Crash> {};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Cowbell>
+{
+    using Voice = PercVoice;
+    static constexpr int polyphony = 2;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+template <> struct DrumVoiceTraits<Track::DrumType::Percussion>
+{
+    using Voice = PercVoice;
+    static constexpr int polyphony = 4;
+    static constexpr VoiceStealMode stealMode = VoiceStealMode::Oldest;
+};
+
+// TomLow/TomMid/TomHigh use the primary template
+
+template <int Index>
+using DrumVoiceTraitsAt = DrumVoiceTraits<static_cast<Track::DrumType>(Index)>;
+
+// Calls fn(std::integral_constant<int, type>) for every drum type, so fn
+// can name DrumVoiceTraitsAt<type> at compile time
+template <typename Fn, int... Index>
+void forEachDrumVoiceType(Fn&& fn, std::integer_sequence<int, Index...>)
+{
+    (fn(std::integral_constant<int, Index>{}), ...);
+}
+
+template <typename Fn>
+void forEachDrumVoiceType(Fn&& fn)
+{
+    forEachDrumVoiceType(fn, std::make_integer_sequence<int, kNumDrumVoiceTypes>{});
+}
+
+template <typename Indices>
+struct DrumVoicePoolTuple;
+
+template <int... Index>
+struct DrumVoicePoolTuple<std::integer_sequence<int, Index...>>
+{
+    using type = std::tuple<VoicePool<typename DrumVoiceTraitsAt<Index>::Voice>...>;
+};
+
+// One pool per drum type, each of its registered voice
+using DrumVoicePools = typename DrumVoicePoolTuple<std::make_integer_sequence<int, kNumDrumVoiceTypes>>::type;
+
+// Complete pattern/drill state built on the editor thread and swapped into
+// the sequencer in one step (StepSequencer::publishSnapshot)
+struct SequencerSnapshot
+{
+    enum Parts : uint8_t
+    {
+        Tracks = 1 << 0,   // tracks (steps, types, pan, drill overrides)
+        Drill = 1 << 1,    // drill mode, fill/gate policies and automation
+        Groove = 1 << 2,   // swing and Dilla amount automation
+        All = Tracks | Drill | Groove
+    };
+
+    DrumPattern tracks{};
+    DrillMode drillMode;
+    DrillFillPolicy drillFillPolicy;
+    DrillGatePolicy drillGatePolicy;
+    DrillAutomationLane drillAutomation;
+    BarAutomationLane swingAutomation;
+    BarAutomationLane dillaAutomation;
+
+    uint8_t parts = All;
+    bool atBar = true;  // Swap at the next bar (step 0), else at the next step
+};
+
 class StepSequencer
 {
 public:
@@ -613,22 +1593,104 @@ public:
     void setTempo(float bpm);
     void setSwing(float swingAmount);  // 0.0 to 1.0
 
+    // Steps per pattern cycle, 1..TrackSteps::kMaxSteps. Bars are 16 steps;
+    // tracks with their own length loop independently (polymeter).
     void setPatternLength(int length);
+    int getPatternLength() const { return patternLength_; }
     int getCurrentStep() const { return currentStep_; }
+    float getSamplesPerStep() const { return samplesPerStep_; }
+
+    // Editor thread (one at a time): publish a complete state, swapped in
+    // when the sequencer next resolves a step (atBar: step 0, which it does
+    // the lookahead ahead of the wrap). Wait-free on both sides; the superseded
+    // state is released on the next publishing thread, never on audio.
+    // The plain setters (setTrack, setDrillMode, ...) are for the render
+    // thread or while stopped.
+    void publishSnapshot(const SequencerSnapshot& snapshot) { publishSnapshot(snapshot, snapshot.atBar); }
+    void publishSnapshot(const SequencerSnapshot& snapshot, bool atBar);
+    void queuePattern(const DrumPattern& pattern);  // Tracks only, at the next bar
+
+    // Stopped: no new steps are resolved and pending hits are dropped;
+    // ringing voices and later live (MIDI) hits still play
+    void setPlaying(bool playing);
+    bool isPlaying() const { return playing_; }
 
     void triggerTrack(int trackIndex, int stepIndex, float velocity);
     void triggerAllTracks(int stepIndex);
 
+    // Live (MIDI) hit sampleOffset samples into the next rendered block.
+    // Bypasses step probability/flam/roll; shares the step hit queue.
+    void triggerTrackAt(int trackIndex, float velocity, int sampleOffset);
+
     bool isTrackTriggered(int trackIndex, int stepIndex) const;
 
+    // Sample-accurate scheduling: the render loop splits each block at the
+    // exact sample the next step boundary or pending hit falls on.
+    void dispatchDueHits();                               // Trigger hits due at the current sample
+    int getSamplesUntilNextEvent(int maxSamples) const;   // Length of the next event-free sub-block
+    int64_t getRenderPosition() const { return renderPosition_; }
+
+    // Lookahead: steps are resolved (phrase/fill/gate policy, drill bursts,
+    // Dilla drift, probability) this many steps before they play, into the
+    // timestamped hit queue. Published state and setTrack() edits reach
+    // the steps resolved after them.
+    static constexpr int kMaxLookaheadSteps = 8;
+    void setLookaheadSteps(int steps);
+    int getLookaheadSteps() const { return lookaheadSteps_; }
+
+    // Render thread, block start: resolves every step the next numSamples
+    // reach plus the lookahead, so the sub-block loop only drains hits
+    void scheduleAhead(int numSamples);
+
+    // Host clock (render thread, block start): follows the host tempo and
+    // transport state, and relocates when the host position jumps (loop,
+    // scrub) or drifts from the step clock by more than a sample. Steps
+    // land on the host grid: step n starts at quarter note n / 4.
+    void syncToHost(const HostTransport& transport);
+    void locate(double stepPosition);  // Steps since the timeline start
+    double getStepPosition() const;
+
+    // Two-pass chunk render: collectBlockHits() runs the clock across the
+    // chunk and records its due hits, then each voice group (one pool per
+    // drum type) renders them on its own - groups may run in parallel.
+    static constexpr int kNumVoiceGroups = kNumDrumVoiceTypes;  // One per Track::DrumType
+    int collectBlockHits(int numSamples, BlockHit* hits, int maxHits);
+    void renderVoiceGroup(int group, const BlockHit* hits, int numHits,
+                          float* const* trackBuffers, int numSamples);
+
     void advance(int numSamples);
     void processTrack(int trackIndex, float* output, int numSamples);
 
     void setTrack(int index, const Track& track);
-    Track getTrack(int index) const;
+    const Track& getTrack(int index) const;  // No copy on the audio thread
+    void setTrackLength(int index, int length);  // 0 = follow the pattern length
 
     int getNumTracks() const { return static_cast<int>(tracks_.size()); }
     bool hasActiveVoices() const;  // Check if any drum voice is playing
+    int getActiveVoiceCount() const;
+    int getMaxPolyphony() const;
+
+    // Per-step micro-hit budget (drill bursts). Once a step fills up,
+    // lower-priority bursts are thinned first: Optional-intent cells may
+    // use 3/4 of the budget, Emphasize cells all of it. Every burst keeps
+    // at least its first hit; plain groove hits are never cut. Counted per
+    // step, not per host block, so thinning is the same at any block size
+    // and offline bounces match live playback.
+    void setMicroHitBudget(int hitsPerStep);
+    int getMicroHitBudget() const { return microHitBudget_; }
+    MicroHitStats getMicroHitStats() const;
+
+    // Voice pool configuration (per drum type)
+    template <Track::DrumType Type>
+    VoicePool<typename DrumVoiceTraits<Type>::Voice>& getVoicePool() { return std::get<static_cast<int>(Type)>(voicePools_); }
+    void setVoicePolyphony(Track::DrumType type, int numVoices);
+    int getVoicePolyphony(Track::DrumType type) const;
+    void setVoiceStealMode(Track::DrumType type, VoiceStealMode mode);
+
+    // Pre-rendered hits for every pool, or nullptr to synthesize (render
+    // thread). The bank must stay valid while getCachedVoiceCount() > 0.
+    void setHitCache(const HitCacheBank* bank);
+    int getCachedVoiceCount() const;
 
     // Timing role system
     void setRoleTimingParams(const RoleTimingParams& params) { roleTimingParams_ = params; }
@@ -645,29 +1707,36 @@ public:
     RhythmFeelMode getRhythmFeelMode() const { return rhythmFeelMode_; }
 
     // Drill intensity automation (compositional sequencing)
-    void setDrillAutomation(const DrillAutomationLane& lane) { drillAutomation_ = lane; }
+    void setDrillAutomation(const DrillAutomationLane& lane) { drillAutomation_ = lane; invalidateAutomation(); }
     DrillAutomationLane getDrillAutomation() const { return drillAutomation_; }
-    void addDrillAutomationPoint(int bar, float amount) { drillAutomation_.addPoint(bar, amount); }
-    void clearDrillAutomation() { drillAutomation_.clear(); }
+    void addDrillAutomationPoint(int bar, float amount) { drillAutomation_.addPoint(bar, amount); invalidateAutomation(); }
+    void clearDrillAutomation() { drillAutomation_.clear(); invalidateAutomation(); }
+
+    // Per-bar swing and Dilla amount; a non-empty lane overrides the base value
+    void setSwingAutomation(const BarAutomationLane& lane) { swingAutomation_ = lane; invalidateAutomation(); }
+    BarAutomationLane getSwingAutomation() const { return swingAutomation_; }
+    void setDillaAutomation(const BarAutomationLane& lane) { dillaAutomation_ = lane; invalidateAutomation(); }
+    BarAutomationLane getDillaAutomation() const { return dillaAutomation_; }
 
     // Automatic drill fills
-    void setDrillFillPolicy(const DrillFillPolicy& policy) { drillFillPolicy_ = policy; }
+    void setDrillFillPolicy(const DrillFillPolicy& policy) { drillFillPolicy_ = policy; barPoliciesDirty_ = true; }
     DrillFillPolicy getDrillFillPolicy() const { return drillFillPolicy_; }
 
     // Drill ↔ Silence gating
-    void setDrillGatePolicy(const DrillGatePolicy& policy) { drillGatePolicy_ = policy; }
+    void setDrillGatePolicy(const DrillGatePolicy& policy) { drillGatePolicy_ = policy; barPoliciesDirty_ = true; }
     DrillGatePolicy getDrillGatePolicy() const { return drillGatePolicy_; }
 
     // Musical phrase intelligence
     void setPhraseDetector(const PhraseDetector& p) { phraseDetector_ = p; }
     PhraseDetector getPhraseDetector() const { return phraseDetector_; }
     int getBarsPerPhrase() const { return phraseDetector_.barsPerPhrase; }
-    void setBarsPerPhrase(int bars) { phraseDetector_.barsPerPhrase = bars; }
+    void setBarsPerPhrase(int bars) { phraseDetector_.barsPerPhrase = bars; barPoliciesDirty_ = true; }
 
     // IDM Macro Presets (behavioral identities)
     void applyIdmMacroPreset(const IdmMacroPreset& preset)
     {
         preset.applyTo(drillMode_, drillFillPolicy_, drillGatePolicy_);
+        barPoliciesDirty_ = true;
     }
 
     // IDM macro preset loaders (complete behavioral identities)
@@ -713,9 +1782,24 @@ private:
     double sampleRate_ = 48000.0;
     float samplesPerBeat_ = 0.0f;
     float samplesPerStep_ = 0.0f;
-    double position_ = 0.0;
+    double position_ = 0.0;        // Samples into the current step (fractional)
+    int64_t renderPosition_ = 0;   // Samples rendered since reset
     int currentStep_ = 0;
+    int64_t stepCount_ = 0;        // Steps played since reset (polymetric track position)
     int patternLength_ = 16;
+    bool started_ = false;         // First steps scheduled since reset
+    int lookaheadSteps_ = 1;
+    static constexpr double kHostSyncToleranceSamples = 1.0;
+    int64_t nextResolveStep_ = 0;  // First step not yet resolved into the hit queue
+    bool playing_ = true;
+
+    // Published editor state, and whether front() still waits for its bar
+    TripleBuffer<SequencerSnapshot> snapshots_;
+    bool snapshotPending_ = false;
+
+    // Pending hits (groove timing, flams, rolls, micro-bursts) resolved
+    // lookaheadSteps_ ahead
+    HitQueue hitQueue_;
 
     float swingAmount_ = 0.0f;
     float tempo_ = 120.0f;
@@ -728,12 +1812,30 @@ private:
     // Drill mode system
     DrillMode drillMode_;
     RhythmFeelMode rhythmFeelMode_ = RhythmFeelMode::Groove;
-    DeterministicRng drillRng_;  // RNG for drill mode
-    int microHitsThisBlock_ = 0;  // Safety counter for audio thread protection
+    DeterministicRng drillRng_;  // RNG for drill mode (gates, fills, bursts)
+    int microHitsThisStep_ = 0;  // Safety counter for audio thread protection
+    int microHitBudget_ = kMaxMicroHitsPerStep;
+    bool budgetLimitedThisStep_ = false;
+    std::atomic<uint32_t> microHitsScheduled_{0};
+    std::atomic<uint32_t> microHitsDropped_{0};
+    std::atomic<uint32_t> thinnedBursts_{0};
+    std::atomic<uint32_t> limitedSteps_{0};
 
     // Drill intensity automation (compositional sequencing)
     DrillAutomationLane drillAutomation_;
-    int currentBar_ = 0;  // Track current bar for automation
+    int currentBar_ = 0;  // Absolute bar for automation and phrase position
+
+    // Per-bar swing / Dilla amount automation, and the lane values for the
+    // current bar (updateBarPolicies)
+    BarAutomationLane swingAutomation_;
+    BarAutomationLane dillaAutomation_;
+    BarAutomationLane::Cursor drillCursor_;
+    BarAutomationLane::Cursor swingCursor_;
+    BarAutomationLane::Cursor dillaCursor_;
+    float barDrillAmount_ = 0.0f;
+    float barSwingAmount_ = 0.0f;
+    float barDillaAmount_ = 0.0f;
+    void invalidateAutomation();
 
     // Automatic drill fills (context-sensitive)
     DrillFillPolicy drillFillPolicy_;
@@ -746,30 +1848,65 @@ private:
     // Musical phrase intelligence
     PhraseDetector phraseDetector_;
 
+    // Phrase-aware policies for the current bar (updateBarPolicies)
+    DrillFillPolicy barFillPolicy_;
+    DrillGatePolicy barGatePolicy_;
+    bool barPoliciesDirty_ = false;
+
     std::array<Track, 16> tracks_;
 
-    // Drum voices (one per track type)
-    KickVoice kick_;
-    SnareVoice snare_;
-    HiHatVoice hihatClosed_;
-    HiHatVoice hihatOpen_;
-    ClapVoice clap_;
-    PercVoice tomLow_;
-    PercVoice tomMid_;
-    PercVoice tomHigh_;
-    CymbalVoice crash_;
-    CymbalVoice ride_;
-    PercVoice cowbell_;
-    HiHatVoice shaker_;
-    HiHatVoice tambourine_;
-    PercVoice percussion_;
-    SnareVoice special_;
-
-    // PRNG state for probability checks (deterministic)
-    mutable unsigned probSeed = 123;
-
-    float processDrumVoice(Track::DrumType type, float velocity);
+    // Hot step data, mirrored from tracks_ by setTrack(). The step resolver
+    // reads one mask per step and touches a track's StepCell (drill fields,
+    // flam/roll, timing) only when that track plays the step. Lanes are
+    // indexed by each track's own step, so polymetric tracks build their
+    // mask bit by bit.
+    struct StepLane
+    {
+        uint16_t activeTracks = 0;           // Bit per track
+        std::array<uint8_t, 16> velocity{};
+        std::array<float, 16> probability{};
+    };
+    std::array<StepLane, TrackSteps::kMaxSteps> stepLanes_{};
+    uint16_t polymetricTracks_ = 0;  // Tracks with their own length
+    void updateStepLanes(int trackIndex);
+    void swapTrack(int index, Track& track);  // setTrack() without the copy
+
+    // Drum voice pools (one pool per track type, polyphonic with stealing),
+    // indexed by Track::DrumType
+    DrumVoicePools voicePools_;
+    const HitCacheBank* hitCache_ = nullptr;
+
+    // Invoke fn with the voice pool that plays the given drum type
+    // (Self is StepSequencer or const StepSequencer)
+    template <typename Self, typename Fn>
+    static void visitVoicePool(Self& self, Track::DrumType type, Fn&& fn);
+    template <typename Self, typename Fn, int... Index>
+    static void visitVoicePool(Self& self, int type, Fn& fn, std::integer_sequence<int, Index...>);
+    template <typename Self, typename Fn>
+    static void forEachVoicePool(Self& self, Fn&& fn);
+
+    // Random streams are keyed per bar (and per track), so a bar's draws
+    // do not depend on what earlier bars consumed
+    static constexpr uint32_t kRandomSeed = 0x12345678u;
+    static constexpr uint32_t kDrillStream = 16;  // Streams 0..15 are the tracks
+    std::array<DeterministicRng, 16> trackRng_;   // Probability and Dilla drift
+    int64_t randomBar_ = -1;                      // Bar the streams are keyed to
+    void seekRandomStreams(int64_t bar);
+
+    void triggerDrumVoice(int trackIndex, float velocity);
     void advanceStep();
+    void resolveThrough(int64_t stepNumber);  // Resolves steps up to stepNumber
+    void applyPublishedSnapshot(int stepIndex);
+
+    // Pops every hit due at the current sample (first call schedules the
+    // opening steps) and hands it to fn
+    template <typename Fn>
+    void forEachDueHit(Fn&& fn);
+
+    // Scheduling helpers
+    void scheduleStep(int stepIndex, int64_t stepNumber, double stepStartSample);
+    void queueTrackHit(int trackIndex, const StepCell& step, float velocity, float probability, double hitSample);
+    bool pushHit(int trackIndex, double hitSample, float velocity, bool onGrid = true);
 
     // Timing system helpers
     void updateDillaDrift(int trackIndex, TimingRole role);
@@ -783,6 +1920,8 @@ private:
                            double stepStartSeconds, double stepDurationSeconds,
                            float effectiveDrillAmount = -1.0f); // -1 means use drillMode_.amount
     int chooseGridDivisor(DrillGrid grid);
+    int getMicroHitAllowance(DrillIntent intent) const;
+    void countDroppedMicroHits(int count);
 
     // Drill fill helpers
     bool isFillStep(int stepIndex, int stepsPerBar, const DrillFillPolicy& policy) const;
@@ -791,11 +1930,150 @@ private:
     // Drill gate helpers
     bool shouldGateStep(const DrillGatePolicy& policy);
 
-    // Bar tracking for automation
-    void updateBarIndex();
+    // Bar tracking for automation and phrase-aware policies
+    void updateBarIndex(int64_t absoluteBar);  // Bar of the step being resolved, since start
+    void updateBarPolicies();
     int getStepsPerBar() const { return 16; } // 16 steps = 4 beats at 16th note resolution
 };
 
+//==============================================================================
+// Parameter Definitions
+//==============================================================================
+
+// Integer parameter IDs. The order matches the AUv3 ParameterAddress enum
+// up to TrackVolume15, so AU addresses map straight across.
+enum class DrumParam : int
+{
+    Tempo = 0,
+    Swing,
+    MasterVolume,
+    PatternLength,
+
+    // Role timing
+    PocketOffset,
+    PushOffset,
+    PullOffset,
+
+    // Dilla timing
+    DillaAmount,
+    DillaHatBias,
+    DillaSnareLate,
+    DillaKickTight,
+    DillaMaxDrift,
+
+    // Structure and stereo
+    Structure,
+    StereoWidth,
+    RoomWidth,
+    EffectsWidth,
+
+    // Per-track mix (16 each)
+    TrackVolume0,
+    TrackPan0 = TrackVolume0 + 16,
+
+    Count = TrackPan0 + 16
+};
+
+constexpr int kNumDrumParams = static_cast<int>(DrumParam::Count);
+
+inline DrumParam trackVolumeParam(int track) { return static_cast<DrumParam>(static_cast<int>(DrumParam::TrackVolume0) + track); }
+inline DrumParam trackPanParam(int track) { return static_cast<DrumParam>(static_cast<int>(DrumParam::TrackPan0) + track); }
+
+struct DrumParamInfo
+{
+    const char* id;         // DSP string ID (snake_case, also the preset JSON key)
+    const char* aliasId;    // Plugin-wrapper ID (camelCase), accepted by findDrumParam
+    float minValue;
+    float maxValue;
+    float defaultValue;
+};
+
+// Metadata for every parameter
+const DrumParamInfo& getDrumParamInfo(DrumParam param);
+
+// String ID (either spelling) to parameter, DrumParam::Count when unknown
+DrumParam findDrumParam(const char* paramId);
+
+//==============================================================================
+// Render Worker Pool
+//==============================================================================
+
+// Fixed worker threads that run one batch of jobs per run() call. The caller
+// takes part as worker 0 and returns once every job is done. Handoff is
+// lock-free: jobs are claimed from one atomic word (generation | count |
+// next), so a late worker can never claim a job from a newer batch.
+class RenderWorkerPool
+{
+public:
+    using JobFn = void (*)(void* context, int jobIndex, int workerIndex);
+
+    RenderWorkerPool() = default;
+    ~RenderWorkerPool();
+
+    // Not real-time safe: spawns/joins threads. Pinning is Linux-only.
+    void start(int numWorkers, bool pinThreads);
+    void stop();
+    int getNumWorkers() const { return static_cast<int>(threads_.size()); }
+
+    // Audio thread: run numJobs (max 65535) jobs across the pool
+    void run(JobFn fn, void* context, int numJobs);
+
+private:
+    void workerLoop(int workerIndex, bool pinThread);
+    bool runJobs(int workerIndex);  // true if any job ran
+
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> batch_{0};  // generation << 32 | numJobs << 16 | nextJob
+    std::atomic<int> pendingJobs_{0};
+    JobFn fn_ = nullptr;              // Published by the batch_ store
+    void* context_ = nullptr;
+};
+
+//==============================================================================
+// Offline Rendering
+//==============================================================================
+
+// Receives consecutive rendered blocks from renderOffline()
+class OfflineRenderSink
+{
+public:
+    virtual ~OfflineRenderSink() = default;
+
+    // Planar: channels[0..numChannels-1] hold numSamples samples each.
+    // Interleaved: channels[0] holds numSamples frames of numChannels.
+    // Return false to stop the render.
+    virtual bool write(const float* const* channels, int numChannels, int numSamples) = 0;
+};
+
+enum class OfflineRenderOutput : uint8_t
+{
+    StereoMix,   // 2 channels: left, right
+    TrackStems   // 32 channels: track N left = 2N, right = 2N + 1 (panned, level-scaled)
+};
+
+// One entry of a pattern chain
+struct OfflineChainSlot
+{
+    const DrumPattern* pattern = nullptr;
+    int numBars = 1;  // Pattern cycles (patternLength steps each)
+};
+
+struct OfflineRenderSettings
+{
+    double sampleRate = 48000.0;
+    int blockSize = 8192;                  // Samples per sink write
+    OfflineRenderOutput output = OfflineRenderOutput::StereoMix;
+    bool interleaved = false;
+
+    int numBars = 4;                       // Current pattern, used when chain is empty
+    const OfflineChainSlot* chain = nullptr;
+    int chainLength = 0;
+
+    double maxTailSeconds = 2.0;           // Ring-out after the last bar, cut once silent
+    int renderThreads = 1;                 // > 1: voice groups (and their stems) in parallel
+};
+
 //==============================================================================
 // Main Drum Machine Instrument
 //==============================================================================
@@ -812,6 +2090,17 @@ enum PresetSection : int
     PRESET_ALL = PRESET_GLOBAL | PRESET_PATTERN | PRESET_KIT
 };
 
+// Receives a saved preset or state in order, one piece at a time, on the
+// saving thread
+class StateSink
+{
+public:
+    virtual ~StateSink() = default;
+
+    // Return false to stop the save
+    virtual bool write(const void* data, int numBytes) = 0;
+};
+
 // Voice parameters for saving kit presets
 struct VoiceParams
 {
@@ -891,6 +2180,215 @@ struct VoiceParams
     float specialSnap = 0.5f;
 };
 
+// How tracks are spread over the output buses (DrumMachinePureDSP)
+enum class OutputBusLayout : uint8_t
+{
+    Mix,       // Every track on bus 0
+    PerTrack,  // Track n on bus n
+    Groups,    // By drum family: kick, snare/clap, hats/shakers, toms, cymbals, percussion
+    Custom     // setTrackOutputBus()
+};
+
+// Preset decoded off the audio path (JSON, binary state or built in code).
+// Applying one is parameter writes plus one pattern publish; no parsing.
+struct DecodedPreset
+{
+    DecodedPreset();  // Parameter defaults, nothing to apply yet
+
+    std::array<float, kNumDrumParams> params{};
+    uint64_t paramMask = 0;      // Parameters the preset sets
+    SequencerSnapshot pattern;   // pattern.parts: tracks, drill and/or groove it replaces
+    VoiceParams voices;
+    bool hasVoices = false;
+
+    // Output routing (binary state only); < 0: not in the source
+    int8_t outputBusLayout = -1;
+    std::array<uint8_t, 16> trackOutputBus{};
+
+    void setParameter(DrumParam param, float value);
+    void setDrill(const IdmMacroPreset& macro);  // Drill state incl. (empty) automation
+
+    // Decoders call this before handing a preset out: false (an unknown
+    // enum value or a NaN/inf anywhere) means it must not be applied.
+    // Counts (rolls, bursts, silent runs, ...) are clamped to what the
+    // audio thread can afford.
+    bool validate();
+    size_t getMemoryUsage() const;
+};
+
+//==============================================================================
+// Parameter Telemetry (real-time safe)
+//==============================================================================
+
+// One parameter change, recorded where it happened and formatted later
+struct TelemetryRecord
+{
+    DrumParam param = DrumParam::Count;
+    float oldValue = 0.0f;
+    float newValue = 0.0f;
+    uint32_t changes = 1;  // Consecutive changes of param folded into this record
+};
+
+struct TelemetryStats
+{
+    uint64_t recorded = 0;   // Records pushed
+    uint64_t coalesced = 0;  // Changes folded into another record
+    uint64_t dropped = 0;    // Ring full, or lost the race to a concurrent push
+};
+
+// Fixed-size ring of parameter change records. Pushing never blocks,
+// allocates or formats: a full ring drops the record and counts it.
+// Records are consumed by one thread at a time: the shared telemetry
+// thread while logging is on, else whoever calls drain().
+class ParameterTelemetry
+{
+public:
+    static constexpr uint32_t kCapacity = 256;  // Power of two
+
+    ParameterTelemetry() = default;
+    ~ParameterTelemetry() { stopLogging(); }
+
+    ParameterTelemetry(const ParameterTelemetry&) = delete;
+    ParameterTelemetry& operator=(const ParameterTelemetry&) = delete;
+
+    // Any thread, wait-free. A repeat of the last pushed value is coalesced;
+    // a push racing one on another thread is dropped.
+    void push(DrumParam param, float oldValue, float newValue);
+
+    // Hand every pending record to fn(const TelemetryRecord&), runs of the
+    // same parameter merged into one. Returns the number handed out.
+    template <typename Fn>
+    int drain(Fn&& fn);
+
+    // Non-RT: have the shared telemetry thread drain this ring every few
+    // milliseconds and log it (LOG_PARAMETER_CHANGE)
+    void startLogging();
+    void stopLogging();
+
+    TelemetryStats getStats() const;
+
+private:
+    std::array<TelemetryRecord, kCapacity> records_{};
+    std::atomic<uint32_t> head_{0};  // Next write (producer)
+    std::atomic<uint32_t> tail_{0};  // Next read (consumer)
+    std::atomic<bool> producing_{false};
+    bool logging_ = false;
+
+    // Producer side, guarded by producing_
+    DrumParam lastParam_ = DrumParam::Count;
+    float lastValue_ = 0.0f;
+
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+template <typename Fn>
+int ParameterTelemetry::drain(Fn&& fn)
+{
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    int handed = 0;
+    uint64_t merged = 0;
+
+    while (tail != head)
+    {
+        TelemetryRecord record = records_[tail % kCapacity];
+        for (++tail; tail != head && records_[tail % kCapacity].param == record.param; ++tail)
+        {
+            const TelemetryRecord& next = records_[tail % kCapacity];
+            record.newValue = next.newValue;
+            record.changes += next.changes;
+            ++merged;
+        }
+        fn(static_cast<const TelemetryRecord&>(record));
+        ++handed;
+    }
+
+    tail_.store(tail, std::memory_order_release);
+    if (merged != 0) coalesced_.fetch_add(merged, std::memory_order_relaxed);
+    return handed;
+}
+
+//==============================================================================
+// Render Profiling
+//==============================================================================
+
+enum class ProfileStage : uint8_t
+{
+    Sequencer,  // Clock, step resolve and drill scheduling (collectBlockHits)
+    Voices,     // Voice rendering, all groups
+    Mix,        // Track gains into the outputs/stems, worker bus reduction
+    Stereo,     // processStereo() width
+    Count
+};
+
+constexpr int kNumProfileStages = static_cast<int>(ProfileStage::Count);
+
+// Render timings since the last reset, plus the state after the last block
+struct RenderProfile
+{
+    uint64_t blocks = 0;
+    uint64_t totalNs = 0;          // All blocks, process() to return
+    uint64_t lastBlockNs = 0;
+    uint64_t worstBlockNs = 0;
+    float averageLoad = 0.0f;      // Render time / audio time
+    float worstLoad = 0.0f;        // Worst single block
+    std::array<uint64_t, kNumProfileStages> stageNs{};
+    std::array<uint64_t, StepSequencer::kNumVoiceGroups> voiceGroupNs{};  // By Track::DrumType
+    MicroHitStats microHits;
+    int activeVoices = 0;
+};
+
+// Lock-free render counters: written by the render threads, read from any
+// thread. DRUMMACHINE_PROFILING=0 compiles every call away.
+class RenderProfiler
+{
+public:
+#if DRUMMACHINE_PROFILING
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void addStage(ProfileStage stage, int64_t start)
+    {
+        stageNs_[static_cast<int>(stage)].fetch_add(static_cast<uint64_t>(now() - start), std::memory_order_relaxed);
+    }
+
+    // Each group is rendered by one job at a time
+    void addVoiceGroup(int group, int64_t start)
+    {
+        voiceGroupNs_[group].fetch_add(static_cast<uint64_t>(now() - start), std::memory_order_relaxed);
+    }
+
+    void endBlock(int64_t start, int numSamples, double sampleRate, const StepSequencer& sequencer);
+    void reset();
+    RenderProfile get() const;
+#else
+    static int64_t now() { return 0; }
+    void addStage(ProfileStage, int64_t) {}
+    void addVoiceGroup(int, int64_t) {}
+    void endBlock(int64_t, int, double, const StepSequencer&) {}
+    void reset() {}
+    RenderProfile get() const { return RenderProfile{}; }
+#endif
+
+private:
+#if DRUMMACHINE_PROFILING
+    std::atomic<uint64_t> blocks_{0};
+    std::atomic<uint64_t> totalNs_{0};
+    std::atomic<uint64_t> audioNs_{0};
+    std::atomic<uint64_t> lastBlockNs_{0};
+    std::atomic<uint64_t> worstBlockNs_{0};
+    std::atomic<float> worstLoad_{0.0f};
+    std::atomic<int> activeVoices_{0};
+    std::array<std::atomic<uint64_t>, kNumProfileStages> stageNs_{};
+    std::array<std::atomic<uint64_t>, StepSequencer::kNumVoiceGroups> voiceGroupNs_{};
+#endif
+};
+
 //==============================================================================
 // Main Drum Machine Instrument
 //==============================================================================
@@ -906,16 +2404,63 @@ public:
     void process(float** outputs, int numChannels, int numSamples) override;
     void handleEvent(const ScheduledEvent& event) override;
 
+    // process() plus stereo width on the mix
+    void processStereo(float** outputs, int numChannels, int numSamples);
+
+    // True when the last rendered block was skipped as idle (no voice
+    // sounding, no hit due) and is all zeros, stems included. Wrappers can
+    // pass it on as a silence hint.
+    bool isLastBlockSilent() const { return lastBlockSilent_.load(std::memory_order_relaxed); }
+
+    // Host clock for the next process() call (render thread, once per
+    // block): the sequencer follows the host tempo, transport and position
+    // instead of free-running. A block without one keeps the step clock
+    // where it is.
+    void setHostTransport(const HostTransport& transport) { hostTransport_ = transport; }
+
+    // Steps resolved ahead of playback (1..StepSequencer::kMaxLookaheadSteps;
+    // render thread or while stopped)
+    void setLookaheadSteps(int steps) { sequencer_.setLookaheadSteps(steps); }
+    int getLookaheadSteps() const { return sequencer_.getLookaheadSteps(); }
+
+    // Output buses: process() with 2 * N channels renders N stereo buses,
+    // bus 0 being the main output. Each track mixes straight into the one
+    // bus its layout picks; a track whose bus the caller did not provide
+    // (too few channels, or a null pair) plays on bus 0. Any thread.
+    static constexpr int kMaxOutputBuses = 16;
+    void setOutputBusLayout(OutputBusLayout layout);
+    OutputBusLayout getOutputBusLayout() const;
+    void setTrackOutputBus(int track, int bus);  // Switches to OutputBusLayout::Custom
+    int getTrackOutputBus(int track) const;      // Bus under the current layout
+
+    // Pre-rendered hits: triggers play a hit rendered per voice group and
+    // velocity layer, scaled to their velocity, instead of synthesizing.
+    // The cache is rebuilt in the background when the kit or sample rate
+    // changes; until it is current, hits synthesize. Off by default. Non-RT.
+    void setHitCacheEnabled(bool enabled);
+    bool isHitCacheEnabled() const { return hitCacheEnabled_.load(std::memory_order_relaxed); }
+    bool isHitCacheActive() const { return hitCacheActive_.load(std::memory_order_relaxed); }  // Last block
+    uint32_t getHitCacheBuildCount() const { return hitCache_.getBuildCount(); }
+
     float getParameter(const char* paramId) const override;
     void setParameter(const char* paramId, float value) override;
 
+    // Integer parameter path: lock-free and safe from any thread. Changed
+    // values reach the sequencer at the start of the next process() call.
+    float getParameter(DrumParam param) const;
+    void setParameter(DrumParam param, float value);
+
     // Base class interface implementations (call enhanced versions)
     bool savePreset(char* jsonBuffer, int jsonBufferSize) const override;
     bool loadPreset(const char* jsonData) override;
 
-    // Enhanced preset system with section-based save/load
+    // Enhanced preset system with section-based save/load. Saves into a
+    // buffer fail (false) if the document does not fit; getPresetSize()
+    // returns the size needed, terminator included.
     bool savePresetEx(char* jsonBuffer, int jsonBufferSize, int sections) const;
     bool loadPresetEx(const char* jsonData, int sections);
+    int getPresetSize(int sections = PRESET_ALL) const;
+    bool savePreset(StateSink& sink, int sections = PRESET_ALL) const;  // No terminator
 
     // Convenience methods for pattern-only save/load
     bool savePattern(char* jsonBuffer, int jsonBufferSize) const;
@@ -925,8 +2470,77 @@ public:
     bool saveKit(char* jsonBuffer, int jsonBufferSize) const;
     bool loadKit(const char* jsonData);
 
+    // Compact binary state for host sessions: parameters, pattern, drill
+    // and kit. saveState() returns the size needed and writes only if it
+    // fits (pass nullptr to query). loadState() publishes the pattern like
+    // publishPattern(); it lands with the next step.
+    // sections limits the chunks written (PresetSection flags); loading
+    // such a partial state over an instance changes only those sections.
+    int saveState(uint8_t* buffer, int bufferSize, int sections = PRESET_ALL) const;
+    bool saveState(StateSink& sink, int sections = PRESET_ALL) const;
+    bool loadState(const uint8_t* data, int size);
+
+    // PresetSection flags edited since the last takeDirtySections() (all
+    // of them for a new instance), for saving only what changed
+    int getDirtySections() const { return dirtySections_.load(std::memory_order_relaxed); }
+    int takeDirtySections() { return dirtySections_.exchange(0, std::memory_order_relaxed); }
+    void markDirty(int sections) { dirtySections_.fetch_or(sections, std::memory_order_relaxed); }  // e.g. after a failed save
+
+    // Decoding without an instance, for preset banks and background threads.
+    // Fields the source leaves out keep the values already in preset.
+    static bool decodePreset(const char* jsonData, int sections, DecodedPreset& preset);
+    static bool decodeState(const uint8_t* data, int size, DecodedPreset& preset);
+
+    // Current state as a preset (message thread)
+    DecodedPreset capturePreset() const;
+
+    // Switch to a decoded preset: parameters apply at the next block, the
+    // pattern and drill state at the next bar (or step). Message thread.
+    void applyPreset(const DecodedPreset& preset, bool atBar = true);
+
     int getActiveVoiceCount() const override;
-    int getMaxPolyphony() const override { return 16; }  // 16 tracks
+    int getMaxPolyphony() const override { return sequencer_.getMaxPolyphony(); }  // Sum of voice pools
+
+    // Drill micro-hit CPU ceiling per step, and how often it has applied
+    void setMicroHitBudget(int hitsPerStep) { sequencer_.setMicroHitBudget(hitsPerStep); }
+    MicroHitStats getMicroHitStats() const { return sequencer_.getMicroHitStats(); }
+
+    // Parameter change telemetry (recorded by setParameter, logged off the
+    // calling thread)
+    TelemetryStats getTelemetryStats() const { return telemetry_.getStats(); }
+
+    // Render timings per stage, per voice group and per block, lock-free
+    // from any thread. Empty when built with DRUMMACHINE_PROFILING=0.
+    RenderProfile getRenderProfile() const;
+    void resetRenderProfile() { profiler_.reset(); }
+
+    // MIDI note -> track map used by NOTE_ON events (-1 = ignored).
+    // Default: notes 36-51 (C1-D#2, a 4x4 pad grid) play tracks 0-15.
+    void setNoteMapping(int midiNote, int trackIndex);
+    int getNoteMapping(int midiNote) const;
+    void resetNoteMapping();
+
+    // Optional multi-core rendering: voice groups are spread over numThreads
+    // threads (the audio thread included); 1 = serial (default). Call from
+    // the message thread, never while process() may be running.
+    void setRenderThreads(int numThreads, bool pinThreads = false);
+
+    // Editor thread: live pattern/kit edits and chaining without glitches.
+    // Build the complete state off the audio path; the audio thread swaps it
+    // in at the next bar or step boundary (see StepSequencer::publishSnapshot).
+    void publishPattern(const SequencerSnapshot& snapshot)
+    {
+        sequencer_.publishSnapshot(snapshot);
+        markDirty(PRESET_PATTERN);
+    }
+    int getRenderThreads() const { return workerPool_.getNumWorkers() + 1; }
+
+    // Faster-than-realtime bounce of the current pattern or a pattern chain
+    // (DrumMachineOffline.cpp). Not real-time safe: re-prepares and resets
+    // this instance, which keeps the last chain pattern afterwards. Output is
+    // deterministic for the same settings. Returns false if the settings are
+    // invalid or the sink stopped the render.
+    bool renderOffline(const OfflineRenderSettings& settings, OfflineRenderSink& sink);
 
     const char* getInstrumentName() const override { return "DrumMachine"; }
     const char* getInstrumentVersion() const override { return "1.0.0"; }
@@ -967,19 +2581,109 @@ private:
         // Per-track volumes
         float trackVolumes[16] = {0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f,
                                   0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f};
+
+        // Per-track mixer pan (-1 = left, 1 = right). Mixer state like the
+        // volumes: pattern edits and track swaps leave it alone
+        float trackPans[16] = {};
     } params_;
 
     VoiceParams voiceParams_;  // Drum voice parameters for kit presets
 
+    // Published parameter values and the set changed since the last block
+    static_assert(kNumDrumParams <= 64, "dirty mask holds one bit per parameter");
+    std::array<std::atomic<float>, kNumDrumParams> paramValues_;
+    std::atomic<uint64_t> dirtyParams_{0};
+    std::atomic<int> dirtySections_{PRESET_ALL};  // Edited since the last takeDirtySections()
+    ParameterTelemetry telemetry_;
+    RenderProfiler profiler_;
+    std::atomic<bool> lastBlockSilent_{true};
+    HostTransport hostTransport_;  // Render thread, consumed by the next block
+
+    // Pre-rendered hits; the generation counts kit changes
+    HitCache hitCache_;
+    std::atomic<bool> hitCacheEnabled_{false};
+    std::atomic<bool> hitCacheActive_{false};
+    std::atomic<uint32_t> kitGeneration_{0};
+    void updateHitCache();  // Audio thread, start of block
+
+    void applyParameterChanges();  // Audio thread, start of block
+    void applyParameter(DrumParam param, float value);
+
     double sampleRate_ = 48000.0;
     int blockSize_ = 512;
 
+    // Per-track render buffers (16 x maxChunk_), sized in prepare() so
+    // rendering never allocates; host blocks are split at maxChunk_
+    std::vector<float> trackScratch_;
+    std::array<float*, 16> trackBuffers_{};
+    int maxChunk_ = 0;
+
+    // Hits due in the chunk being rendered
+    static constexpr int kMaxBlockHits = 2 * kMaxMicroHitsPerStep;
+    std::array<BlockHit, kMaxBlockHits> blockHits_{};
+    int numBlockHits_ = 0;
+
+    // Multi-core rendering: workers 1..N mix into their own stereo bus,
+    // summed into the outputs once the chunk's jobs are done
+    RenderWorkerPool workerPool_;
+    std::vector<float> workerMix_;  // N x 2 x maxChunk_
+
+    // Chunk being rendered, read by the voice group jobs
+    float** chunkOutputs_ = nullptr;
+    float** chunkStems_ = nullptr;  // Optional: 32 per-track stereo channels
+    int chunkChannels_ = 0;
+    int chunkOffset_ = 0;
+    int chunkSamples_ = 0;
+    bool chunkDeferMix_ = false;  // Several buses and workers: mix after the jobs
+
+    // Output bus routing (OutputBusLayout, custom bus per track)
+    std::atomic<uint8_t> outputBusLayout_{0};
+    std::array<std::atomic<uint8_t>, 16> trackOutputBus_{};
+    std::array<uint8_t, 16> blockTrackBus_{};  // Resolved per block against the caller's buses
+    bool blockMultiBus_ = false;
+
+    void allocateRenderBuffers(int maxChunk);
+    bool renderChunk(float** outputs, float** stems, int numChannels, int offset, int numSamples);  // false: idle, skipped
+    bool beginChunk(float** outputs, float** stems, int numChannels, int offset, int numSamples);   // Hits; false: idle
+    void renderVoiceGroupJob(int group, int workerIndex);
+    void mixVoiceGroup(int group, int workerIndex);
+    static void runVoiceGroupJob(void* context, int jobIndex, int workerIndex);
+
+    // Per-track bus gains (constant-power pan x track volume x master volume).
+    // Targets are recomputed only when an input changes; the current gains
+    // ramp to them linearly across each block.
+    struct TrackMixGain
+    {
+        float pan = 0.0f;
+        float volume = 0.0f;
+        float left = 0.0f, right = 0.0f;
+        float targetLeft = 0.0f, targetRight = 0.0f;
+        float stepLeft = 0.0f, stepRight = 0.0f;  // Per-sample ramp
+    };
+    std::array<TrackMixGain, 16> mixGains_{};
+    bool mixGainsValid_ = false;  // false: snap to targets instead of ramping
+
+    void updateMixGains(int numSamples);
+    void resolveOutputBuses(float** outputs, int numChannels);
+
+    // Shared by process(), processStereo() and renderOffline(): track render
+    // and mix, plus optional per-track stems
+    void renderTracks(float** outputs, int numChannels, int numSamples, float** stems = nullptr);
+
+    // renderTracks() in steps, for DrumMachineBatch to run instances in
+    // lockstep: beginTracks(), then per chunk beginChunk(), the voice
+    // groups and advanceMixGains(), then finishTracks()
+    void beginTracks(float** outputs, int numChannels, int numSamples);
+    void advanceMixGains(int numSamples);
+    void finishTracks(bool silent);
+    friend class DrumMachineBatch;
+
+    // Stereo post-processing (DrumMachineStereo.cpp)
+    void processStereoRoom(float** outputs, int numChannels, int numSamples);
+    void processStereoEffects(float** outputs, int numChannels, int numSamples);
+    friend struct DrumStereoPresets;
+
     // JSON helper methods
-    bool writeJsonParameter(const char* name, double value, char* buffer,
-                            int& offset, int bufferSize) const;
-    bool writeJsonString(const char* name, const char* value, char* buffer,
-                         int& offset, int bufferSize) const;
-    bool parseJsonParameter(const char* json, const char* param, double& value) const;
     bool parseJsonString(const char* json, const char* param, char* value, int valueSize) const;
 
     // Voice parameter synchronization
@@ -987,6 +2691,180 @@ private:
     void syncVoiceParamsToDSP();
 
     std::array<bool, 16> activeVoices_{};  // Track MIDI-triggered voices
+
+    // Written from the UI/message thread, read in handleEvent()
+    std::array<std::atomic<int8_t>, 128> noteMap_;
+};
+
+//==============================================================================
+// Batch Rendering
+//==============================================================================
+
+// Many independent instances rendered together, for server-side bouncing.
+// Instances live in one contiguous array and render single-threaded; the
+// batch shards consecutive instances across its own worker pool, one shard
+// per job, so each core walks neighbouring instances. Configure instances
+// through getInstance() before prepare() or between process() calls.
+//
+// With setKickKernel(true), a shard runs its instances in lockstep, chunk
+// by chunk, and renders all of their kick voices together in one
+// KickVoiceBank; the other voice groups render per instance as usual.
+// Output is the same either way. Instances whose kicks play pre-rendered
+// hits keep the per-instance path. Off by default: the bank renders kicks
+// faster, but lockstep walks every instance of a shard once per stage, and
+// kicks are a small part of a full kit (see the benchmark's batch rows).
+class DrumMachineBatch
+{
+public:
+    explicit DrumMachineBatch(int numInstances);
+    ~DrumMachineBatch() = default;
+
+    DrumMachineBatch(const DrumMachineBatch&) = delete;
+    DrumMachineBatch& operator=(const DrumMachineBatch&) = delete;
+
+    int getNumInstances() const { return numInstances_; }
+    DrumMachinePureDSP& getInstance(int index) { return instances_[index]; }
+    const DrumMachinePureDSP& getInstance(int index) const { return instances_[index]; }
+
+    // Not real-time safe: prepares every instance and (re)starts the pool.
+    // numThreads includes the calling thread.
+    bool prepare(double sampleRate, int blockSize, int numThreads);
+    int getRenderThreads() const { return workers_.getNumWorkers() + 1; }
+
+    // outputs[instance * channelsPerInstance + channel]; each instance gets
+    // its own channelsPerInstance channels exactly as in process()
+    void process(float** outputs, int channelsPerInstance, int numSamples);
+
+    // values[instance]: one parameter set on every instance. Any thread.
+    void setParameter(DrumParam param, const float* values);
+
+    // Cross-instance kick rendering; takes effect at the next prepare()
+    void setKickKernel(bool enabled) { kickKernel_ = enabled; }
+    bool getKickKernel() const { return kickKernel_; }
+
+private:
+    static constexpr int kShardsPerThread = 4;  // Slack for uneven instances
+
+    static void runShard(void* context, int shard, int workerIndex);
+    void renderShard(int shard);
+    void renderShardLockstep(int shard, int first, int last);
+    void renderKicks(int shard, int first, int last, int numSamples);
+    float** getOutputs(int instance) const { return outputs_ + static_cast<size_t>(instance) * channelsPerInstance_; }
+
+    int numInstances_ = 0;
+    std::unique_ptr<DrumMachinePureDSP[]> instances_;
+    RenderWorkerPool workers_;
+    int shardSize_ = 1;
+
+    // Kick kernel: one bank per shard, sized for every kick voice of its
+    // instances, and each instance's progress through the current chunk
+    struct LockstepState
+    {
+        bool chunkActive = false;   // Not idle this chunk
+        bool blockActive = false;   // Not idle in some chunk of the block
+        bool kickKernel = false;    // Kicks render in the bank this chunk
+        int nextHit = 0;            // First block hit not yet triggered
+    };
+    bool kickKernel_ = false;
+    bool lockstep_ = false;  // kickKernel_ as of prepare()
+    std::vector<KickVoiceBank> kickBanks_;
+    std::vector<LockstepState> lockstepStates_;
+
+    // Current process() call, read by the shards
+    float** outputs_ = nullptr;
+    int channelsPerInstance_ = 0;
+    int numSamples_ = 0;
+};
+
+//==============================================================================
+// Preset Bank
+//==============================================================================
+
+struct PresetBankStats
+{
+    uint32_t hits = 0;          // get() served from the cache
+    uint32_t misses = 0;        // get() decoded on the calling thread
+    uint32_t evictions = 0;     // Decoded entries dropped for the memory bound
+    uint32_t decodeErrors = 0;  // Sources that did not parse
+};
+
+// In-memory preset library for instant program changes. Sources (JSON or
+// binary state) are kept; decoded presets are cached up to a memory bound
+// and evicted least recently used first. preload() decodes on a background
+// thread so a later get() is a cache hit. All methods are message-thread or
+// worker-thread safe; none are for the audio thread.
+class PresetBank
+{
+public:
+    static constexpr size_t kDefaultMaxCachedBytes = size_t(8) << 20;
+
+    explicit PresetBank(size_t maxCachedBytes = kDefaultMaxCachedBytes);
+    ~PresetBank();  // Stops the preload thread
+
+    PresetBank(const PresetBank&) = delete;
+    PresetBank& operator=(const PresetBank&) = delete;
+
+    // Add an entry, returns its index. addDecoded() entries stay resident
+    // (there is no source to decode them from again).
+    int addPreset(const std::string& name, const std::string& json, int sections = PRESET_ALL);
+    int addState(const std::string& name, const uint8_t* data, int size);
+    int addDecoded(const std::string& name, const DecodedPreset& preset);
+    void clear();
+
+    int getNumPresets() const;
+    std::string getName(int index) const;
+
+    // Queue decoding on the background thread
+    void preload(int index);
+    void preloadAll();
+    void waitForPreload();
+
+    // Decoded preset, decoded on this thread on a cache miss. nullptr for an
+    // invalid index or a source that does not parse. Stays valid after
+    // eviction for as long as the caller holds it.
+    std::shared_ptr<const DecodedPreset> get(int index);
+    bool isCached(int index) const;
+
+    void setMaxCachedBytes(size_t maxCachedBytes);
+    size_t getCachedBytes() const;
+    PresetBankStats getStats() const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::shared_ptr<const std::string> source;  // nullptr: resident
+        bool binary = false;
+        int sections = PRESET_ALL;
+
+        std::shared_ptr<const DecodedPreset> decoded;
+        size_t bytes = 0;
+        bool inLru = false;
+        std::list<int>::iterator lruPosition;
+    };
+
+    static std::shared_ptr<const DecodedPreset> decode(const std::string& source, bool binary, int sections);
+
+    // mutex_ held
+    void touch(int index);
+    void store(int index, std::shared_ptr<const DecodedPreset> decoded);
+    void evictToLimit();
+
+    void workerLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::vector<Entry> entries_;
+    std::list<int> lru_;  // Most recently used first, evictable entries only
+    std::deque<int> queue_;
+    size_t cachedBytes_ = 0;
+    size_t maxCachedBytes_;
+    PresetBankStats stats_;
+
+    std::thread worker_;
+    bool stopping_ = false;
+    bool decoding_ = false;
 };
 
 //==============================================================================
@@ -6,6 +6,7 @@
 //
 
 import AudioToolbox
+import AVFoundation
 
 @objc(AudioUnit)
 public class AudioUnit: AUAudioUnit {
@@ -13,6 +14,15 @@ public class AudioUnit: AUAudioUnit {
     var dsp: DrumMachineDSPWrapper?
     var parameterTree: AUParameterTree!
 
+    // Output buses, one per DSP layout bus (track n on bus n when per
+    // track); the DSP renders them all when the host pulls bus 0
+    static let outputBusCount = 16
+    private var outputBusArray: AUAudioUnitBusArray!
+
+    // Host clock, captured for the render block
+    private var musicalContext: AUHostMusicalContextBlock?
+    private var transportState: AUHostTransportStateBlock?
+
     // Drum Machine Parameters
     private let globalParameters: [AUParameterIdentifier: (name: String, range: ClosedRange<Float>, unit: AUUnitParameterUnit, defaultValue: Float)] = [
         "tempo": ("Tempo", 60.0...200.0, .bpm, 120.0),
@@ -48,6 +58,17 @@ public class AudioUnit: AUAudioUnit {
         // Initialize DSP wrapper
         dsp = DrumMachineDSPWrapper()
 
+        // Stereo output buses
+        let format = AVAudioFormat(standardFormatWithSampleRate: 48000.0, channels: 2)!
+        var busses: [AUAudioUnitBus] = []
+        for bus in 0..<AudioUnit.outputBusCount {
+            let outputBus = try AUAudioUnitBus(format: format)
+            outputBus.name = bus == 0 ? "Main" : "Out \(bus + 1)"
+            outputBus.maximumChannelCount = 2
+            busses.append(outputBus)
+        }
+        outputBusArray = AUAudioUnitBusArray(audioUnit: self, busType: .output, busses: busses)
+
         // Create parameter tree
         parameterTree = AUParameterTree()
 
@@ -173,46 +194,90 @@ public class AudioUnit: AUAudioUnit {
         }
     }
 
+    public override var outputBusses: AUAudioUnitBusArray {
+        return outputBusArray
+    }
+
     public override func allocateRenderResources() throws {
         try super.allocateRenderResources()
 
-        // Initialize DSP with current format
+        // Initialize DSP with current format; the bus count sizes its
+        // aux buffers, so it goes first
         if let dsp = dsp {
             let format = self.outputBusses[0].format
+            dsp.setOutputBusCount(Int32(self.outputBusses.count))
+
+            // Hosts that enable aux buses get one track per bus,
+            // otherwise everything plays on the main bus
+            let auxEnabled = (1..<self.outputBusses.count).contains { self.outputBusses[$0].isEnabled }
+            dsp.setOutputBusLayout(auxEnabled ? 1 : 0)
             dsp.initialize(withSampleRate: format.sampleRate,
                           maximumFramesToRender: Int32(self.maximumFramesToRender))
         }
+
+        musicalContext = self.musicalContextBlock
+        transportState = self.transportStateBlock
     }
 
     public override func deallocateRenderResources() {
+        musicalContext = nil
+        transportState = nil
         super.deallocateRenderResources()
     }
 
     public override var internalRenderBlock: AUInternalRenderBlock {
-        return { [weak self] timestamp, frameCount, outputBusNumber, outputBufferList, inputBusNumber, events in
+        return { [weak self] actionFlags, timestamp, frameCount, outputBusNumber, outputBufferList, events, pullInputBlock in
             guard let self = self else {
                 return kAudioUnitErr_InvalidProperty
             }
 
             // Process events (MIDI, parameters)
             for event in events {
-                self.handleEvent(event)
+                self.handleEvent(event, timestamp: timestamp, frameCount: frameCount)
+            }
+
+            // Aux buses were rendered with bus 0 this cycle: copy them out
+            if outputBusNumber != 0 {
+                guard let dsp = self.dsp,
+                      dsp.copyOutputBus(Int32(outputBusNumber), frameCount: frameCount,
+                                        outputBufferList: outputBufferList) else {
+                    return kAudioUnitErr_InvalidElement
+                }
+                if dsp.isOutputSilent() {
+                    actionFlags.pointee.insert(.unitRenderAction_OutputIsSilence)
+                }
+                return noErr
             }
 
-            // Render audio
+            // Host clock: steps follow its tempo, beat position and transport
+            var tempo = 0.0
+            var beatPosition = 0.0
+            if let musicalContext = self.musicalContext,
+               musicalContext(&tempo, nil, nil, &beatPosition, nil, nil) {
+                var flags = AUHostTransportStateFlags()
+                let moving = self.transportState.map { $0(&flags, nil, nil, nil) && flags.contains(.moving) } ?? true
+                self.dsp?.setHostTransport(tempo: tempo, beatPosition: beatPosition, playing: moving)
+            }
+
+            // Render audio (every bus, once per cycle)
             self.dsp?.process(frameCount: frameCount,
                             outputBufferList: outputBufferList,
                             timestamp: timestamp)
 
+            // Idle block: the buffers hold zeros, let the host skip them
+            if self.dsp?.isOutputSilent() == true {
+                actionFlags.pointee.insert(.unitRenderAction_OutputIsSilence)
+            }
             return noErr
         }
     }
 
-    private func handleEvent(_ event: AURenderEvent) {
+    private func handleEvent(_ event: AURenderEvent, timestamp: UnsafePointer<AudioTimeStamp>,
+                             frameCount: AUAudioFrameCount) {
         switch event.head.eventType {
         case .MIDI:
             if let midiEvent = event.MIDI {
-                self.handleMIDI(midiEvent)
+                self.handleMIDI(midiEvent, timestamp: timestamp, frameCount: frameCount)
             }
         case .parameter:
             if let parameterEvent = event.parameter {
@@ -223,12 +288,19 @@ public class AudioUnit: AUAudioUnit {
         }
     }
 
-    private func handleMIDI(_ event: AUMIDIEvent) {
+    private func handleMIDI(_ event: AUMIDIEvent, timestamp: UnsafePointer<AudioTimeStamp>,
+                            frameCount: AUAudioFrameCount) {
+        // Frames into this buffer; late or out-of-range events land at its edges
+        let bufferStart = AUEventSampleTime(timestamp.pointee.mSampleTime)
+        let lastFrame = max(AUEventSampleTime(frameCount) - 1, 0)
+        let sampleOffset = min(max(event.eventSampleTime - bufferStart, 0), lastFrame)
+
         var message = [UInt8](repeating: 0, count: Int(event.length))
         message.withMutableBufferPointer { buffer in
             if let baseAddress = buffer.baseAddress {
                 event.getData(&baseAddress.pointee)
-                self.dsp?.handleMIDIEvent(message, messageSize: UInt8(event.length))
+                self.dsp?.handleMIDIEvent(message, messageSize: UInt8(event.length),
+                                          sampleOffset: AUAudioFrameCount(sampleOffset))
             }
         }
     }
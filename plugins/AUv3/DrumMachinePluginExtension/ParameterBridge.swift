@@ -37,6 +37,31 @@ public class DrumMachineDSPWrapper: NSObject {
         }
     }
 
+    // Output buses: count before initialize, aux buses copied out per pull
+    public func setOutputBusCount(_ numBuses: Int32) {
+        if let ptr = dspPtr {
+            DrumMachineDSP_SetOutputBusCount(ptr, numBuses)
+        }
+    }
+
+    public func setOutputBusLayout(_ layout: Int32) {
+        if let ptr = dspPtr {
+            DrumMachineDSP_SetOutputBusLayout(ptr, layout)
+        }
+    }
+
+    public func copyOutputBus(_ bus: Int32, frameCount: UInt32,
+                              outputBufferList: UnsafeMutablePointer<AudioBufferList>) -> Bool {
+        guard let ptr = dspPtr else { return false }
+        return DrumMachineDSP_CopyOutputBus(ptr, bus, frameCount, outputBufferList)
+    }
+
+    // Last rendered buffer was all zeros (idle instance)
+    public func isOutputSilent() -> Bool {
+        guard let ptr = dspPtr else { return false }
+        return DrumMachineDSP_IsOutputSilent(ptr)
+    }
+
     public func setParameter(_ address: AUParameterAddress, value: Float) {
         if let ptr = dspPtr {
             DrumMachineDSP_SetParameter(ptr, address, value)
@@ -48,11 +73,12 @@ public class DrumMachineDSPWrapper: NSObject {
         return DrumMachineDSP_GetParameter(ptr, address)
     }
 
-    public func handleMIDIEvent(_ message: [UInt8], messageSize: UInt8) {
+    // sampleOffset: frames into the buffer about to be rendered
+    public func handleMIDIEvent(_ message: [UInt8], messageSize: UInt8, sampleOffset: UInt32 = 0) {
         if let ptr = dspPtr {
             message.withUnsafeBytes { bytes in
                 if let baseAddress = bytes.baseAddress {
-                    DrumMachineDSP_HandleMIDIEvent(ptr, baseAddress, messageSize)
+                    DrumMachineDSP_HandleMIDIEvent(ptr, baseAddress, messageSize, sampleOffset)
                 }
             }
         }
@@ -148,6 +174,26 @@ private func DrumMachineDSP_Process(_ dsp: OpaquePointer, _ frameCount: UInt32,
     impl.process(frameCount: frameCount, outputBufferList: outputBufferList, timestamp: timestamp)
 }
 
+private func DrumMachineDSP_SetOutputBusCount(_ dsp: OpaquePointer, _ numBuses: Int32) {
+    let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
+    impl.setOutputBusCount(numBuses)
+}
+
+private func DrumMachineDSP_SetOutputBusLayout(_ dsp: OpaquePointer, _ layout: Int32) {
+    let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
+    impl.setOutputBusLayout(layout)
+}
+
+private func DrumMachineDSP_CopyOutputBus(_ dsp: OpaquePointer, _ bus: Int32, _ frameCount: UInt32, _ outputBufferList: UnsafeMutablePointer<AudioBufferList>) -> Bool {
+    let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
+    return impl.copyOutputBus(bus, frameCount, outputBufferList)
+}
+
+private func DrumMachineDSP_IsOutputSilent(_ dsp: OpaquePointer) -> Bool {
+    let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
+    return impl.isOutputSilent()
+}
+
 private func DrumMachineDSP_SetParameter(_ dsp: OpaquePointer, _ address: AUParameterAddress, _ value: Float) {
     let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
     impl.setParameter(address, value: value)
@@ -158,10 +204,10 @@ private func DrumMachineDSP_GetParameter(_ dsp: OpaquePointer, _ address: AUPara
     return impl.getParameter(address)
 }
 
-private func DrumMachineDSP_HandleMIDIEvent(_ dsp: OpaquePointer, _ message: UnsafeRawPointer, _ messageSize: UInt8) {
+private func DrumMachineDSP_HandleMIDIEvent(_ dsp: OpaquePointer, _ message: UnsafeRawPointer, _ messageSize: UInt8, _ sampleOffset: UInt32) {
     let impl = Unmanaged<AnyObject>.fromOpaque(dsp).takeUnretainedValue() as! DrumMachineDSP
     let bytes = message.assumingMemoryBound(to: UInt8.self)
-    impl.handleMIDIEvent(bytes, messageSize: messageSize)
+    impl.handleMIDIEvent(bytes, messageSize: messageSize, sampleOffset: sampleOffset)
 }
 
 private func DrumMachineDSP_SetStep(_ dsp: OpaquePointer, _ track: Int32, _ step: Int32, _ active: Int32, _ velocity: UInt8) {
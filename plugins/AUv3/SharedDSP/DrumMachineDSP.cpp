@@ -10,6 +10,9 @@
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 class DrumMachineDSP::Impl {
 public:
@@ -26,6 +29,31 @@ public:
         if (dsp_) {
             dsp_->prepare(sampleRate, maximumFramesToRender);
         }
+
+        // Aux buses render here; bus 0 goes straight to the host buffers
+        maxFrames_ = maximumFramesToRender;
+        auxBuffers_.assign(static_cast<size_t>(numBuses_ - 1) * 2 * maxFrames_, 0.0f);
+    }
+
+    void setOutputBusCount(int numBuses) {
+        numBuses_ = std::max(1, std::min(numBuses, DSP::DrumMachinePureDSP::kMaxOutputBuses));
+    }
+
+    void setOutputBusLayout(int layout) {
+        if (dsp_ && layout >= 0 && layout < static_cast<int>(DSP::OutputBusLayout::Custom)) {
+            dsp_->setOutputBusLayout(static_cast<DSP::OutputBusLayout>(layout));
+        }
+    }
+
+    bool copyOutputBus(int bus, AUAudioFrameCount frameCount, AudioBufferList *outputBufferList) const {
+        if (bus <= 0 || bus >= numBuses_ || static_cast<int>(frameCount) > maxFrames_) return false;
+        if (!outputBufferList || outputBufferList->mNumberBuffers < 2) return false;
+
+        for (int ch = 0; ch < 2; ++ch) {
+            const float* source = auxBuffers_.data() + (static_cast<size_t>(bus - 1) * 2 + ch) * maxFrames_;
+            std::memcpy(outputBufferList->mBuffers[ch].mData, source, frameCount * sizeof(float));
+        }
+        return true;
     }
 
     void process(AUAudioFrameCount frameCount,
@@ -34,391 +62,68 @@ public:
                 AUAudioFrameCount inputBusNumber) {
         if (!dsp_) return;
 
-        // Process audio
-        float* outputs[2] = {
+        // Bus 0 renders into the host buffers, aux buses into ours
+        float* outputs[2 * DSP::DrumMachinePureDSP::kMaxOutputBuses] = {
             static_cast<float*>(outputBufferList->mBuffers[0].mData),
             static_cast<float*>(outputBufferList->mBuffers[1].mData)
         };
+        int numBuses = static_cast<int>(frameCount) <= maxFrames_ ? numBuses_ : 1;
+        for (int bus = 1; bus < numBuses; ++bus) {
+            outputs[2 * bus] = auxBuffers_.data() + static_cast<size_t>(bus - 1) * 2 * maxFrames_;
+            outputs[2 * bus + 1] = outputs[2 * bus] + maxFrames_;
+        }
 
-        // Render stereo output
-        float** outputPtr = outputs;
-        dsp_->process(outputPtr, 2, static_cast<int>(frameCount));
+        dsp_->process(outputs, 2 * numBuses, static_cast<int>(frameCount));
     }
 
-    void setParameter(AUParameterAddress address, float value) {
+    void setHostTransport(double tempo, double beatPosition, bool playing) {
         if (!dsp_) return;
 
-        // Map parameter address to DSP parameter
-        switch (static_cast<ParameterAddress>(address)) {
-            case Tempo:
-                dsp_->setParameter("tempo", value);
-                break;
-            case Swing:
-                dsp_->setParameter("swing", value);
-                break;
-            case MasterVolume:
-                dsp_->setParameter("masterVolume", value);
-                break;
-            case PatternLength:
-                dsp_->setParameter("patternLength", value);
-                break;
-            case PocketOffset:
-                dsp_->setParameter("pocketOffset", value);
-                break;
-            case PushOffset:
-                dsp_->setParameter("pushOffset", value);
-                break;
-            case PullOffset:
-                dsp_->setParameter("pullOffset", value);
-                break;
-            case DillaAmount:
-                dsp_->setParameter("dillaAmount", value);
-                break;
-            case DillaHatBias:
-                dsp_->setParameter("dillaHatBias", value);
-                break;
-            case DillaSnareLate:
-                dsp_->setParameter("dillaSnareLate", value);
-                break;
-            case DillaKickTight:
-                dsp_->setParameter("dillaKickTight", value);
-                break;
-            case DillaMaxDrift:
-                dsp_->setParameter("dillaMaxDrift", value);
-                break;
-            case Structure:
-                dsp_->setParameter("structure", value);
-                break;
-            case StereoWidth:
-                dsp_->setParameter("stereoWidth", value);
-                break;
-            case RoomWidth:
-                dsp_->setParameter("roomWidth", value);
-                break;
-            case EffectsWidth:
-                dsp_->setParameter("effectsWidth", value);
-                break;
-
-            // Per-track volumes
-            case TrackVolume0: case TrackVolume1: case TrackVolume2: case TrackVolume3:
-            case TrackVolume4: case TrackVolume5: case TrackVolume6: case TrackVolume7:
-            case TrackVolume8: case TrackVolume9: case TrackVolume10: case TrackVolume11:
-            case TrackVolume12: case TrackVolume13: case TrackVolume14: case TrackVolume15:
-            {
-                int trackIndex = static_cast<int>(address) - static_cast<int>(TrackVolume0);
-                char paramId[32];
-                snprintf(paramId, sizeof(paramId), "trackVolume_%d", trackIndex);
-                dsp_->setParameter(paramId, value);
-                break;
-            }
+        DSP::HostTransport transport;
+        transport.valid = true;
+        transport.playing = playing;
+        transport.tempo = tempo;
+        transport.ppqPosition = beatPosition;
+        dsp_->setHostTransport(transport);
+    }
 
-            // Voice parameters (Kick)
-            case KickPitch:
-                dsp_->setParameter("kickPitch", value);
-                break;
-            case KickDecay:
-                dsp_->setParameter("kickDecay", value);
-                break;
-            case KickClick:
-                dsp_->setParameter("kickClick", value);
-                break;
-
-            // Voice parameters (Snare)
-            case SnareTone:
-                dsp_->setParameter("snareTone", value);
-                break;
-            case SnareDecay:
-                dsp_->setParameter("snareDecay", value);
-                break;
-            case SnareSnap:
-                dsp_->setParameter("snareSnap", value);
-                break;
-
-            // Voice parameters (HiHat Closed)
-            case HiHatClosedTone:
-                dsp_->setParameter("hihatClosedTone", value);
-                break;
-            case HiHatClosedDecay:
-                dsp_->setParameter("hihatClosedDecay", value);
-                break;
-            case HiHatClosedMetallic:
-                dsp_->setParameter("hihatClosedMetallic", value);
-                break;
-
-            // Voice parameters (HiHat Open)
-            case HiHatOpenTone:
-                dsp_->setParameter("hihatOpenTone", value);
-                break;
-            case HiHatOpenDecay:
-                dsp_->setParameter("hihatOpenDecay", value);
-                break;
-            case HiHatOpenMetallic:
-                dsp_->setParameter("hihatOpenMetallic", value);
-                break;
-
-            // Voice parameters (Clap)
-            case ClapTone:
-                dsp_->setParameter("clapTone", value);
-                break;
-            case ClapDecay:
-                dsp_->setParameter("clapDecay", value);
-                break;
-            case ClapNumImpulses:
-                dsp_->setParameter("clapNumImpulses", value);
-                break;
-
-            // Voice parameters (Tom Low)
-            case TomLowPitch:
-                dsp_->setParameter("tomLowPitch", value);
-                break;
-            case TomLowDecay:
-                dsp_->setParameter("tomLowDecay", value);
-                break;
-            case TomLowTone:
-                dsp_->setParameter("tomLowTone", value);
-                break;
-
-            // Voice parameters (Tom Mid)
-            case TomMidPitch:
-                dsp_->setParameter("tomMidPitch", value);
-                break;
-            case TomMidDecay:
-                dsp_->setParameter("tomMidDecay", value);
-                break;
-            case TomMidTone:
-                dsp_->setParameter("tomMidTone", value);
-                break;
-
-            // Voice parameters (Tom High)
-            case TomHighPitch:
-                dsp_->setParameter("tomHighPitch", value);
-                break;
-            case TomHighDecay:
-                dsp_->setParameter("tomHighDecay", value);
-                break;
-            case TomHighTone:
-                dsp_->setParameter("tomHighTone", value);
-                break;
-
-            // Voice parameters (Crash)
-            case CrashTone:
-                dsp_->setParameter("crashTone", value);
-                break;
-            case CrashDecay:
-                dsp_->setParameter("crashDecay", value);
-                break;
-            case CrashMetallic:
-                dsp_->setParameter("crashMetallic", value);
-                break;
-
-            // Voice parameters (Ride)
-            case RideTone:
-                dsp_->setParameter("rideTone", value);
-                break;
-            case RideDecay:
-                dsp_->setParameter("rideDecay", value);
-                break;
-            case RideMetallic:
-                dsp_->setParameter("rideMetallic", value);
-                break;
-
-            // Voice parameters (Cowbell)
-            case CowbellPitch:
-                dsp_->setParameter("cowbellPitch", value);
-                break;
-            case CowbellDecay:
-                dsp_->setParameter("cowbellDecay", value);
-                break;
-            case CowbellTone:
-                dsp_->setParameter("cowbellTone", value);
-                break;
-
-            // Voice parameters (Shaker)
-            case ShakerTone:
-                dsp_->setParameter("shakerTone", value);
-                break;
-            case ShakerDecay:
-                dsp_->setParameter("shakerDecay", value);
-                break;
-            case ShakerMetallic:
-                dsp_->setParameter("shakerMetallic", value);
-                break;
-
-            // Voice parameters (Tambourine)
-            case TambourineTone:
-                dsp_->setParameter("tambourineTone", value);
-                break;
-            case TambourineDecay:
-                dsp_->setParameter("tambourineDecay", value);
-                break;
-            case TambourineMetallic:
-                dsp_->setParameter("tambourineMetallic", value);
-                break;
-
-            // Voice parameters (Percussion)
-            case PercussionPitch:
-                dsp_->setParameter("percussionPitch", value);
-                break;
-            case PercussionDecay:
-                dsp_->setParameter("percussionDecay", value);
-                break;
-            case PercussionTone:
-                dsp_->setParameter("percussionTone", value);
-                break;
-
-            // Voice parameters (Special)
-            case SpecialTone:
-                dsp_->setParameter("specialTone", value);
-                break;
-            case SpecialDecay:
-                dsp_->setParameter("specialDecay", value);
-                break;
-            case SpecialSnap:
-                dsp_->setParameter("specialSnap", value);
-                break;
-
-            default:
-                break;
+    bool isOutputSilent() const {
+        return dsp_ && dsp_->isLastBlockSilent();
+    }
+
+    void setParameter(AUParameterAddress address, float value) {
+        if (!dsp_) return;
+
+        // Integer path: no string IDs on the render/automation thread
+        DSP::DrumParam param = toDrumParam(address);
+        if (param != DSP::DrumParam::Count) {
+            dsp_->setParameter(param, value);
         }
     }
 
     float getParameter(AUParameterAddress address) const {
         if (!dsp_) return 0.0f;
 
-        // Map parameter address to DSP parameter
-        const char* paramId = nullptr;
-        switch (static_cast<ParameterAddress>(address)) {
-            case Tempo: paramId = "tempo"; break;
-            case Swing: paramId = "swing"; break;
-            case MasterVolume: paramId = "masterVolume"; break;
-            case PatternLength: paramId = "patternLength"; break;
-            case PocketOffset: paramId = "pocketOffset"; break;
-            case PushOffset: paramId = "pushOffset"; break;
-            case PullOffset: paramId = "pullOffset"; break;
-            case DillaAmount: paramId = "dillaAmount"; break;
-            case DillaHatBias: paramId = "dillaHatBias"; break;
-            case DillaSnareLate: paramId = "dillaSnareLate"; break;
-            case DillaKickTight: paramId = "dillaKickTight"; break;
-            case DillaMaxDrift: paramId = "dillaMaxDrift"; break;
-            case Structure: paramId = "structure"; break;
-            case StereoWidth: paramId = "stereoWidth"; break;
-            case RoomWidth: paramId = "roomWidth"; break;
-            case EffectsWidth: paramId = "effectsWidth"; break;
-
-            case KickPitch: paramId = "kickPitch"; break;
-            case KickDecay: paramId = "kickDecay"; break;
-            case KickClick: paramId = "kickClick"; break;
-
-            case SnareTone: paramId = "snareTone"; break;
-            case SnareDecay: paramId = "snareDecay"; break;
-            case SnareSnap: paramId = "snareSnap"; break;
-
-            case HiHatClosedTone: paramId = "hihatClosedTone"; break;
-            case HiHatClosedDecay: paramId = "hihatClosedDecay"; break;
-            case HiHatClosedMetallic: paramId = "hihatClosedMetallic"; break;
-
-            case HiHatOpenTone: paramId = "hihatOpenTone"; break;
-            case HiHatOpenDecay: paramId = "hihatOpenDecay"; break;
-            case HiHatOpenMetallic: paramId = "hihatOpenMetallic"; break;
-
-            case ClapTone: paramId = "clapTone"; break;
-            case ClapDecay: paramId = "clapDecay"; break;
-            case ClapNumImpulses: paramId = "clapNumImpulses"; break;
-
-            case TomLowPitch: paramId = "tomLowPitch"; break;
-            case TomLowDecay: paramId = "tomLowDecay"; break;
-            case TomLowTone: paramId = "tomLowTone"; break;
-
-            case TomMidPitch: paramId = "tomMidPitch"; break;
-            case TomMidDecay: paramId = "tomMidDecay"; break;
-            case TomMidTone: paramId = "tomMidTone"; break;
-
-            case TomHighPitch: paramId = "tomHighPitch"; break;
-            case TomHighDecay: paramId = "tomHighDecay"; break;
-            case TomHighTone: paramId = "tomHighTone"; break;
-
-            case CrashTone: paramId = "crashTone"; break;
-            case CrashDecay: paramId = "crashDecay"; break;
-            case CrashMetallic: paramId = "crashMetallic"; break;
-
-            case RideTone: paramId = "rideTone"; break;
-            case RideDecay: paramId = "rideDecay"; break;
-            case RideMetallic: paramId = "rideMetallic"; break;
-
-            case CowbellPitch: paramId = "cowbellPitch"; break;
-            case CowbellDecay: paramId = "cowbellDecay"; break;
-            case CowbellTone: paramId = "cowbellTone"; break;
-
-            case ShakerTone: paramId = "shakerTone"; break;
-            case ShakerDecay: paramId = "shakerDecay"; break;
-            case ShakerMetallic: paramId = "shakerMetallic"; break;
-
-            case TambourineTone: paramId = "tambourineTone"; break;
-            case TambourineDecay: paramId = "tambourineDecay"; break;
-            case TambourineMetallic: paramId = "tambourineMetallic"; break;
-
-            case PercussionPitch: paramId = "percussionPitch"; break;
-            case PercussionDecay: paramId = "percussionDecay"; break;
-            case PercussionTone: paramId = "percussionTone"; break;
-
-            case SpecialTone: paramId = "specialTone"; break;
-            case SpecialDecay: paramId = "specialDecay"; break;
-            case SpecialSnap: paramId = "specialSnap"; break;
-
-            default:
-                // Handle per-track volumes
-                if (address >= static_cast<AUParameterAddress>(TrackVolume0) &&
-                    address <= static_cast<AUParameterAddress>(TrackVolume15)) {
-                    int trackIndex = static_cast<int>(address) - static_cast<int>(TrackVolume0);
-                    char paramIdBuffer[32];
-                    snprintf(paramIdBuffer, sizeof(paramIdBuffer), "trackVolume_%d", trackIndex);
-                    return dsp_->getParameter(paramIdBuffer);
-                }
-                return 0.0f;
-        }
-
-        return dsp_->getParameter(paramId);
+        DSP::DrumParam param = toDrumParam(address);
+        return (param != DSP::DrumParam::Count) ? dsp_->getParameter(param) : 0.0f;
     }
 
-    void handleMIDIEvent(const uint8_t *message, uint8_t messageSize) {
+    void handleMIDIEvent(const uint8_t *message, uint8_t messageSize, AUAudioFrameCount sampleOffset) {
         if (!dsp_ || messageSize < 3) return;
 
         uint8_t status = message[0];
-        uint8_t data1 = message[1];
-        uint8_t data2 = message[2];
-
-        // Map MIDI note to track (C2 = Kick, D2 = Snare, etc.)
-        int trackIndex = -1;
-        if (status >= 0x90 && status < 0xA0) { // Note On
-            uint8_t note = data1;
-            uint8_t velocity = data2;
-
-            // MIDI note to drum mapping
-            // C2 (36) = Kick, D2 (38) = Snare, etc.
-            if (note >= 36 && note < 52) {
-                trackIndex = note - 36; // Map to tracks 0-15
-            }
-
-            if (trackIndex >= 0 && trackIndex < 16) {
-                DSP::ScheduledEvent event;
-                event.type = DSP::ScheduledEventType::NoteOn;
-                event.note = trackIndex;
-                event.velocity = velocity / 127.0f;
-                dsp_->handleEvent(event);
-            }
-        } else if (status >= 0x80 && status < 0x90) { // Note Off
-            uint8_t note = data1;
-
-            if (note >= 36 && note < 52) {
-                trackIndex = note - 36;
-            }
-
-            if (trackIndex >= 0 && trackIndex < 16) {
-                DSP::ScheduledEvent event;
-                event.type = DSP::ScheduledEventType::NoteOff;
-                event.note = trackIndex;
-                dsp_->handleEvent(event);
-            }
+        uint8_t note = message[1];
+        uint8_t velocity = message[2];
+
+        // Note On with non-zero velocity; the DSP note map picks the track
+        if (status >= 0x90 && status < 0xA0 && velocity > 0) {
+            DSP::ScheduledEvent event;
+            event.type = DSP::ScheduledEvent::NOTE_ON;
+            event.time = 0.0;
+            event.sampleOffset = sampleOffset;
+            event.data.note.midiNote = note;
+            event.data.note.velocity = velocity / 127.0f;
+            dsp_->handleEvent(event);
         }
     }
 
@@ -447,13 +152,70 @@ public:
 
     const char *getState() const {
         if (!dsp_) return nullptr;
-        static char stateBuffer[65536];
-        if (dsp_->savePreset(stateBuffer, sizeof(stateBuffer))) {
-            return stateBuffer;
+        std::lock_guard<std::mutex> lock(stateMutex_);
+
+        // Sized to the document; retried if an edit grew it in between
+        int size = dsp_->getPresetSize();
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            stateJson_.resize(static_cast<size_t>(size));
+            if (dsp_->savePreset(stateJson_.data(), size)) {
+                return stateJson_.data();
+            }
+            size = dsp_->getPresetSize() + 256;
         }
         return nullptr;
     }
 
+    bool writeState(DrumMachineDSP::StateWriteFn write, void *context) const {
+        if (!dsp_ || !write) return false;
+        CallbackSink sink(write, context);
+        return dsp_->savePreset(sink);
+    }
+
+    bool writeStateData(DrumMachineDSP::StateWriteFn write, void *context, bool changedOnly) const {
+        if (!dsp_ || !write) return false;
+        CallbackSink sink(write, context);
+        if (!changedOnly) return dsp_->saveState(sink);
+
+        // A failed delta leaves its sections for the next one
+        const int sections = dsp_->takeDirtySections();
+        if (dsp_->saveState(sink, sections)) return true;
+        dsp_->markDirty(sections);
+        return false;
+    }
+
+    DrumMachineDSP::RenderStats getRenderStats() const {
+        DrumMachineDSP::RenderStats stats;
+        if (!dsp_) return stats;
+        const DSP::RenderProfile profile = dsp_->getRenderProfile();
+        stats.blocks = profile.blocks;
+        stats.worstBlockNanos = profile.worstBlockNs;
+        stats.averageLoad = profile.averageLoad;
+        stats.worstLoad = profile.worstLoad;
+        for (int i = 0; i < DSP::kNumProfileStages && i < 4; ++i)
+            stats.stageNanos[i] = profile.stageNs[i];
+        for (int i = 0; i < DSP::StepSequencer::kNumVoiceGroups && i < 15; ++i)
+            stats.voiceGroupNanos[i] = profile.voiceGroupNs[i];
+        stats.microHitsScheduled = profile.microHits.scheduled;
+        stats.microHitsDropped = profile.microHits.dropped;
+        stats.activeVoices = profile.activeVoices;
+        return stats;
+    }
+
+    void resetRenderStats() {
+        if (dsp_) dsp_->resetRenderProfile();
+    }
+
+    int getStateData(uint8_t *buffer, int bufferSize) const {
+        if (!dsp_) return 0;
+        return dsp_->saveState(buffer, bufferSize);
+    }
+
+    bool setStateData(const uint8_t *data, int size) {
+        if (!dsp_ || !data) return false;
+        return dsp_->loadState(data, size);
+    }
+
     bool savePattern(char *jsonBuffer, int jsonBufferSize) const {
         if (!dsp_) return false;
         return dsp_->savePattern(jsonBuffer, jsonBufferSize);
@@ -475,7 +237,39 @@ public:
     }
 
 private:
+    // Forwards streamed state to a host callback
+    class CallbackSink : public DSP::StateSink {
+    public:
+        CallbackSink(DrumMachineDSP::StateWriteFn write, void *context) : write_(write), context_(context) {}
+        bool write(const void *data, int numBytes) override { return write_(context_, data, numBytes); }
+
+    private:
+        DrumMachineDSP::StateWriteFn write_;
+        void *context_;
+    };
+
+    // Global and track-volume addresses share the DSP parameter order.
+    // Voice, transport and pattern addresses have no DSP parameter yet.
+    static DSP::DrumParam toDrumParam(AUParameterAddress address) {
+        static_assert(static_cast<int>(Tempo) == static_cast<int>(DSP::DrumParam::Tempo), "AU/DSP order");
+        static_assert(static_cast<int>(EffectsWidth) == static_cast<int>(DSP::DrumParam::EffectsWidth), "AU/DSP order");
+        static_assert(static_cast<int>(TrackVolume0) == static_cast<int>(DSP::DrumParam::TrackVolume0), "AU/DSP order");
+
+        if (address <= static_cast<AUParameterAddress>(TrackVolume15)) {
+            return static_cast<DSP::DrumParam>(address);
+        }
+        return DSP::DrumParam::Count;
+    }
+
     DSP::DrumMachinePureDSP* dsp_;
+
+    int numBuses_ = 1;
+    int maxFrames_ = 0;
+    std::vector<float> auxBuffers_;
+
+    // getState() result, per instance
+    mutable std::mutex stateMutex_;
+    mutable std::vector<char> stateJson_;
 };
 
 // Public interface implementation
@@ -494,6 +288,26 @@ void DrumMachineDSP::process(AUAudioFrameCount frameCount,
     impl->process(frameCount, outputBufferList, timestamp, inputBusNumber);
 }
 
+void DrumMachineDSP::setOutputBusCount(int numBuses) {
+    impl->setOutputBusCount(numBuses);
+}
+
+void DrumMachineDSP::setOutputBusLayout(int layout) {
+    impl->setOutputBusLayout(layout);
+}
+
+bool DrumMachineDSP::copyOutputBus(int bus, AUAudioFrameCount frameCount, AudioBufferList *outputBufferList) const {
+    return impl->copyOutputBus(bus, frameCount, outputBufferList);
+}
+
+void DrumMachineDSP::setHostTransport(double tempo, double beatPosition, bool playing) {
+    impl->setHostTransport(tempo, beatPosition, playing);
+}
+
+bool DrumMachineDSP::isOutputSilent() const {
+    return impl->isOutputSilent();
+}
+
 void DrumMachineDSP::setParameter(AUParameterAddress address, float value) {
     impl->setParameter(address, value);
 }
@@ -502,8 +316,9 @@ float DrumMachineDSP::getParameter(AUParameterAddress address) const {
     return impl->getParameter(address);
 }
 
-void DrumMachineDSP::handleMIDIEvent(const uint8_t *message, uint8_t messageSize) {
-    impl->handleMIDIEvent(message, messageSize);
+void DrumMachineDSP::handleMIDIEvent(const uint8_t *message, uint8_t messageSize,
+                                     AUAudioFrameCount sampleOffset) {
+    impl->handleMIDIEvent(message, messageSize, sampleOffset);
 }
 
 void DrumMachineDSP::setStep(int track, int step, bool active, uint8_t velocity) {
@@ -526,6 +341,22 @@ const char *DrumMachineDSP::getState() const {
     return impl->getState();
 }
 
+int DrumMachineDSP::getStateData(uint8_t *buffer, int bufferSize) const {
+    return impl->getStateData(buffer, bufferSize);
+}
+
+bool DrumMachineDSP::setStateData(const uint8_t *data, int size) {
+    return impl->setStateData(data, size);
+}
+
+bool DrumMachineDSP::writeState(StateWriteFn write, void *context) const {
+    return impl->writeState(write, context);
+}
+
+bool DrumMachineDSP::writeStateData(StateWriteFn write, void *context, bool changedOnly) const {
+    return impl->writeStateData(write, context, changedOnly);
+}
+
 bool DrumMachineDSP::savePattern(char *jsonBuffer, int jsonBufferSize) const {
     return impl->savePattern(jsonBuffer, jsonBufferSize);
 }
@@ -541,3 +372,11 @@ bool DrumMachineDSP::saveKit(char *jsonBuffer, int jsonBufferSize) const {
 bool DrumMachineDSP::loadKit(const char *jsonData) {
     return impl->loadKit(jsonData);
 }
+
+DrumMachineDSP::RenderStats DrumMachineDSP::getRenderStats() const {
+    return impl->getRenderStats();
+}
+
+void DrumMachineDSP::resetRenderStats() {
+    impl->resetRenderStats();
+}
@@ -26,6 +26,24 @@ public:
                 const AUEventSampleTime *timestamp,
                 AUAudioFrameCount inputBusNumber = 0);
 
+    // Host clock for the next process() call, from the render block's
+    // musicalContextBlock (tempo, beat position) and transportStateBlock
+    // (moving). Call once per render cycle; without it the sequencer
+    // free-runs on its own tempo parameter.
+    void setHostTransport(double tempo, double beatPosition, bool playing);
+
+    // Output buses. Set the count (1-16) before initialize(); process()
+    // renders bus 0 into its buffer list and the other buses into internal
+    // buffers, which copyOutputBus() hands to the host as it pulls each bus.
+    // Layout: 0 mix, 1 per track, 2 groups (DSP::OutputBusLayout).
+    void setOutputBusCount(int numBuses);
+    void setOutputBusLayout(int layout);
+    bool copyOutputBus(int bus, AUAudioFrameCount frameCount, AudioBufferList *outputBufferList) const;
+
+    // The last process() output was all zeros (instance idle); the render
+    // block can set kAudioUnitRenderAction_OutputIsSilence
+    bool isOutputSilent() const;
+
     // Parameters
     enum ParameterAddress : AUParameterAddress {
         // Global parameters
@@ -160,18 +178,34 @@ public:
     void setParameter(AUParameterAddress address, float value);
     float getParameter(AUParameterAddress address) const;
 
-    // MIDI
-    void handleMIDIEvent(const uint8_t *message, uint8_t messageSize);
+    // MIDI (sampleOffset: frames into the next rendered buffer)
+    void handleMIDIEvent(const uint8_t *message, uint8_t messageSize,
+                         AUAudioFrameCount sampleOffset = 0);
 
     // Step sequencer control
     void setStep(int track, int step, bool active, uint8_t velocity);
     bool getStep(int track, int step) const;
     uint8_t getStepVelocity(int track, int step) const;
 
-    // Presets
+    // Presets. getState() returns this instance's own copy of the JSON
+    // preset, valid until its next getState() call.
     void setState(const char *stateData);
     const char *getState() const;
 
+    // Binary session state (parameters, pattern, drill, kit). Returns the
+    // size needed; writes only if it fits (nullptr queries the size).
+    int getStateData(uint8_t *buffer, int bufferSize) const;
+    bool setStateData(const uint8_t *data, int size);
+
+    // Streaming saves: write receives the state in order, in pieces, on the
+    // calling thread, and returns false to stop. Instances share nothing,
+    // so hosts can save many at once. With changedOnly, only sections
+    // edited since the last changedOnly save are written; setStateData()
+    // with that delta over the previous state brings it up to date.
+    using StateWriteFn = bool (*)(void *context, const void *data, int size);
+    bool writeState(StateWriteFn write, void *context) const;
+    bool writeStateData(StateWriteFn write, void *context, bool changedOnly = false) const;
+
     // Pattern save/load
     bool savePattern(char *jsonBuffer, int jsonBufferSize) const;
     bool loadPattern(const char *jsonData);
@@ -180,6 +214,22 @@ public:
     bool saveKit(char *jsonBuffer, int jsonBufferSize) const;
     bool loadKit(const char *jsonData);
 
+    // Render profiling, lock-free from the UI thread. Load is render
+    // time over audio time (1.0 = the whole real-time budget).
+    struct RenderStats {
+        uint64_t blocks = 0;
+        uint64_t worstBlockNanos = 0;
+        float averageLoad = 0.0f;
+        float worstLoad = 0.0f;
+        uint64_t stageNanos[4] = {};       // Sequencer, voices, mix, stereo
+        uint64_t voiceGroupNanos[15] = {}; // Kick ... special
+        uint32_t microHitsScheduled = 0;
+        uint32_t microHitsDropped = 0;
+        int activeVoices = 0;
+    };
+    RenderStats getRenderStats() const;
+    void resetRenderStats();
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl;
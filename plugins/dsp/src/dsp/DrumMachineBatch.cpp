@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    DrumMachineBatch.cpp
+    Many independent instances rendered per block, sharded across cores,
+    with the kick voices of a shard rendered together
+
+  ==============================================================================
+*/
+
+#include "dsp/DrumMachinePureDSP.h"
+
+namespace DSP {
+
+//==============================================================================
+// DrumMachineBatch
+//==============================================================================
+
+DrumMachineBatch::DrumMachineBatch(int numInstances)
+    : numInstances_(std::max(0, numInstances)),
+      instances_(new DrumMachinePureDSP[static_cast<size_t>(std::max(0, numInstances))])
+{
+}
+
+bool DrumMachineBatch::prepare(double sampleRate, int blockSize, int numThreads)
+{
+    workers_.stop();
+
+    // The batch parallelizes across instances, not within one
+    bool prepared = true;
+    for (int i = 0; i < numInstances_; ++i)
+    {
+        instances_[i].setRenderThreads(1);
+        prepared = instances_[i].prepare(sampleRate, blockSize) && prepared;
+    }
+
+    const int threads = std::max(1, std::min(numThreads, std::max(1, numInstances_)));
+    if (threads > 1)
+        workers_.start(threads - 1, false);
+
+    const int numShards = std::min(numInstances_, threads * kShardsPerThread);
+    shardSize_ = numShards > 0 ? (numInstances_ + numShards - 1) / numShards : 1;
+
+    lockstep_ = kickKernel_;
+    kickBanks_.clear();
+    lockstepStates_.assign(static_cast<size_t>(numInstances_), LockstepState{});
+    if (lockstep_)
+    {
+        kickBanks_.resize(static_cast<size_t>(numShards));
+        for (auto& bank : kickBanks_)
+            bank.allocate(shardSize_ * VoicePool<KickVoice>::kMaxVoices);
+    }
+    return prepared;
+}
+
+void DrumMachineBatch::process(float** outputs, int channelsPerInstance, int numSamples)
+{
+    if (numInstances_ == 0 || numSamples <= 0) return;
+
+    outputs_ = outputs;
+    channelsPerInstance_ = channelsPerInstance;
+    numSamples_ = numSamples;
+
+    const int numShards = (numInstances_ + shardSize_ - 1) / shardSize_;
+    if (workers_.getNumWorkers() == 0)
+    {
+        for (int shard = 0; shard < numShards; ++shard)
+            renderShard(shard);
+        return;
+    }
+
+    workers_.run(&DrumMachineBatch::runShard, this, numShards);
+}
+
+void DrumMachineBatch::runShard(void* context, int shard, int)
+{
+    static_cast<DrumMachineBatch*>(context)->renderShard(shard);
+}
+
+void DrumMachineBatch::renderShard(int shard)
+{
+    const int first = shard * shardSize_;
+    const int last = std::min(numInstances_, first + shardSize_);
+    if (lockstep_)
+    {
+        renderShardLockstep(shard, first, last);
+        return;
+    }
+
+    for (int i = first; i < last; ++i)
+        instances_[i].process(getOutputs(i), channelsPerInstance_, numSamples_);
+}
+
+void DrumMachineBatch::renderShardLockstep(int shard, int first, int last)
+{
+    // DrumMachinePureDSP::process() for every instance of the shard, one
+    // chunk at a time. The shard's instances share its block time.
+    RealtimeNoAllocScope noAlloc;
+    const int64_t blockStart = RenderProfiler::now();
+
+    for (int i = first; i < last; ++i)
+    {
+        instances_[i].beginTracks(getOutputs(i), channelsPerInstance_, numSamples_);
+        lockstepStates_[i].blockActive = false;
+    }
+
+    const int maxChunk = instances_[first].maxChunk_;
+    for (int offset = 0; offset < numSamples_;)
+    {
+        const int chunk = std::min(numSamples_ - offset, maxChunk);
+        for (int i = first; i < last; ++i)
+        {
+            LockstepState& state = lockstepStates_[i];
+            state.chunkActive = instances_[i].beginChunk(getOutputs(i), nullptr, channelsPerInstance_, offset, chunk);
+            state.blockActive = state.blockActive || state.chunkActive;
+        }
+
+        renderKicks(shard, first, last, chunk);
+
+        for (int i = first; i < last; ++i)
+        {
+            DrumMachinePureDSP& instance = instances_[i];
+            if (lockstepStates_[i].chunkActive)
+            {
+                for (int group = 1; group < StepSequencer::kNumVoiceGroups; ++group)
+                    instance.renderVoiceGroupJob(group, 0);
+            }
+            instance.advanceMixGains(chunk);
+        }
+        offset += chunk;
+    }
+
+    for (int i = first; i < last; ++i)
+    {
+        DrumMachinePureDSP& instance = instances_[i];
+        instance.finishTracks(!lockstepStates_[i].blockActive);
+        instance.profiler_.endBlock(blockStart, numSamples_, instance.sampleRate_, instance.sequencer_);
+    }
+}
+
+void DrumMachineBatch::renderKicks(int shard, int first, int last, int numSamples)
+{
+    // StepSequencer::renderVoiceGroup() for the kick group of every active
+    // instance, with the segments between hits rendered in one bank
+    constexpr Track::DrumType kKick = Track::DrumType::Kick;
+    constexpr int kKickGroup = static_cast<int>(kKick);
+    static_assert(std::is_same<DrumVoiceTraits<kKick>::Voice, KickVoice>::value, "the bank renders KickVoice");
+
+    for (int i = first; i < last; ++i)
+    {
+        LockstepState& state = lockstepStates_[i];
+        DrumMachinePureDSP& instance = instances_[i];
+        auto& pool = instance.sequencer_.getVoicePool<kKick>();
+
+        state.kickKernel = state.chunkActive && !pool.hasHitCache() && pool.getCachedActiveCount() == 0;
+        state.nextHit = 0;
+        if (!state.chunkActive) continue;
+        if (!state.kickKernel)
+        {
+            instance.renderVoiceGroupJob(kKickGroup, 0);
+            continue;
+        }
+
+        for (int track = 0; track < 16; ++track)
+        {
+            if (instance.sequencer_.getTrack(track).type == kKick)
+                std::fill(instance.trackBuffers_[track], instance.trackBuffers_[track] + numSamples, 0.0f);
+        }
+    }
+
+    KickVoiceBank& bank = kickBanks_[shard];
+    int position = 0;
+    while (position < numSamples)
+    {
+        // Start the hits due here; the segment runs to the next hit of any
+        // instance. Extra splits leave a voice's output unchanged.
+        int next = numSamples;
+        for (int i = first; i < last; ++i)
+        {
+            LockstepState& state = lockstepStates_[i];
+            if (!state.kickKernel) continue;
+
+            DrumMachinePureDSP& instance = instances_[i];
+            auto& pool = instance.sequencer_.getVoicePool<kKick>();
+            for (; state.nextHit < instance.numBlockHits_; ++state.nextHit)
+            {
+                const BlockHit& hit = instance.blockHits_[state.nextHit];
+                if (instance.sequencer_.getTrack(hit.trackIndex).type != kKick) continue;
+                if (hit.sampleOffset > position)
+                {
+                    next = std::min(next, hit.sampleOffset);
+                    break;
+                }
+                pool.trigger(hit.trackIndex, hit.velocity);
+            }
+        }
+
+        for (int i = first; i < last; ++i)
+        {
+            if (!lockstepStates_[i].kickKernel) continue;
+
+            DrumMachinePureDSP& instance = instances_[i];
+            instance.sequencer_.getVoicePool<kKick>().forEachActiveVoice([&](KickVoice& voice, int track)
+            {
+                if (voice.isActive() && instance.sequencer_.getTrack(track).type == kKick)
+                    bank.add(voice, instance.trackBuffers_[track] + position);
+            });
+        }
+        bank.render(next - position);
+
+        for (int i = first; i < last; ++i)
+        {
+            if (lockstepStates_[i].kickKernel)
+                instances_[i].sequencer_.getVoicePool<kKick>().releaseFinishedVoices();
+        }
+        position = next;
+    }
+
+    for (int i = first; i < last; ++i)
+    {
+        if (lockstepStates_[i].kickKernel)
+            instances_[i].mixVoiceGroup(kKickGroup, 0);
+    }
+}
+
+void DrumMachineBatch::setParameter(DrumParam param, const float* values)
+{
+    for (int i = 0; i < numInstances_; ++i)
+        instances_[i].setParameter(param, values[i]);
+}
+
+} // namespace DSP
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    DrumMachineOffline.cpp
+    Offline (faster-than-realtime) bounce of patterns and pattern chains
+    to a caller-supplied sink, as a stereo mix or per-track stems
+
+  ==============================================================================
+*/
+
+#include "dsp/DrumMachinePureDSP.h"
+
+namespace DSP {
+
+//==============================================================================
+// DrumMachinePureDSP Offline Rendering
+//==============================================================================
+
+bool DrumMachinePureDSP::renderOffline(const OfflineRenderSettings& settings, OfflineRenderSink& sink)
+{
+    if (settings.sampleRate <= 0.0 || settings.blockSize <= 0)
+        return false;
+
+    const OfflineChainSlot currentPattern{ nullptr, settings.numBars };
+    const OfflineChainSlot* chain = settings.chain;
+    int chainLength = settings.chainLength;
+    if (chain == nullptr || chainLength <= 0)
+    {
+        chain = &currentPattern;
+        chainLength = 1;
+    }
+
+    const bool stems = settings.output == OfflineRenderOutput::TrackStems;
+    const int numChannels = stems ? 32 : 2;
+    const int blockSize = settings.blockSize;
+
+    // Buffers live for this call only; the render itself does not allocate
+    std::vector<float> planar(static_cast<size_t>(numChannels) * blockSize);
+    std::vector<float> interleaved(settings.interleaved ? planar.size() : 0);
+    float* channels[32];
+    for (int ch = 0; ch < numChannels; ++ch)
+        channels[ch] = planar.data() + static_cast<size_t>(ch) * blockSize;
+
+    const int previousThreads = getRenderThreads();
+    setRenderThreads(settings.renderThreads);
+    prepare(settings.sampleRate, blockSize);
+    reset();
+    sequencer_.setPlaying(true);
+
+    if (chain[0].pattern != nullptr)
+    {
+        for (int track = 0; track < 16; ++track)
+            sequencer_.setTrack(track, (*chain[0].pattern)[track]);
+        markDirty(PRESET_PATTERN);
+    }
+
+    // Stereo mix goes straight into the planar buffers; stems still need a
+    // (discarded) mix target for renderTracks()
+    std::vector<float> discardMix(stems ? static_cast<size_t>(2) * blockSize : 0);
+    float* stemMix[2] = { discardMix.data(), discardMix.data() + (stems ? blockSize : 0) };
+
+    auto renderBlock = [&](int numSamples) -> bool
+    {
+        {
+            RealtimeNoAllocScope noAlloc;
+            const int64_t blockStart = RenderProfiler::now();
+            if (stems)
+                renderTracks(stemMix, 2, numSamples, channels);
+            else
+                renderTracks(channels, 2, numSamples);
+            profiler_.endBlock(blockStart, numSamples, settings.sampleRate, sequencer_);
+        }
+
+        if (!settings.interleaved)
+            return sink.write(channels, numChannels, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            for (int ch = 0; ch < numChannels; ++ch)
+                interleaved[static_cast<size_t>(i) * numChannels + ch] = channels[ch][i];
+
+        const float* frames[1] = { interleaved.data() };
+        return sink.write(frames, numChannels, numSamples);
+    };
+
+    // Render [position, end) in sink-sized blocks
+    int64_t position = 0;
+    auto renderUntil = [&](int64_t end) -> bool
+    {
+        while (position < end)
+        {
+            const int numSamples = static_cast<int>(std::min<int64_t>(blockSize, end - position));
+            if (!renderBlock(numSamples))
+                return false;
+            position += numSamples;
+        }
+        return true;
+    };
+
+    // A bar is one pattern cycle. The next slot is queued half a step before
+    // the sequencer resolves its first downbeat (it works the lookahead
+    // ahead): after this slot's last step 0 was resolved.
+    const double samplesPerStep = sequencer_.getSamplesPerStep();
+    const double samplesPerBar = samplesPerStep * sequencer_.getPatternLength();
+    const double queueLead = (sequencer_.getLookaheadSteps() + 0.5) * samplesPerStep;
+
+    bool completed = true;
+    double slotEnd = 0.0;
+    for (int slot = 0; slot < chainLength && completed; ++slot)
+    {
+        slotEnd += samplesPerBar * std::max(0, chain[slot].numBars);
+
+        if (slot + 1 < chainLength && chain[slot + 1].pattern != nullptr)
+        {
+            const int64_t queueAt = std::max<int64_t>(position, std::llround(slotEnd - queueLead));
+            completed = renderUntil(queueAt);
+            sequencer_.queuePattern(*chain[slot + 1].pattern);
+            markDirty(PRESET_PATTERN);
+        }
+
+        completed = completed && renderUntil(std::llround(slotEnd));
+    }
+
+    // Let the last hits ring out, without starting new steps
+    if (completed && settings.maxTailSeconds > 0.0)
+    {
+        sequencer_.setPlaying(false);
+        const int64_t tailEnd = position + std::llround(settings.maxTailSeconds * settings.sampleRate);
+        while (completed && position < tailEnd && sequencer_.hasActiveVoices())
+            completed = renderUntil(std::min<int64_t>(tailEnd, position + blockSize));
+    }
+
+    sequencer_.setPlaying(true);
+    setRenderThreads(previousThreads);
+    return completed;
+}
+
+} // namespace DSP
@@ -13,21 +13,186 @@
 
 #include "dsp/DrumMachinePureDSP.h"
 #include "../../../../include/dsp/InstrumentFactory.h"
-#include "../../../../include/dsp/LookupTables.h"
-#include "../../../../include/dsp/DSPLogging.h"
+#include <cstdarg>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
+#include <cassert>
+#include <new>
+#include <limits>
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace DSP {
+
+// Flam grace note leads the main hit by this much
+static constexpr double kFlamGraceSeconds = 0.015;
+
+//==============================================================================
+// RandomStream
+//==============================================================================
+
+void RandomStream::fillSigned(uint32_t key, uint32_t& counter, float* out, int numValues)
+{
+    // Four lanes hash their own counters: nothing is carried between
+    // samples, so the loop vectorizes (SSE2/NEON)
+    uint32_t lanes[4];
+    for (int k = 0; k < 4; ++k)
+        lanes[k] = key + (counter + static_cast<uint32_t>(k)) * kWeyl;
+
+    int i = 0;
+    for (; i + 4 <= numValues; i += 4)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            out[i + k] = toSigned(mix(lanes[k]));
+            lanes[k] += 4u * kWeyl;
+        }
+    }
+
+    for (int k = 0; i + k < numValues; ++k)
+        out[i + k] = toSigned(mix(lanes[k]));
+
+    counter += static_cast<uint32_t>(numValues);
+}
+
+//==============================================================================
+// Lookup Tables
+//==============================================================================
+
+DrumLookupTables::DrumLookupTables()
+{
+    for (int i = 0; i <= kSineSize; ++i)
+        sine[i] = static_cast<float>(std::sin(2.0 * M_PI * i / kSineSize));
+
+    for (int i = 0; i < kPanSize; ++i)
+    {
+        double angle = static_cast<double>(i) / (kPanSize - 1) * M_PI * 0.5;
+        panLeft[i] = static_cast<float>(std::cos(angle));
+        panRight[i] = static_cast<float>(std::sin(angle));
+    }
+}
+
+const DrumLookupTables& DrumLookupTables::get()
+{
+    static const DrumLookupTables tables;
+    return tables;
+}
+
+static void constantPowerPan(float pan, float& left, float& right)
+{
+    const DrumLookupTables& tables = DrumLookupTables::get();
+    float position = (std::max(-1.0f, std::min(1.0f, pan)) + 1.0f) * 0.5f * (DrumLookupTables::kPanSize - 1);
+    int index = std::min(static_cast<int>(position), DrumLookupTables::kPanSize - 2);
+    float frac = position - index;
+    left = tables.panLeft[index] + (tables.panLeft[index + 1] - tables.panLeft[index]) * frac;
+    right = tables.panRight[index] + (tables.panRight[index + 1] - tables.panRight[index]) * frac;
+}
+
+// OutputBusLayout::Groups bus per Track::DrumType
+static constexpr uint8_t kGroupOutputBus[15] = {
+    0,           // Kick
+    1,           // Snare
+    2, 2,        // HiHatClosed, HiHatOpen
+    1,           // Clap
+    3, 3, 3,     // TomLow, TomMid, TomHigh
+    4, 4,        // Crash, Ride
+    5,           // Cowbell
+    2, 2,        // Shaker, Tambourine
+    5,           // Percussion
+    1            // Special
+};
+
+// out += in * gain, with the gain ramping by step per sample. The ramp is
+// evaluated per index so the loop has no carried dependency.
+static void mixRamped(const float* input, float* output, int numSamples, float gain, float step)
+{
+    for (int i = 0; i < numSamples; ++i)
+        output[i] += input[i] * (gain + step * static_cast<float>(i));
+}
+
+//==============================================================================
+// Realtime Allocation Guard
+//==============================================================================
+
+#if DRUMMACHINE_ASSERT_NO_ALLOC
+// Depth of render calls on this thread; the replaced operator new below
+// asserts when it is non-zero
+static thread_local int realtimeScopeDepth = 0;
+
+RealtimeNoAllocScope::RealtimeNoAllocScope() { ++realtimeScopeDepth; }
+RealtimeNoAllocScope::~RealtimeNoAllocScope() { --realtimeScopeDepth; }
+bool RealtimeNoAllocScope::isActive() { return realtimeScopeDepth > 0; }
+#endif
+
+} // namespace DSP
+
+#if DRUMMACHINE_ASSERT_NO_ALLOC
+void* operator new(std::size_t size)
+{
+    assert(!DSP::RealtimeNoAllocScope::isActive() && "heap allocation on the audio thread");
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
 
 namespace DSP {
 
+//==============================================================================
+// Voice Control Rate
+//==============================================================================
+
+// Per-sample coefficient authored at kVoiceReferenceRate, at rateScale =
+// kVoiceReferenceRate / sampleRate
+static float atRate(float coefficient, float rateScale)
+{
+    return static_cast<float>(std::pow(static_cast<double>(coefficient), static_cast<double>(rateScale)));
+}
+
+// Wraps an oscillator phase into [0, 1); increments may exceed one cycle
+static inline float wrapPhase(float phase)
+{
+    return phase - static_cast<float>(static_cast<int>(phase));
+}
+
+void ControlSmoother::setup(float newPole, float newDecay)
+{
+    // The modes coincide at decay == pole; keep them apart
+    if (std::abs(newDecay - newPole) < 1.0e-4f)
+        newDecay = newPole - 1.0e-4f;
+
+    pole = newPole;
+    decay = newDecay;
+    decayN = static_cast<float>(std::pow(static_cast<double>(decay), static_cast<double>(kVoiceControlBlock)));
+    coupling = (1.0f - pole) / (decay - pole);
+}
+
 //==============================================================================
 // Kick Voice Implementation - Enhanced
 //==============================================================================
 
-void KickVoice::prepare(double sampleRate)
+void KickVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+    invSampleRate = static_cast<float>(1.0 / sampleRate);
+    transientStep = 0.08f * rateScale;
+    pitchTailDecay = atRate(0.992f, rateScale);
+    pitchPole = atRate(0.95f, rateScale);
+    amplitudePole = atRate(0.9f, rateScale);
     reset();
 }
 
@@ -38,8 +203,9 @@ void KickVoice::reset()
     pitchEnvelope = 0.0f;
     amplitude = 0.0f;
     transientPhase = 0.0f;
-    pitchSmoothing = 0.0f;
-    amplitudeSmoothing = 0.0f;
+    pitchSmoother.reset(-frequency);
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
 void KickVoice::trigger(float velocity)
@@ -47,62 +213,93 @@ void KickVoice::trigger(float velocity)
     // Enhanced amplitude envelope with faster attack
     amplitude = velocity * 3.2f;  // Boosted 4x for normalization (was 0.8)
     decay = 0.996f - (0.996f - 0.992f) * (1.0f - velocity) * 0.5f;
+    amplitudeSmoother.setup(amplitudePole, atRate(decay, rateScale));
 
     // Enhanced pitch envelope with exponential decay (more realistic beater impact)
     pitchEnvelope = 1.0f;
     pitchAmount = frequency * 3.5f;  // Increased pitch sweep range
     pitchDecay = 0.985f;  // Faster initial pitch drop
+    pitchTail = false;
+    pitchSmoother.setup(pitchPole, atRate(pitchDecay, rateScale));
 
     // Enhanced transient with sharper attack
     transientPhase = 1.0f;
     transientAmount = 0.45f * velocity;  // More click presence
 
-    // Initialize smoothing
-    pitchSmoothing = 0.0f;
-    amplitudeSmoothing = 0.0f;
+    // Initialize smoothing (pitch from 0 Hz)
+    pitchSmoother.reset(-frequency);
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
-float KickVoice::processSample()
+void KickVoice::updateControl()
 {
-    // Enhanced pitch envelope with two-stage decay (fast then slow)
-    float currentFreq = frequency + pitchEnvelope * pitchAmount;
+    // Two-stage pitch decay for realistic drum beater (fast then slow)
+    if (!pitchTail && pitchEnvelope <= 0.3f)
+    {
+        pitchTail = true;
+        pitchSmoother.setup(pitchPole, pitchTailDecay);
+    }
+    pitchSmoother.begin(pitchEnvelope * pitchAmount);
+    pitchEnvelope *= pitchSmoother.decayN;
 
-    // Two-stage pitch decay for realistic drum beater
-    if (pitchEnvelope > 0.3f)
-        pitchEnvelope *= pitchDecay;  // Fast initial drop
-    else
-        pitchEnvelope *= 0.992f;  // Slower tail decay
+    amplitudeSmoother.begin(amplitude);
+    amplitude *= amplitudeSmoother.decayN;
+    if (amplitude < 0.0001f) amplitude = 0.0f;
 
-    // Apply parameter smoothing (prevent zipper noise)
-    pitchSmoothing = pitchSmoothing * 0.95f + currentFreq * 0.05f;
+    controlCountdown = kVoiceControlBlock;
+}
+
+float KickVoice::processSample()
+{
+    float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
 
-    // Generate sine wave with sub-octave content for body
-    phase += static_cast<float>(pitchSmoothing / sampleRate);
-    if (phase > 1.0f) phase -= 1.0f;
+void KickVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
 
-    float tone = SchillingerEcosystem::DSP::fastSineLookup(phase * 2.0f * M_PI);
-    float subOctave = SchillingerEcosystem::DSP::fastSineLookup(phase * M_PI) * 0.3f;  // Add sub-bass
-    tone = tone * 0.7f + subOctave;  // Mix for fuller sound
+    const DrumLookupTables& tables = DrumLookupTables::get();
 
-    // Enhanced transient with band-limited click
-    float transient = 0.0f;
-    if (transientPhase > 0.0f)
+    for (int start = 0; start < numSamples;)
     {
-        // Sharper transient curve
-        float transientCurve = transientPhase * transientPhase;  // Quadratic decay
-        transient = std::sin(transientCurve * M_PI * 0.5f) * transientAmount;
-        transientPhase -= 0.08f;  // Slightly longer transient
-        if (transientPhase < 0.0f) transientPhase = 0.0f;
-    }
+        if (controlCountdown == 0)
+        {
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
+        }
+
+        const int n = std::min(controlCountdown, numSamples - start);
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            phase += (frequency + pitchSmoother.next()) * invSampleRate;
+            if (phase > 1.0f) phase -= 1.0f;
 
-    // Smoothed amplitude envelope
-    float targetAmplitude = amplitude;
-    amplitudeSmoothing = amplitudeSmoothing * 0.9f + targetAmplitude * 0.1f;
+            // Generate sine wave with sub-octave content for body
+            float tone = tables.sineCycles(phase);
+            float subOctave = tables.sineCycles(phase * 0.5f) * 0.3f;
+            tone = tone * 0.7f + subOctave;
 
-    amplitude *= decay;
-    if (amplitude < 0.0001f) amplitude = 0.0f;
+            // Enhanced transient with band-limited click
+            float transient = 0.0f;
+            if (transientPhase > 0.0f)
+            {
+                float transientCurve = transientPhase * transientPhase;  // Quadratic decay
+                transient = tables.sineCycles(transientCurve * 0.25f) * transientAmount;
+                transientPhase -= transientStep;
+                if (transientPhase < 0.0f) transientPhase = 0.0f;
+            }
 
-    return (tone + transient) * amplitudeSmoothing;
+            out[i] += (tone + transient) * amplitudeSmoother.next();
+        }
+
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void KickVoice::setPitch(float pitch)
@@ -115,6 +312,8 @@ void KickVoice::setPitch(float pitch)
 void KickVoice::setDecay(float decay)
 {
     pitchDecay = 0.985f + decay * 0.012f;  // Expanded range
+    if (!pitchTail)
+        pitchSmoother.setup(pitchPole, atRate(pitchDecay, rateScale));
 }
 
 void KickVoice::setClick(float click)
@@ -123,26 +322,276 @@ void KickVoice::setClick(float click)
     transientAmount = transientAmount * 0.9f + click * 0.1f;
 }
 
+//==============================================================================
+// Kick Voice Bank
+//==============================================================================
+
+void KickVoiceBank::allocate(int maxLanes)
+{
+    maxLanes = std::max(0, maxLanes);
+    groups_.assign(static_cast<size_t>((maxLanes + kGroupLanes - 1) / kGroupLanes), LaneGroup{});
+    voices_.assign(static_cast<size_t>(maxLanes), nullptr);
+    outputs_.assign(static_cast<size_t>(maxLanes), nullptr);
+    controlCountdown_.assign(static_cast<size_t>(maxLanes), 0);
+    numLanes_ = 0;
+}
+
+bool KickVoiceBank::add(KickVoice& voice, float* output)
+{
+    if (numLanes_ >= static_cast<int>(voices_.size())) return false;
+
+    voices_[numLanes_] = &voice;
+    outputs_[numLanes_] = output;
+    load(numLanes_);
+    ++numLanes_;
+    return true;
+}
+
+void KickVoiceBank::load(int lane)
+{
+    const KickVoice& voice = *voices_[lane];
+    LaneGroup& group = groups_[lane / kGroupLanes];
+    const int k = lane % kGroupLanes;
+
+    group.phase[k] = voice.phase;
+    group.frequency[k] = voice.frequency;
+    group.invSampleRate[k] = voice.invSampleRate;
+    group.pitchPole[k] = voice.pitchSmoother.pole;
+    group.pitchDecay[k] = voice.pitchSmoother.decay;
+    group.pitchTransient[k] = voice.pitchSmoother.transient;
+    group.pitchSteady[k] = voice.pitchSmoother.steady;
+    group.amplitudePole[k] = voice.amplitudeSmoother.pole;
+    group.amplitudeDecay[k] = voice.amplitudeSmoother.decay;
+    group.amplitudeTransient[k] = voice.amplitudeSmoother.transient;
+    group.amplitudeSteady[k] = voice.amplitudeSmoother.steady;
+    group.transientPhase[k] = voice.transientPhase;
+    group.transientAmount[k] = voice.transientAmount;
+    group.transientStep[k] = voice.transientStep;
+    controlCountdown_[lane] = voice.controlCountdown;
+}
+
+void KickVoiceBank::store(int lane)
+{
+    KickVoice& voice = *voices_[lane];
+    const LaneGroup& group = groups_[lane / kGroupLanes];
+    const int k = lane % kGroupLanes;
+
+    // Only the per-sample state moves; coefficients belong to the voice
+    voice.phase = group.phase[k];
+    voice.pitchSmoother.transient = group.pitchTransient[k];
+    voice.pitchSmoother.steady = group.pitchSteady[k];
+    voice.amplitudeSmoother.transient = group.amplitudeTransient[k];
+    voice.amplitudeSmoother.steady = group.amplitudeSteady[k];
+    voice.transientPhase = group.transientPhase[k];
+    voice.controlCountdown = controlCountdown_[lane];
+}
+
+void KickVoiceBank::clearLane(int lane)
+{
+    // Silent and decayed, so unused lanes run without denormals
+    LaneGroup& group = groups_[lane / kGroupLanes];
+    const int k = lane % kGroupLanes;
+    group.pitchTransient[k] = group.pitchSteady[k] = 0.0f;
+    group.amplitudeTransient[k] = group.amplitudeSteady[k] = 0.0f;
+    group.transientPhase[k] = 0.0f;
+}
+
+#if defined(__SSE2__) || defined(_M_X64)
+// DrumLookupTables::sineCycles() on four values; only the table reads are
+// per lane
+static inline __m128 sineCycles4(const DrumLookupTables& tables, __m128 cycles)
+{
+    const __m128 position = _mm_mul_ps(cycles, _mm_set1_ps(static_cast<float>(DrumLookupTables::kSineSize)));
+    __m128i index = _mm_cvttps_epi32(position);
+    index = _mm_add_epi32(index, _mm_castps_si128(_mm_cmplt_ps(position, _mm_cvtepi32_ps(index))));  // Floor
+    const __m128 frac = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+    index = _mm_and_si128(index, _mm_set1_epi32(DrumLookupTables::kSineSize - 1));
+
+    int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), index);
+    const __m128 low = _mm_setr_ps(tables.sine[lanes[0]], tables.sine[lanes[1]], tables.sine[lanes[2]], tables.sine[lanes[3]]);
+    const __m128 high = _mm_setr_ps(tables.sine[lanes[0] + 1], tables.sine[lanes[1] + 1], tables.sine[lanes[2] + 1], tables.sine[lanes[3] + 1]);
+    return _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), frac));
+}
+#endif
+
+void KickVoiceBank::renderGroup(int groupIndex, int start, int numSamples)
+{
+    // KickVoice::processBlock() for four lanes with the voice's rounding.
+    // numSamples stays within every lane's control block, so the envelope
+    // and oscillator state stays in registers across the run. As selects,
+    // the phase wraps by subtracting 1 or 0 and a finished transient (phase
+    // 0, it never goes below) gets a zero weight.
+    LaneGroup& group = groups_[groupIndex];
+    const DrumLookupTables& tables = DrumLookupTables::get();
+    float samples[kVoiceControlBlock * kGroupLanes];  // [sample * kGroupLanes + lane]
+
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 frequency = _mm_loadu_ps(group.frequency);
+    const __m128 invSampleRate = _mm_loadu_ps(group.invSampleRate);
+    const __m128 pitchPole = _mm_loadu_ps(group.pitchPole);
+    const __m128 pitchDecay = _mm_loadu_ps(group.pitchDecay);
+    const __m128 amplitudePole = _mm_loadu_ps(group.amplitudePole);
+    const __m128 amplitudeDecay = _mm_loadu_ps(group.amplitudeDecay);
+    const __m128 transientAmount = _mm_loadu_ps(group.transientAmount);
+    const __m128 transientStep = _mm_loadu_ps(group.transientStep);
+    __m128 phase = _mm_loadu_ps(group.phase);
+    __m128 pitchTransient = _mm_loadu_ps(group.pitchTransient);
+    __m128 pitchSteady = _mm_loadu_ps(group.pitchSteady);
+    __m128 amplitudeTransient = _mm_loadu_ps(group.amplitudeTransient);
+    __m128 amplitudeSteady = _mm_loadu_ps(group.amplitudeSteady);
+    __m128 transientPhase = _mm_loadu_ps(group.transientPhase);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        pitchTransient = _mm_mul_ps(pitchTransient, pitchPole);
+        pitchSteady = _mm_mul_ps(pitchSteady, pitchDecay);
+        phase = _mm_add_ps(phase, _mm_mul_ps(_mm_add_ps(frequency, _mm_add_ps(pitchTransient, pitchSteady)), invSampleRate));
+        phase = _mm_sub_ps(phase, _mm_and_ps(_mm_cmpgt_ps(phase, one), one));
+
+        __m128 tone = sineCycles4(tables, phase);
+        const __m128 subOctave = _mm_mul_ps(sineCycles4(tables, _mm_mul_ps(phase, _mm_set1_ps(0.5f))), _mm_set1_ps(0.3f));
+        tone = _mm_add_ps(_mm_mul_ps(tone, _mm_set1_ps(0.7f)), subOctave);
+
+        const __m128 curve = _mm_mul_ps(transientPhase, transientPhase);
+        const __m128 click = _mm_and_ps(_mm_cmpgt_ps(transientPhase, zero), transientAmount);
+        const __m128 transient = _mm_mul_ps(sineCycles4(tables, _mm_mul_ps(curve, _mm_set1_ps(0.25f))), click);
+        transientPhase = _mm_max_ps(_mm_sub_ps(transientPhase, transientStep), zero);
+
+        amplitudeTransient = _mm_mul_ps(amplitudeTransient, amplitudePole);
+        amplitudeSteady = _mm_mul_ps(amplitudeSteady, amplitudeDecay);
+        const __m128 gain = _mm_add_ps(amplitudeTransient, amplitudeSteady);
+        _mm_storeu_ps(samples + i * kGroupLanes, _mm_mul_ps(_mm_add_ps(tone, transient), gain));
+    }
+
+    _mm_storeu_ps(group.phase, phase);
+    _mm_storeu_ps(group.pitchTransient, pitchTransient);
+    _mm_storeu_ps(group.pitchSteady, pitchSteady);
+    _mm_storeu_ps(group.amplitudeTransient, amplitudeTransient);
+    _mm_storeu_ps(group.amplitudeSteady, amplitudeSteady);
+    _mm_storeu_ps(group.transientPhase, transientPhase);
+#else
+    for (int k = 0; k < kGroupLanes; ++k)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            group.pitchTransient[k] *= group.pitchPole[k];
+            group.pitchSteady[k] *= group.pitchDecay[k];
+            const float phase = group.phase[k] + (group.frequency[k] + (group.pitchTransient[k] + group.pitchSteady[k])) * group.invSampleRate[k];
+            group.phase[k] = phase > 1.0f ? phase - 1.0f : phase;
+
+            float tone = tables.sineCycles(group.phase[k]);
+            float subOctave = tables.sineCycles(group.phase[k] * 0.5f) * 0.3f;
+            tone = tone * 0.7f + subOctave;
+
+            const float transientPhase = group.transientPhase[k];
+            const float click = transientPhase > 0.0f ? group.transientAmount[k] : 0.0f;
+            const float transient = tables.sineCycles(transientPhase * transientPhase * 0.25f) * click;
+            group.transientPhase[k] = std::max(transientPhase - group.transientStep[k], 0.0f);
+
+            group.amplitudeTransient[k] *= group.amplitudePole[k];
+            group.amplitudeSteady[k] *= group.amplitudeDecay[k];
+            samples[i * kGroupLanes + k] = (tone + transient) * (group.amplitudeTransient[k] + group.amplitudeSteady[k]);
+        }
+    }
+#endif
+
+    for (int k = 0; k < kGroupLanes; ++k)
+    {
+        const int lane = groupIndex * kGroupLanes + k;
+        if (lane >= numLanes_ || voices_[lane] == nullptr) continue;
+
+        float* out = outputs_[lane] + start;
+        for (int i = 0; i < numSamples; ++i)
+            out[i] += samples[i * kGroupLanes + k];
+    }
+}
+
+void KickVoiceBank::render(int numSamples)
+{
+    const int numGroups = (numLanes_ + kGroupLanes - 1) / kGroupLanes;
+    for (int lane = numLanes_; lane < numGroups * kGroupLanes; ++lane)
+        clearLane(lane);
+
+    for (int start = 0; start < numSamples;)
+    {
+        // Lanes whose control block ends here hand it to their voice; the
+        // bank then runs up to the next lane's block end
+        int n = numSamples - start;
+        bool playing = false;
+        for (int lane = 0; lane < numLanes_; ++lane)
+        {
+            KickVoice* voice = voices_[lane];
+            if (voice == nullptr) continue;
+
+            if (controlCountdown_[lane] == 0)
+            {
+                store(lane);
+                voice->updateControl();
+                if (!voice->isActive())
+                {
+                    // Asleep: the voice holds its final state
+                    voices_[lane] = nullptr;
+                    clearLane(lane);
+                    continue;
+                }
+                load(lane);
+            }
+            n = std::min(n, controlCountdown_[lane]);
+            playing = true;
+        }
+        if (!playing) break;
+
+        // Groups in lane order, lanes in order within a group: each output
+        // sums its lanes in the order they were added
+        for (int g = 0; g < numGroups; ++g)
+            renderGroup(g, start, n);
+
+        for (int lane = 0; lane < numLanes_; ++lane)
+            controlCountdown_[lane] -= n;
+        start += n;
+    }
+
+    for (int lane = 0; lane < numLanes_; ++lane)
+    {
+        if (voices_[lane] != nullptr)
+            store(lane);
+    }
+    numLanes_ = 0;
+}
+
 //==============================================================================
 // Snare Voice Implementation - Enhanced
 //==============================================================================
 
-void SnareVoice::prepare(double sampleRate)
+void SnareVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+    toneIncrement = static_cast<float>(toneFreq / sampleRate);
+    snapDecay = atRate(0.92f, rateScale);
+    rattleDecay = atRate(0.994f, rateScale);
+    tonePole = atRate(0.9f, rateScale);
+    filterSmoother.setup(atRate(0.98f, rateScale), 1.0f);
+    setNoiseDecay(noiseDecay);
     reset();
 }
 
 void SnareVoice::reset()
 {
+    noiseCounter = 0;  // Same noise after every reset
     tonePhase = 0.0f;
     toneAmplitude = 0.0f;
     noiseAmplitude = 0.0f;
+    noiseGain = 0.0f;
     filterState = 0.0f;
     snapAmplitude = 0.0f;
     rattlePhase = 0.0f;
-    filterSmoothing = 0.0f;
-    toneSmoothing = 0.0f;
+    filterSmoother.reset();
+    toneSmoother.reset();
+    controlCountdown = 0;
 }
 
 void SnareVoice::trigger(float velocity)
@@ -150,74 +599,124 @@ void SnareVoice::trigger(float velocity)
     // Enhanced tone with richer harmonics
     toneAmplitude = 2.8f * velocity;  // Boosted 4x for normalization (was 0.7)
     toneDecay = 0.992f - (0.992f - 0.988f) * (1.0f - velocity) * 0.5f;
+    toneSmoother.setup(tonePole, atRate(toneDecay, rateScale));
 
     // Enhanced noise with more body
     noiseAmplitude = 3.4f * velocity;  // Boosted 4x for normalization (was 0.85)
-    noiseDecay = 0.996f - (0.996f - 0.992f) * (1.0f - velocity) * 0.5f;
+    setNoiseDecay(0.996f - (0.996f - 0.992f) * (1.0f - velocity) * 0.5f);
 
     // Enhanced snap with sharper attack
     snapAmplitude = 2.4f * velocity;  // Boosted 4x for normalization (was 0.6)
-    snapDecay = 0.92f;
 
     // Initialize snare rattle (snares buzzing against bottom head)
     rattlePhase = 1.0f;
 
     filterState = 0.0f;
-    filterSmoothing = filterResonance;
-    toneSmoothing = 0.0f;
+    filterSmoother.reset(filterResonance);
+    toneSmoother.reset();
+    controlCountdown = 0;
 }
 
-float SnareVoice::processSample()
+void SnareVoice::setNoiseDecay(float newDecay)
 {
-    // Generate enhanced tone with multiple harmonics (triangle + sawtooth mix)
-    tonePhase += static_cast<float>(toneFreq / sampleRate);
-    if (tonePhase > 1.0f) tonePhase -= 1.0f;
+    noiseDecay = newDecay;
+    noiseDecayRate = atRate(noiseDecay, rateScale);
+    noiseDecayN = atRate(noiseDecay, rateScale * kVoiceControlBlock);
+}
 
-    float triangle = (tonePhase < 0.5f) ? (tonePhase * 4.0f - 1.0f) : (3.0f - tonePhase * 4.0f);
-    float square = (tonePhase < 0.5f) ? 0.7f : -0.7f;  // Softer square
-    float tone = triangle * 0.6f + square * 0.2f;  // Mix for richer tone
+void SnareVoice::updateControl()
+{
+    // The tone smoother sees the amplitude after each sample's decay
+    toneSmoother.begin(toneAmplitude * toneSmoother.decay);
+    toneAmplitude *= toneSmoother.decayN;
 
-    toneAmplitude *= toneDecay;
+    noiseGain = noiseAmplitude;
+    noiseAmplitude *= noiseDecayN;
 
-    // Generate noise (deterministic LCG with per-instance seed)
-    noiseSeed = noiseSeed * 1103515245 + 12345;
-    float noise = static_cast<float>((noiseSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff) * 2.0f - 1.0f;
+    // Enhanced filter with resonance, smoothed towards its target
+    filterSmoother.begin(1.0f - filterResonance);
 
-    // Enhanced snare rattle (high-frequency buzz)
-    float rattle = 0.0f;
-    if (rattlePhase > 0.0f)
-    {
-        noiseSeed = noiseSeed * 1103515245 + 12345;
-        float rattleNoise = static_cast<float>((noiseSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff) * 2.0f - 1.0f;
-        rattle = rattleNoise * rattlePhase * 0.3f;
-        rattlePhase *= 0.994f;  // Fast decay for rattle
-        if (rattlePhase < 0.01f) rattlePhase = 0.0f;
-    }
+    // While the rattle runs it interleaves its own draws from the generator
+    if (rattlePhase < 0.01f) rattlePhase = 0.0f;
+    rattling = rattlePhase > 0.0f;
 
-    // Enhanced filter with resonance (bandpass for snare body)
-    float targetCoeff = 1.0f - filterResonance;
-    filterSmoothing = filterSmoothing * 0.98f + targetCoeff * 0.02f;  // Smooth filter changes
+    controlCountdown = kVoiceControlBlock;
+}
 
-    // Two-pole filter for better frequency response
-    float filterInput = noise + rattle;
-    filterState = filterState * filterSmoothing + filterInput * (1.0f - filterSmoothing);
+float SnareVoice::processSample()
+{
+    float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
 
-    // Add high-frequency content for snare wires
-    float highFreq = (filterInput - filterState) * 0.4f;
+void SnareVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
 
-    noiseAmplitude *= noiseDecay;
+    const DrumLookupTables& tables = DrumLookupTables::get();
 
-    // Enhanced snap with more impact
-    float snap = std::sin(snapAmplitude * 12.0f) * snapAmplitude * 1.2f;
-    snapAmplitude *= snapDecay;
+    // Noise and rattle draws interleave while the rattle runs
+    float noiseBuf[2 * kVoiceControlBlock];
 
-    // Smooth tone amplitude
-    toneSmoothing = toneSmoothing * 0.9f + toneAmplitude * 0.1f;
+    for (int start = 0; start < numSamples;)
+    {
+        if (controlCountdown == 0)
+        {
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
+        }
 
-    // Mix components with better balance
-    float output = tone * toneSmoothing + filterState * noiseAmplitude + highFreq * noiseAmplitude * 0.5f + snap;
+        const int n = std::min(controlCountdown, numSamples - start);
+        RandomStream::fillSigned(kNoiseKey, noiseCounter, noiseBuf, rattling ? 2 * n : n);
 
-    return output;
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            // Enhanced tone with multiple harmonics (triangle + square mix)
+            tonePhase += toneIncrement;
+            if (tonePhase > 1.0f) tonePhase -= 1.0f;
+
+            float triangle = (tonePhase < 0.5f) ? (tonePhase * 4.0f - 1.0f) : (3.0f - tonePhase * 4.0f);
+            float square = (tonePhase < 0.5f) ? 0.7f : -0.7f;  // Softer square
+            float tone = triangle * 0.6f + square * 0.2f;
+
+            // Noise plus snare rattle (high-frequency buzz)
+            float noise;
+            float rattle = 0.0f;
+            if (rattling)
+            {
+                noise = noiseBuf[2 * i];
+                rattle = noiseBuf[2 * i + 1] * rattlePhase * 0.3f;
+                rattlePhase *= rattleDecay;
+            }
+            else
+            {
+                noise = noiseBuf[i];
+            }
+
+            // Bandpass for snare body, plus high-frequency content for snare wires
+            const float filterCoeff = filterSmoother.next();
+            float filterInput = noise + rattle;
+            filterState = filterState * filterCoeff + filterInput * (1.0f - filterCoeff);
+            float highFreq = (filterInput - filterState) * 0.4f;
+            noiseGain *= noiseDecayRate;
+
+            // Snap is inaudible below the activity threshold; skip the sin
+            float snap = 0.0f;
+            if (snapAmplitude > 0.0001f)
+            {
+                snap = tables.sineCycles(snapAmplitude * static_cast<float>(12.0 / (2.0 * M_PI))) * snapAmplitude * 1.2f;
+                snapAmplitude *= snapDecay;
+            }
+
+            out[i] += tone * toneSmoother.next() + filterState * noiseGain + highFreq * noiseGain * 0.5f + snap;
+        }
+
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void SnareVoice::setTone(float tone)
@@ -228,7 +727,7 @@ void SnareVoice::setTone(float tone)
 
 void SnareVoice::setDecay(float decay)
 {
-    noiseDecay = 0.992f + decay * 0.008f;  // Expanded range for longer snares
+    setNoiseDecay(0.992f + decay * 0.008f);  // Expanded range for longer snares
 }
 
 void SnareVoice::setSnap(float snap)
@@ -241,28 +740,40 @@ void SnareVoice::setSnap(float snap)
 // Hi-Hat Voice Implementation - Enhanced with Improved Metallic Cymbals
 //==============================================================================
 
-void HiHatVoice::prepare(double sampleRate)
+void HiHatVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+
+    // Very high, inharmonic and even higher metallic partials
+    metalIncrement[0] = 0.7f * rateScale;
+    metalIncrement[1] = 0.53f * rateScale;
+    metalIncrement[2] = 1.1f * rateScale;
+
+    amplitudePole = atRate(0.9f, rateScale);
+    filterSmoother.setup(atRate(0.98f, rateScale), 1.0f);
     reset();
 }
 
 void HiHatVoice::reset()
 {
+    noiseCounter = 0;  // Same noise after every reset
     noisePhase = 0.0f;
     amplitude = 0.0f;
     filterState = 0.0f;
     metalPhase = 0.0f;
     metalPhase2 = 0.0f;
     metalPhase3 = 0.0f;
-    filterSmoothing = 0.0f;
-    amplitudeSmoothing = 0.0f;
+    filterSmoother.reset();
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
 void HiHatVoice::trigger(float velocity)
 {
     amplitude = velocity * 2.8f;  // Boosted 4x for normalization (was 0.7)
     decay = 0.97f - (0.97f - 0.92f) * (1.0f - velocity) * 0.5f;
+    amplitudeSmoother.setup(amplitudePole, atRate(decay, rateScale));
     filterState = 0.0f;
     metalAmount = 0.15f;  // Increased metallic content
 
@@ -271,57 +782,75 @@ void HiHatVoice::trigger(float velocity)
     metalPhase2 = 0.0f;
     metalPhase3 = 0.0f;
 
-    filterSmoothing = filterCoeff;
-    amplitudeSmoothing = 0.0f;
+    filterSmoother.reset(filterCoeff);
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
-float HiHatVoice::processSample()
+void HiHatVoice::updateControl()
 {
-    // Generate high-frequency noise (deterministic LCG with per-instance seed)
-    noiseSeed = noiseSeed * 1103515245 + 12345;
-    float noise = static_cast<float>((noiseSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff) * 2.0f - 1.0f;
-
-    // Enhanced high-pass filter with better frequency response
-    float targetCoeff = filterCoeff;
-    filterSmoothing = filterSmoothing * 0.98f + targetCoeff * 0.02f;
+    filterSmoother.begin(filterCoeff);
 
-    float highpass = noise - filterState;
-    filterState = noise * filterSmoothing;
+    amplitudeSmoother.begin(amplitude);
+    amplitude *= amplitudeSmoother.decayN;
+    if (amplitude < 0.0001f) amplitude = 0.0f;
 
-    // Enhanced metallic overtones with multiple FM oscillators
-    // Primary metallic tone
-    float metal1 = SchillingerEcosystem::DSP::fastSineLookup(metalPhase * 2.0f * M_PI) * metalAmount;
-    metalPhase += 0.7f;  // Very high frequency
-    if (metalPhase > 1.0f) metalPhase -= 1.0f;
+    controlCountdown = kVoiceControlBlock;
+}
 
-    // Secondary metallic overtone (slightly detuned)
-    float metal2 = SchillingerEcosystem::DSP::fastSineLookup(metalPhase2 * 2.0f * M_PI) * metalAmount * 0.6f;
-    metalPhase2 += 0.53f;  // Inharmonic ratio
-    if (metalPhase2 > 1.0f) metalPhase2 -= 1.0f;
+float HiHatVoice::processSample()
+{
+    float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
 
-    // Tertiary metallic overtone (higher frequency)
-    float metal3 = SchillingerEcosystem::DSP::fastSineLookup(metalPhase3 * 2.0f * M_PI) * metalAmount * 0.4f;
-    metalPhase3 += 1.1f;  // Even higher frequency
-    if (metalPhase3 > 1.0f) metalPhase3 -= 1.0f;
+void HiHatVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
 
-    // Mix metallic components for rich cymbal sound
-    float metal = metal1 + metal2 + metal3;
+    const DrumLookupTables& tables = DrumLookupTables::get();
 
-    // Add frequency modulation for shimming effect
-    float fmMod = SchillingerEcosystem::DSP::fastSineLookup(metalPhase * 4.0f * M_PI) * 0.1f;
-    metal += metal * fmMod;
+    float noiseBuf[kVoiceControlBlock];
 
-    // Apply amplitude smoothing (prevent zipper noise)
-    float targetAmplitude = amplitude;
-    amplitudeSmoothing = amplitudeSmoothing * 0.9f + targetAmplitude * 0.1f;
+    for (int start = 0; start < numSamples;)
+    {
+        if (controlCountdown == 0)
+        {
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
+        }
 
-    amplitude *= decay;
-    if (amplitude < 0.0001f) amplitude = 0.0f;
+        const int n = std::min(controlCountdown, numSamples - start);
+        RandomStream::fillSigned(kNoiseKey, noiseCounter, noiseBuf, n);
 
-    // Mix high-pass noise and metallic content
-    float output = (highpass * 0.6f + metal * 0.4f) * amplitudeSmoothing;
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            // High-pass filtered noise
+            float highpass = noiseBuf[i] - filterState;
+            filterState = noiseBuf[i] * filterSmoother.next();
+
+            // Metallic overtones; the shimmer FM reads the advanced phase
+            float metal1 = tables.sineCycles(metalPhase) * metalAmount;
+            float metal2 = tables.sineCycles(metalPhase2) * metalAmount * 0.6f;
+            float metal3 = tables.sineCycles(metalPhase3) * metalAmount * 0.4f;
+            metalPhase = wrapPhase(metalPhase + metalIncrement[0]);
+            metalPhase2 = wrapPhase(metalPhase2 + metalIncrement[1]);
+            metalPhase3 = wrapPhase(metalPhase3 + metalIncrement[2]);
+
+            float metal = metal1 + metal2 + metal3;
+            float fmMod = tables.sineCycles(metalPhase * 2.0f) * 0.1f;
+            metal += metal * fmMod;
+
+            // Mix high-pass noise and metallic content, slightly lower overall level
+            out[i] += (highpass * 0.6f + metal * 0.4f) * amplitudeSmoother.next() * 0.6f;
+        }
 
-    return output * 0.6f;  // Slightly lower overall level
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void HiHatVoice::setTone(float tone)
@@ -333,6 +862,7 @@ void HiHatVoice::setTone(float tone)
 void HiHatVoice::setDecay(float decay)
 {
     this->decay = 0.92f + decay * 0.08f;  // Expanded range for longer decays
+    amplitudeSmoother.setup(amplitudePole, atRate(this->decay, rateScale));
 }
 
 void HiHatVoice::setMetallic(float metallic)
@@ -345,70 +875,105 @@ void HiHatVoice::setMetallic(float metallic)
 // Clap Voice Implementation - Enhanced
 //==============================================================================
 
-void ClapVoice::prepare(double sampleRate)
+void ClapVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+    impulseSpacing = static_cast<int>(std::lround(500.0f / rateScale));
+    impulseStagger = static_cast<int>(std::lround(100.0f / rateScale));
+    amplitudePole = atRate(0.9f, rateScale);
+    filterSmoother.setup(atRate(0.98f, rateScale), 1.0f);
     reset();
 }
 
 void ClapVoice::reset()
 {
+    noiseCounter = 0;  // Same noise after every reset
     amplitude = 0.0f;
     decay = 0.97f;
     currentImpulse = 0;
     impulseCounter = 0;
     filterState = 0.0f;
-    filterSmoothing = 0.0f;
-    amplitudeSmoothing = 0.0f;
+    filterSmoother.reset();
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
 void ClapVoice::trigger(float velocity)
 {
     amplitude = velocity * 3.2f;  // Boosted 4x for normalization (was 0.8)
     decay = 0.975f - (0.975f - 0.945f) * (1.0f - velocity) * 0.5f;
+    amplitudeSmoother.setup(amplitudePole, atRate(decay, rateScale));
     currentImpulse = 0;
     impulseCounter = 0;
     filterState = 0.0f;
-    filterSmoothing = filterCoeff;
-    amplitudeSmoothing = 0.0f;
+    filterSmoother.reset(filterCoeff);
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
+}
+
+void ClapVoice::updateControl()
+{
+    filterSmoother.begin(filterCoeff);
+
+    amplitudeSmoother.begin(amplitude);
+    amplitude *= amplitudeSmoother.decayN;
+    if (amplitude < 0.0001f) amplitude = 0.0f;
+
+    controlCountdown = kVoiceControlBlock;
 }
 
 float ClapVoice::processSample()
 {
     float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
+
+void ClapVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
+
+    float noiseBuf[kVoiceControlBlock];
 
-    // Generate multiple noise bursts with natural timing
-    if (currentImpulse < numImpulses)
+    for (int start = 0; start < numSamples;)
     {
-        if (impulseCounter <= 0)
-        {
-            // Trigger new impulse with slight randomization for natural feel
-            impulseCounter = impulseSpacing + (currentImpulse % 2) * 100;
-            currentImpulse++;
-        }
-        else
+        if (controlCountdown == 0)
         {
-            impulseCounter--;
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
         }
-    }
 
-    // Generate noise (deterministic LCG with per-instance seed)
-    noiseSeed = noiseSeed * 1103515245 + 12345;
-    float noise = static_cast<float>((noiseSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff) * 2.0f - 1.0f;
+        const int n = std::min(controlCountdown, numSamples - start);
+        RandomStream::fillSigned(kNoiseKey, noiseCounter, noiseBuf, n);
 
-    // Enhanced filter with smoothing
-    float targetCoeff = filterCoeff;
-    filterSmoothing = filterSmoothing * 0.98f + targetCoeff * 0.02f;
-    filterState = filterState * filterSmoothing + noise * (1.0f - filterSmoothing);
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            // Multiple noise bursts with natural timing
+            if (currentImpulse < numImpulses)
+            {
+                if (impulseCounter <= 0)
+                {
+                    impulseCounter = impulseSpacing + (currentImpulse % 2) * impulseStagger;
+                    currentImpulse++;
+                }
+                else
+                {
+                    impulseCounter--;
+                }
+            }
 
-    // Apply amplitude smoothing
-    float targetAmplitude = amplitude;
-    amplitudeSmoothing = amplitudeSmoothing * 0.9f + targetAmplitude * 0.1f;
+            const float filterCoeffNow = filterSmoother.next();
+            filterState = filterState * filterCoeffNow + noiseBuf[i] * (1.0f - filterCoeffNow);
 
-    amplitude *= decay;
-    if (amplitude < 0.0001f) amplitude = 0.0f;
+            out[i] += filterState * amplitudeSmoother.next();
+        }
 
-    return filterState * amplitudeSmoothing;
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void ClapVoice::setTone(float tone)
@@ -420,6 +985,7 @@ void ClapVoice::setTone(float tone)
 void ClapVoice::setDecay(float decay)
 {
     this->decay = 0.945f + decay * 0.055f;  // Expanded range
+    amplitudeSmoother.setup(amplitudePole, atRate(this->decay, rateScale));
 }
 
 void ClapVoice::setNumImpulses(int num)
@@ -431,65 +997,100 @@ void ClapVoice::setNumImpulses(int num)
 // Percussion Voice Implementation - Enhanced (for Toms, Cowbell, etc.)
 //==============================================================================
 
-void PercVoice::prepare(double sampleRate)
+void PercVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+    invSampleRate = static_cast<float>(1.0 / sampleRate);
+    amplitudePole = atRate(0.9f, rateScale);
+    pitchSmoother.setup(atRate(0.98f, rateScale), 1.0f);
     reset();
 }
 
 void PercVoice::reset()
 {
+    noiseCounter = 0;  // Same noise after every reset
     phase = 0.0f;
     phase2 = 0.0f;  // Second oscillator for richer sound
     frequency = 200.0f;
     amplitude = 0.0f;
     toneMix = 0.7f;
     noiseAmplitude = 0.0f;
-    pitchSmoothing = 0.0f;
-    amplitudeSmoothing = 0.0f;
+    pitchSmoother.reset();
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
 void PercVoice::trigger(float velocity)
 {
     amplitude = velocity * 3.0f;  // Boosted 4x for normalization (was 0.75)
     decay = 0.992f;  // Slightly longer decay
+    amplitudeSmoother.setup(amplitudePole, atRate(decay, rateScale));
     noiseAmplitude = velocity * 1.0f;  // Boosted 4x for normalization (was 0.25)
-    pitchSmoothing = frequency;
-    amplitudeSmoothing = 0.0f;
+    pitchSmoother.reset(frequency);
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
+}
+
+void PercVoice::updateControl()
+{
+    pitchSmoother.begin(frequency);
+
+    amplitudeSmoother.begin(amplitude);
+    amplitude *= amplitudeSmoother.decayN;
+    if (amplitude < 0.0001f) amplitude = 0.0f;
+    noiseAmplitude *= amplitudeSmoother.decayN;
+
+    controlCountdown = kVoiceControlBlock;
 }
 
 float PercVoice::processSample()
 {
-    // Apply pitch smoothing (prevent zipper noise)
-    pitchSmoothing = pitchSmoothing * 0.98f + frequency * 0.02f;
+    float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
 
-    // Generate primary tone (sine wave)
-    phase += static_cast<float>(pitchSmoothing / sampleRate);
-    if (phase > 1.0f) phase -= 1.0f;
-    float tone = SchillingerEcosystem::DSP::fastSineLookup(phase * 2.0f * M_PI);
+void PercVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
 
-    // Generate secondary tone at slight detune for body resonance
-    phase2 += static_cast<float>(pitchSmoothing * 1.5f / sampleRate);  // Fifth above
-    if (phase2 > 1.0f) phase2 -= 1.0f;
-    float tone2 = SchillingerEcosystem::DSP::fastSineLookup(phase2 * 2.0f * M_PI) * 0.2f;
+    const DrumLookupTables& tables = DrumLookupTables::get();
 
-    // Mix tones for fuller sound
-    tone = tone * 0.8f + tone2;
+    float noiseBuf[kVoiceControlBlock];
 
-    // Generate noise (deterministic LCG with per-instance seed)
-    noiseSeed = noiseSeed * 1103515245 + 12345;
-    float noise = static_cast<float>((noiseSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff) * 2.0f - 1.0f;
+    for (int start = 0; start < numSamples;)
+    {
+        if (controlCountdown == 0)
+        {
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
+        }
 
-    // Apply amplitude smoothing
-    float targetAmplitude = amplitude;
-    amplitudeSmoothing = amplitudeSmoothing * 0.9f + targetAmplitude * 0.1f;
+        const int n = std::min(controlCountdown, numSamples - start);
+        RandomStream::fillSigned(kNoiseKey, noiseCounter, noiseBuf, n);
 
-    amplitude *= decay;
-    if (amplitude < 0.0001f) amplitude = 0.0f;
-    noiseAmplitude *= decay;
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            // Primary tone plus a fifth above for body resonance
+            const float increment = pitchSmoother.next() * invSampleRate;
+            phase += increment;
+            if (phase > 1.0f) phase -= 1.0f;
+            phase2 += increment * 1.5f;
+            if (phase2 > 1.0f) phase2 -= 1.0f;
+
+            float tone = tables.sineCycles(phase);
+            float tone2 = tables.sineCycles(phase2) * 0.2f;
+            tone = tone * 0.8f + tone2;
+
+            out[i] += (tone * toneMix + noiseBuf[i] * (1.0f - toneMix)) * amplitudeSmoother.next();
+        }
 
-    // Mix tone and noise with better balance
-    return (tone * toneMix + noise * (1.0f - toneMix)) * amplitudeSmoothing;
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void PercVoice::setPitch(float pitch)
@@ -502,6 +1103,7 @@ void PercVoice::setPitch(float pitch)
 void PercVoice::setDecay(float decay)
 {
     this->decay = 0.992f + decay * 0.007f;  // Expanded range
+    amplitudeSmoother.setup(amplitudePole, atRate(this->decay, rateScale));
 }
 
 void PercVoice::setTone(float tone)
@@ -514,9 +1116,14 @@ void PercVoice::setTone(float tone)
 // Cymbal Voice Implementation - Enhanced with More Metallic Decay
 //==============================================================================
 
-void CymbalVoice::prepare(double sampleRate)
+void CymbalVoice::prepare(double newSampleRate)
 {
-    sampleRate = sampleRate;
+    sampleRate = newSampleRate;
+    rateScale = static_cast<float>(kVoiceReferenceRate / sampleRate);
+    invSampleRate = static_cast<float>(1.0 / sampleRate);
+    fmIncrement = 0.08f * rateScale;   // Slower FM for smooth modulation
+    fmIncrement2 = 0.13f * rateScale;  // Different FM rate for complexity
+    amplitudePole = atRate(0.95f, rateScale);
     reset();
 }
 
@@ -527,13 +1134,15 @@ void CymbalVoice::reset()
         phases[i] = 0.0f;
         frequencies[i] = 0.0f;
         amplitudes[i] = 0.0f;
+        baseIncrements[i] = 0.0f;
     }
     masterAmplitude = 0.0f;
     decay = 0.999f;
     fmDepth = 0.0f;
     fmPhase = 0.0f;
     fmPhase2 = 0.0f;  // Second FM oscillator for richer metallic sound
-    amplitudeSmoothing = 0.0f;
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
 }
 
 void CymbalVoice::trigger(float velocity)
@@ -545,6 +1154,8 @@ void CymbalVoice::trigger(float velocity)
     frequencies[3] = 1370.0f;  // Seventh
     frequencies[4] = 1850.0f;  // High overtone
     frequencies[5] = 2430.0f;  // Very high overtone
+    for (int i = 0; i < numOscillators; ++i)
+        baseIncrements[i] = frequencies[i] * invSampleRate;
 
     // Set amplitudes with spectral balance
     amplitudes[0] = velocity * 0.25f;  // Strong fundamental
@@ -556,47 +1167,77 @@ void CymbalVoice::trigger(float velocity)
 
     masterAmplitude = velocity * 2.4f;  // Boosted 4x for normalization (was 0.6)
     decay = 0.9992f - (0.9992f - 0.9985f) * (1.0f - velocity) * 0.5f;  // Longer decay
+    amplitudeSmoother.setup(amplitudePole, atRate(decay, rateScale));
     fmDepth = 0.15f;  // Increased FM for more metallic sound
 
-    amplitudeSmoothing = 0.0f;
+    amplitudeSmoother.reset();
+    controlCountdown = 0;
+}
+
+void CymbalVoice::updateControl()
+{
+    // Higher partials get more FM
+    for (int p = 0; p < numOscillators; ++p)
+        partialFmDepth[p] = fmDepth * (1.0f + p * 0.1f);
+
+    amplitudeSmoother.begin(masterAmplitude);
+    masterAmplitude *= amplitudeSmoother.decayN;
+    if (masterAmplitude < 0.0001f) masterAmplitude = 0.0f;
+
+    controlCountdown = kVoiceControlBlock;
 }
 
 float CymbalVoice::processSample()
 {
     float output = 0.0f;
+    processBlock(&output, 1);
+    return output;
+}
 
-    // Enhanced FM modulation with two oscillators
-    float fmMod = SchillingerEcosystem::DSP::fastSineLookup(fmPhase * 2.0f * M_PI) * fmDepth;
-    fmPhase += 0.08f;  // Slower FM for smooth modulation
-    if (fmPhase > 1.0f) fmPhase -= 1.0f;
-
-    float fmMod2 = SchillingerEcosystem::DSP::fastSineLookup(fmPhase2 * 2.0f * M_PI) * fmDepth * 0.5f;
-    fmPhase2 += 0.13f;  // Different FM rate for complexity
-    if (fmPhase2 > 1.0f) fmPhase2 -= 1.0f;
+void CymbalVoice::processBlock(float* output, int numSamples)
+{
+    if (!isActive()) return;
 
-    float combinedFm = fmMod + fmMod2;
+    const DrumLookupTables& tables = DrumLookupTables::get();
 
-    for (int i = 0; i < numOscillators; ++i)
+    for (int start = 0; start < numSamples;)
     {
-        // Apply FM modulation with depth variation per partial
-        float partialFmDepth = fmDepth * (1.0f + i * 0.1f);  // Higher partials get more FM
-        float modFreq = frequencies[i] * (1.0f + combinedFm * partialFmDepth);
+        if (controlCountdown == 0)
+        {
+            updateControl();
+            // Asleep once the envelope is below the isActive() threshold
+            if (!isActive()) break;
+        }
+
+        const int n = std::min(controlCountdown, numSamples - start);
+        float* out = output + start;
+        for (int i = 0; i < n; ++i)
+        {
+            // FM modulation with two oscillators
+            float fmMod = tables.sineCycles(fmPhase) * fmDepth;
+            fmPhase += fmIncrement;
+            if (fmPhase > 1.0f) fmPhase -= 1.0f;
 
-        phases[i] += static_cast<float>(modFreq / sampleRate);
-        if (phases[i] > 1.0f) phases[i] -= 1.0f;
+            float fmMod2 = tables.sineCycles(fmPhase2) * fmDepth * 0.5f;
+            fmPhase2 += fmIncrement2;
+            if (fmPhase2 > 1.0f) fmPhase2 -= 1.0f;
 
-        output += SchillingerEcosystem::DSP::fastSineLookup(phases[i] * 2.0f * M_PI) * amplitudes[i];
-    }
+            float combinedFm = fmMod + fmMod2;
 
-    // Apply amplitude smoothing
-    float targetAmplitude = masterAmplitude;
-    amplitudeSmoothing = amplitudeSmoothing * 0.95f + targetAmplitude * 0.05f;
+            float sum = 0.0f;
+            for (int p = 0; p < numOscillators; ++p)
+            {
+                phases[p] += baseIncrements[p] * (1.0f + combinedFm * partialFmDepth[p]);
+                if (phases[p] > 1.0f) phases[p] -= 1.0f;
+                sum += tables.sineCycles(phases[p]) * amplitudes[p];
+            }
 
-    // Apply envelope
-    masterAmplitude *= decay;
-    if (masterAmplitude < 0.0001f) masterAmplitude = 0.0f;
+            out[i] += sum * amplitudeSmoother.next() * 0.25f;
+        }
 
-    return output * amplitudeSmoothing * 0.25f;  // Slightly higher output level
+        controlCountdown -= n;
+        start += n;
+    }
 }
 
 void CymbalVoice::setTone(float tone)
@@ -612,6 +1253,7 @@ void CymbalVoice::setTone(float tone)
 void CymbalVoice::setDecay(float decay)
 {
     this->decay = 0.9985f + decay * 0.0012f;  // Expanded range for longer decays
+    amplitudeSmoother.setup(amplitudePole, atRate(this->decay, rateScale));
 }
 
 void CymbalVoice::setMetallic(float metallic)
@@ -624,7 +1266,136 @@ void CymbalVoice::setMetallic(float metallic)
 // Step Sequencer Implementation
 //==============================================================================
 
-StepSequencer::StepSequencer()
+template <typename Self, typename Fn>
+void StepSequencer::visitVoicePool(Self& self, Track::DrumType type, Fn&& fn)
+{
+    visitVoicePool(self, static_cast<int>(type), fn, std::make_integer_sequence<int, kNumDrumVoiceTypes>{});
+}
+
+template <typename Self, typename Fn, int... Index>
+void StepSequencer::visitVoicePool(Self& self, int type, Fn& fn, std::integer_sequence<int, Index...>)
+{
+    // One instantiation of fn per registered pool type
+    (void) ((type == Index && (fn(std::get<Index>(self.voicePools_)), true)) || ...);
+}
+
+template <typename Self, typename Fn>
+void StepSequencer::forEachVoicePool(Self& self, Fn&& fn)
+{
+    std::apply([&fn](auto&... pool) { (fn(pool), ...); }, self.voicePools_);
+}
+
+//==============================================================================
+// Track Steps (sparse step storage)
+//==============================================================================
+
+const StepCell& TrackSteps::emptyCell()
+{
+    static const StepCell empty{};
+    return empty;
+}
+
+int TrackSteps::countBits(uint64_t bits)
+{
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(bits));
+#else
+    return __builtin_popcountll(bits);
+#endif
+}
+
+int TrackSteps::lowestBit(uint64_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+int TrackSteps::rank(int step) const
+{
+    // Stored steps before this one
+    const int word = step >> 6;
+    int slot = countBits(stored_[word] & ((uint64_t(1) << (step & 63)) - 1));
+    for (int w = 0; w < word; ++w)
+        slot += countBits(stored_[w]);
+    return slot;
+}
+
+StepCell& TrackSteps::edit(int step)
+{
+    assert(step >= 0 && step < kMaxSteps);
+    step = std::max(0, std::min(kMaxSteps - 1, step));
+
+    const int slot = rank(step);
+    if (!isStored(step))
+    {
+        stored_[step >> 6] |= uint64_t(1) << (step & 63);
+        cells_.insert(cells_.begin() + slot, StepCell{});
+    }
+    return cells_[slot];
+}
+
+int TrackSteps::getLastStored() const
+{
+    for (int word = kNumWords - 1; word >= 0; --word)
+    {
+        if (stored_[word] != 0)
+        {
+            int bit = 63;
+            while (((stored_[word] >> bit) & 1u) == 0) --bit;
+            return word * 64 + bit;
+        }
+    }
+    return -1;
+}
+
+void TrackSteps::erase(int step)
+{
+    if (!isStored(step)) return;
+    cells_.erase(cells_.begin() + rank(step));
+    stored_[step >> 6] &= ~(uint64_t(1) << (step & 63));
+}
+
+void TrackSteps::clear()
+{
+    stored_.fill(0);
+    cells_.clear();
+}
+
+void TrackSteps::compact()
+{
+    for (int step = getLastStored(); step >= 0; --step)
+        if (isStored(step) && isDefault(cells_[rank(step)]))
+            erase(step);
+}
+
+bool TrackSteps::isDefault(const StepCell& cell)
+{
+    // timingOffset is playback state, not pattern data
+    const StepCell& d = emptyCell();
+    return cell.active == d.active && cell.velocity == d.velocity && cell.probability == d.probability
+        && cell.hasFlam == d.hasFlam && cell.isRoll == d.isRoll && cell.rollNotes == d.rollNotes
+        && cell.useDrill == d.useDrill && cell.burstCount == d.burstCount && cell.burstChaos == d.burstChaos
+        && cell.burstDropout == d.burstDropout && cell.drillIntent == d.drillIntent;
+}
+
+// Index of the lowest set bit (bits != 0)
+static inline int lowestSetBit(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+StepSequencer::StepSequencer()
 {
     // Initialize tracks with default drum types
     tracks_[0].type = Track::DrumType::Kick;
@@ -660,11 +1431,30 @@ StepSequencer::StepSequencer()
     tracks_[15].type = Track::DrumType::Special;
     tracks_[15].timingRole = TimingRole::Pocket;
 
+    for (int track = 0; track < static_cast<int>(tracks_.size()); ++track)
+        updateStepLanes(track);
+
+    // Room for typical arrangements, so render-thread edits don't allocate
+    drillAutomation_.reserve(BarAutomationLane::kDefaultCapacity);
+    swingAutomation_.reserve(BarAutomationLane::kDefaultCapacity);
+    dillaAutomation_.reserve(BarAutomationLane::kDefaultCapacity);
+    updateBarPolicies();
+
     // Initialize Dilla drift states
     for (auto& state : dillaStates_)
     {
         state.drift = 0.0f;
     }
+
+    // Registered pool defaults (DrumVoiceTraits)
+    forEachDrumVoiceType([this](auto type)
+    {
+        constexpr int index = decltype(type)::value;
+        auto& pool = std::get<index>(voicePools_);
+        using Traits = DrumVoiceTraitsAt<index>;
+        pool.setPolyphony(Traits::polyphony);
+        pool.setStealMode(Traits::stealMode);
+    });
 }
 
 void StepSequencer::prepare(double sampleRate, int samplesPerBlock)
@@ -672,56 +1462,64 @@ void StepSequencer::prepare(double sampleRate, int samplesPerBlock)
     sampleRate_ = sampleRate;
     setTempo(tempo_);
 
-    // Reset micro-hit safety counter at start of each audio block
-    microHitsThisBlock_ = 0;
+    // Reset micro-hit safety counter
+    microHitsThisStep_ = 0;
 
     // Prepare all drum voices
-    kick_.prepare(sampleRate);
-    snare_.prepare(sampleRate);
-    hihatClosed_.prepare(sampleRate);
-    hihatOpen_.prepare(sampleRate);
-    clap_.prepare(sampleRate);
-    tomLow_.prepare(sampleRate);
-    tomMid_.prepare(sampleRate);
-    tomHigh_.prepare(sampleRate);
-    crash_.prepare(sampleRate);
-    ride_.prepare(sampleRate);
-    cowbell_.prepare(sampleRate);
-    shaker_.prepare(sampleRate);
-    tambourine_.prepare(sampleRate);
-    percussion_.prepare(sampleRate);
-    special_.prepare(sampleRate);
+    forEachVoicePool(*this, [sampleRate](auto& pool) { pool.prepare(sampleRate); });
 }
 
 void StepSequencer::reset()
 {
     position_ = 0.0;
+    renderPosition_ = 0;
     currentStep_ = 0;
-    microHitsThisBlock_ = 0;  // Reset micro-hit safety counter
-
-    kick_.reset();
-    snare_.reset();
-    hihatClosed_.reset();
-    hihatOpen_.reset();
-    clap_.reset();
-    tomLow_.reset();
-    tomMid_.reset();
-    tomHigh_.reset();
-    crash_.reset();
-    ride_.reset();
-    cowbell_.reset();
-    shaker_.reset();
-    tambourine_.reset();
-    percussion_.reset();
-    special_.reset();
+    stepCount_ = 0;
+    started_ = false;
+    nextResolveStep_ = 0;
+    hitQueue_.clear();
+    microHitsThisStep_ = 0;  // Reset micro-hit safety counter
+    budgetLimitedThisStep_ = false;
+    microHitsScheduled_.store(0, std::memory_order_relaxed);
+    microHitsDropped_.store(0, std::memory_order_relaxed);
+    thinnedBursts_.store(0, std::memory_order_relaxed);
+    limitedSteps_.store(0, std::memory_order_relaxed);
+
+    // Random state back to its seed, so every render from reset is identical
+    seekRandomStreams(0);
+    dillaStates_.fill(DillaState{});
+    drillFillState_ = DrillFillState{};
+    drillGateState_ = DrillGateState{};
+    currentBar_ = 0;
+    updateBarPolicies();
+
+    forEachVoicePool(*this, [](auto& pool) { pool.reset(); });
 }
 
 void StepSequencer::setTempo(float bpm)
 {
+    const float previousSamplesPerStep = samplesPerStep_;
+
     tempo_ = bpm;
     float beatsPerSecond = bpm / 60.0f;
     samplesPerBeat_ = sampleRate_ / beatsPerSecond;
     samplesPerStep_ = samplesPerBeat_ / 4.0f;  // 16th notes
+
+    // Mid-step: keep the phase within the step, and move the hits already
+    // resolved ahead with the grid
+    if (started_ && previousSamplesPerStep > 0.0f && samplesPerStep_ > 0.0f
+        && samplesPerStep_ != previousSamplesPerStep)
+    {
+        const double ratio = static_cast<double>(samplesPerStep_) / previousSamplesPerStep;
+        position_ *= ratio;
+        hitQueue_.retime(renderPosition_, ratio);
+    }
+}
+
+void StepSequencer::setLookaheadSteps(int steps)
+{
+    // Steps already resolved stay queued when the lookahead shrinks
+    lookaheadSteps_ = std::max(1, std::min(kMaxLookaheadSteps, steps));
 }
 
 void StepSequencer::setSwing(float swingAmount)
@@ -731,90 +1529,178 @@ void StepSequencer::setSwing(float swingAmount)
 
 void StepSequencer::setPatternLength(int length)
 {
-    patternLength_ = std::max(1, std::min(16, length));
+    patternLength_ = std::max(1, std::min(TrackSteps::kMaxSteps, length));
+}
+
+void StepSequencer::publishSnapshot(const SequencerSnapshot& snapshot, bool atBar)
+{
+    // Copying over the back slot frees the lane storage it held: this thread
+    snapshots_.back() = snapshot;
+    snapshots_.back().atBar = atBar;
+    snapshots_.publish();
+}
+
+void StepSequencer::queuePattern(const DrumPattern& pattern)
+{
+    SequencerSnapshot& snapshot = snapshots_.back();
+    snapshot.tracks = pattern;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = true;
+    snapshots_.publish();
+}
+
+void StepSequencer::applyPublishedSnapshot(int stepIndex)
+{
+    // A newer publish replaces one still waiting for its bar
+    if (snapshots_.acquire())
+        snapshotPending_ = true;
+
+    if (!snapshotPending_) return;
+
+    SequencerSnapshot& snapshot = snapshots_.front();
+    if (snapshot.atBar && stepIndex != 0) return;
+    snapshotPending_ = false;
+
+    if (snapshot.parts & SequencerSnapshot::Tracks)
+    {
+        // Swapped like the automation points: sparse step storage would
+        // allocate on copy
+        for (int track = 0; track < static_cast<int>(tracks_.size()); ++track)
+            swapTrack(track, snapshot.tracks[track]);
+    }
+
+    if (snapshot.parts & SequencerSnapshot::Drill)
+    {
+        drillMode_ = snapshot.drillMode;
+        drillFillPolicy_ = snapshot.drillFillPolicy;
+        drillGatePolicy_ = snapshot.drillGatePolicy;
+        barPoliciesDirty_ = true;
+
+        // Swap, don't copy: no allocation here, and the old points go back
+        // to the editor thread with the slot
+        std::swap(drillAutomation_.points, snapshot.drillAutomation.points);
+        drillCursor_ = BarAutomationLane::Cursor{};
+    }
+
+    if (snapshot.parts & SequencerSnapshot::Groove)
+    {
+        std::swap(swingAutomation_.points, snapshot.swingAutomation.points);
+        std::swap(dillaAutomation_.points, snapshot.dillaAutomation.points);
+        swingCursor_ = BarAutomationLane::Cursor{};
+        dillaCursor_ = BarAutomationLane::Cursor{};
+        barPoliciesDirty_ = true;
+    }
+}
+
+void StepSequencer::setPlaying(bool playing)
+{
+    if (!playing)
+        hitQueue_.clearGrid();
+    playing_ = playing;
 }
 
 bool StepSequencer::isTrackTriggered(int trackIndex, int stepIndex) const
 {
     if (trackIndex < 0 || trackIndex >= static_cast<int>(tracks_.size())) return false;
-    if (stepIndex < 0 || stepIndex >= 16) return false;
+    if (stepIndex < 0 || stepIndex >= TrackSteps::kMaxSteps) return false;
 
-    return tracks_[trackIndex].steps[stepIndex].active;
+    return (stepLanes_[stepIndex].activeTracks >> trackIndex) & 1u;
 }
 
 void StepSequencer::triggerTrack(int trackIndex, int stepIndex, float velocity)
 {
     if (trackIndex < 0 || trackIndex >= static_cast<int>(tracks_.size())) return;
-    if (stepIndex < 0 || stepIndex >= 16) return;
+    if (stepIndex < 0 || stepIndex >= TrackSteps::kMaxSteps) return;
+
+    // Immediate trigger: lands on the next rendered sample
+    const StepCell& cell = tracks_[trackIndex].steps[stepIndex];
+    queueTrackHit(trackIndex, cell, velocity, cell.probability, static_cast<double>(renderPosition_));
+}
+
+void StepSequencer::triggerTrackAt(int trackIndex, float velocity, int sampleOffset)
+{
+    if (trackIndex < 0 || trackIndex >= static_cast<int>(tracks_.size())) return;
 
-    auto& step = tracks_[trackIndex].steps[stepIndex];
+    pushHit(trackIndex, static_cast<double>(renderPosition_ + std::max(0, sampleOffset)), velocity, false);
+}
 
+void StepSequencer::queueTrackHit(int trackIndex, const StepCell& step, float velocity, float probability,
+                                  double hitSample)
+{
     // Check probability
-    if (step.probability < 1.0f)
+    if (probability < 1.0f)
     {
-        probSeed = probSeed * 1103515245 + 12345;
-        float randVal = static_cast<float>((probSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff);
-        if (randVal > step.probability) return;
+        if (trackRng_[trackIndex].next01() >= probability) return;
     }
 
-    // Trigger appropriate drum voice
-    Track::DrumType type = tracks_[trackIndex].type;
-
-    // Apply flam
+    // Apply flam: grace note just ahead of the main hit
     if (step.hasFlam)
     {
-        // Trigger twice with slight offset
-        processDrumVoice(type, velocity * 0.7f);
+        pushHit(trackIndex, hitSample - kFlamGraceSeconds * sampleRate_, velocity * 0.7f);
     }
 
     // Apply roll
     if (step.isRoll && step.rollNotes > 1)
     {
-        // Trigger multiple times within the step
+        // Spread the roll evenly across the step
+        const double spacing = samplesPerStep_ / static_cast<double>(step.rollNotes);
         for (int i = 0; i < step.rollNotes; ++i)
         {
-            processDrumVoice(type, velocity);
+            // Queue full: the rest of the roll would be dropped anyway
+            if (!pushHit(trackIndex, hitSample + i * spacing, velocity)) break;
         }
     }
     else
     {
-        processDrumVoice(type, velocity);
+        pushHit(trackIndex, hitSample, velocity);
     }
 }
 
+bool StepSequencer::pushHit(int trackIndex, double hitSample, float velocity, bool onGrid)
+{
+    // Hits can never land in the past
+    const int64_t samplePosition = std::max(renderPosition_, static_cast<int64_t>(std::llround(hitSample)));
+
+    // Queue full: drop the hit rather than allocate on the audio thread
+    return hitQueue_.push({samplePosition, trackIndex, velocity, onGrid});
+}
+
 void StepSequencer::triggerAllTracks(int stepIndex)
 {
-    // ========================================================================
-    // PHASE 0: Phrase-Aware Intelligence (Musical Form)
-    // ========================================================================
+    // Resolve the step with its grid position at the current sample
+    scheduleStep(stepIndex, stepIndex, static_cast<double>(renderPosition_));
+}
 
-    // Create phrase-aware copies of policies (don't modify originals)
-    DrillFillPolicy phraseAwareFill = drillFillPolicy_;
-    DrillGatePolicy phraseAwareGate = drillGatePolicy_;
+void StepSequencer::scheduleStep(int stepIndex, int64_t stepNumber, double stepStartSample)
+{
+    if (!playing_) return;
 
-    // Phrase-aware fill escalation
-    if (phraseDetector_.isPhraseEnd(currentBar_))
-    {
-        // Phrase boundaries: more intense fills
-        phraseAwareFill.triggerChance = std::max(phraseAwareFill.triggerChance, 0.9f);
-        phraseAwareFill.fillAmount = std::max(phraseAwareFill.fillAmount, 1.0f);
-    }
-    else
-    {
-        // Mid-phrase: gentler fills
-        phraseAwareFill.triggerChance = std::min(phraseAwareFill.triggerChance, 0.4f);
-        phraseAwareFill.fillAmount = std::min(phraseAwareFill.fillAmount, 0.6f);
-    }
+    // Published editor state takes over from this step on
+    applyPublishedSnapshot(stepIndex);
 
-    // Phrase-aware gate activation (temporal collapse at boundaries)
-    if (phraseDetector_.isPhraseEnd(currentBar_))
-    {
-        phraseAwareGate.enabled = true;  // Enable gate at phrase ends
-    }
-    else if (!drillGatePolicy_.enabled)
-    {
-        phraseAwareGate.enabled = false;  // Keep gates off mid-phrase unless user enabled
-    }
+    // Each step gets the full micro-hit budget
+    microHitsThisStep_ = 0;
+    budgetLimitedThisStep_ = false;
+
+    // Phrase-aware policies are derived once per bar (and again only if
+    // the policies were edited mid-bar), for the bar this step is in
+    const int64_t bar = stepNumber / getStepsPerBar();
+    updateBarIndex(bar);
+    if (barPoliciesDirty_)
+        updateBarPolicies();
+
+    // Random streams follow the bar being resolved
+    if (bar != randomBar_)
+        seekRandomStreams(bar);
+
+    // Start of a bar: decide whether it gets a fill. Bars count song
+    // steps like the policies above, so fills end each bar at any length
+    const int stepInBar = static_cast<int>(stepNumber % getStepsPerBar());
+    if (stepInBar == 0)
+        updateFillState(barFillPolicy_);
+
+    const DrillFillPolicy& phraseAwareFill = barFillPolicy_;
+    const DrillGatePolicy& phraseAwareGate = barGatePolicy_;
 
     // ========================================================================
     // PHASE 1: Calculate global drill amount (composition + automation + fill)
@@ -823,18 +1709,15 @@ void StepSequencer::triggerAllTracks(int stepIndex)
     // Start with base drill amount from drill mode
     float effectiveDrillAmount = drillMode_.amount;
 
-    // Apply automation (compositional sequencing)
-    if (!drillAutomation_.points.empty())
-    {
-        const float automatedAmount = drillAutomation_.evaluateAt(currentBar_);
-        effectiveDrillAmount = automatedAmount; // Automation overrides base
-    }
+    // Apply automation (compositional sequencing), evaluated once per bar
+    if (!drillAutomation_.empty())
+        effectiveDrillAmount = barDrillAmount_; // Automation overrides base
 
     // Apply automatic fill escalation (context-sensitive, phrase-aware)
-    if (drillFillState_.active && isFillStep(stepIndex, getStepsPerBar(), phraseAwareFill))
+    if (drillFillState_.active && isFillStep(stepInBar, getStepsPerBar(), phraseAwareFill))
     {
         // Calculate fill step index (0 = first fill step)
-        const int fillStepIndex = stepIndex - (getStepsPerBar() - phraseAwareFill.fillLengthSteps);
+        const int fillStepIndex = stepInBar - (getStepsPerBar() - phraseAwareFill.fillLengthSteps);
 
         // Linear decay across fill (last step is most wild)
         const float decay = 1.0f - (fillStepIndex * phraseAwareFill.decayPerStep);
@@ -854,13 +1737,27 @@ void StepSequencer::triggerAllTracks(int stepIndex)
     // PHASE 3: Process each track
     // ========================================================================
 
-    for (int i = 0; i < static_cast<int>(tracks_.size()); ++i)
+    // Only the tracks active on this step; their cells are the cold data.
+    // Polymetric tracks read the lane of their own step.
+    std::array<uint8_t, 16> trackSteps;
+    trackSteps.fill(static_cast<uint8_t>(stepIndex));
+    uint32_t activeTracks = stepLanes_[stepIndex].activeTracks & ~uint32_t(polymetricTracks_);
+    for (uint32_t bits = polymetricTracks_; bits != 0; bits &= bits - 1)
     {
-        if (!tracks_[i].steps[stepIndex].active)
-            continue;
+        const int i = lowestSetBit(bits);
+        const int trackStep = static_cast<int>(stepNumber % tracks_[i].length);
+        trackSteps[i] = static_cast<uint8_t>(trackStep);
+        activeTracks |= stepLanes_[trackStep].activeTracks & (1u << i);
+    }
+
+    for (; activeTracks != 0; activeTracks &= activeTracks - 1)
+    {
+        const int i = lowestSetBit(activeTracks);
+        const int trackStep = trackSteps[i];
+        const StepLane& lane = stepLanes_[trackStep];
 
         Track::DrumType type = tracks_[i].type;
-        const StepCell& cell = tracks_[i].steps[stepIndex];
+        const StepCell& cell = tracks_[i].steps[trackStep];
 
         // ====================================================================
         // Gate Logic (per-track)
@@ -869,7 +1766,8 @@ void StepSequencer::triggerAllTracks(int stepIndex)
         if (globallyGated)
         {
             // Either complete silence or replace with extreme burst
-            if (drillRng_.next01() >= drillGatePolicy_.burstChance)
+            // (drawn from the track's own stream, like its probability)
+            if (trackRng_[i].next01() >= drillGatePolicy_.burstChance)
             {
                 // Silence: skip this step entirely
                 continue;
@@ -905,7 +1803,7 @@ void StepSequencer::triggerAllTracks(int stepIndex)
         {
             // DRILL MODE: Apply micro-burst scheduling
             // Note: drill mode bypasses groove timing layers for burst hits
-            double stepStartSeconds = 0.0; // Relative to current step
+            double stepStartSeconds = stepStartSample / sampleRate_;
             double stepDurationSeconds = samplesPerStep_ / sampleRate_;
 
             // Pass effective drill amount (from automation/fill/gate)
@@ -914,18 +1812,135 @@ void StepSequencer::triggerAllTracks(int stepIndex)
         else
         {
             // GROOVE MODE: Apply timing layers (swing + role + Dilla)
-            applyTimingLayers(i, stepIndex);
-            triggerTrack(i, stepIndex, cell.velocity / 127.0f);
+            applyTimingLayers(i, trackStep);
+            queueTrackHit(i, cell, lane.velocity[i] / 127.0f, lane.probability[i],
+                          stepStartSample + cell.timingOffset * samplesPerStep_);
+        }
+    }
+}
+
+template <typename Fn>
+void StepSequencer::forEachDueHit(Fn&& fn)
+{
+    // First call after reset: resolve the current step and its lookahead
+    if (!started_)
+    {
+        started_ = true;
+        nextResolveStep_ = stepCount_;
+        resolveThrough(stepCount_ + lookaheadSteps_);
+    }
+
+    while (!hitQueue_.empty() && hitQueue_.next().samplePosition <= renderPosition_)
+    {
+        const ScheduledHit hit = hitQueue_.next();
+        hitQueue_.pop();
+        fn(hit);
+    }
+}
+
+void StepSequencer::dispatchDueHits()
+{
+    forEachDueHit([this](const ScheduledHit& hit) { triggerDrumVoice(hit.trackIndex, hit.velocity); });
+}
+
+int StepSequencer::collectBlockHits(int numSamples, BlockHit* hits, int maxHits)
+{
+    const int64_t chunkStart = renderPosition_;
+    int numHits = 0;
+
+    int offset = 0;
+    while (offset < numSamples)
+    {
+        // Hits past maxHits are dropped, like a full hit queue
+        forEachDueHit([&](const ScheduledHit& hit)
+        {
+            if (numHits < maxHits)
+                hits[numHits++] = { static_cast<int>(hit.samplePosition - chunkStart), hit.trackIndex, hit.velocity };
+        });
+
+        const int subBlock = getSamplesUntilNextEvent(numSamples - offset);
+        advance(subBlock);
+        offset += subBlock;
+    }
+
+    return numHits;
+}
+
+void StepSequencer::renderVoiceGroup(int group, const BlockHit* hits, int numHits,
+                                     float* const* trackBuffers, int numSamples)
+{
+    if (group < 0 || group >= kNumVoiceGroups) return;
+    const auto type = static_cast<Track::DrumType>(group);
+
+    // Tracks playing through this group's pool (usually one)
+    int groupTracks[16];
+    int numGroupTracks = 0;
+    for (int track = 0; track < 16; ++track)
+    {
+        if (tracks_[track].type == type)
+        {
+            groupTracks[numGroupTracks++] = track;
+            std::fill(trackBuffers[track], trackBuffers[track] + numSamples, 0.0f);
+        }
+    }
+    if (numGroupTracks == 0) return;
+
+    visitVoicePool(*this, type, [&](auto& pool)
+    {
+        auto renderUntil = [&](int start, int end)
+        {
+            for (int i = 0; i < numGroupTracks; ++i)
+                pool.render(groupTracks[i], trackBuffers[groupTracks[i]] + start, end - start);
+        };
+
+        // Hits are in time order; split only at this group's own hits
+        int position = 0;
+        for (int h = 0; h < numHits; ++h)
+        {
+            const BlockHit& hit = hits[h];
+            if (tracks_[hit.trackIndex].type != type) continue;
+
+            if (hit.sampleOffset > position)
+            {
+                renderUntil(position, hit.sampleOffset);
+                position = hit.sampleOffset;
+            }
+            pool.trigger(hit.trackIndex, hit.velocity);
         }
+
+        if (position < numSamples)
+            renderUntil(position, numSamples);
+    });
+}
+
+int StepSequencer::getSamplesUntilNextEvent(int maxSamples) const
+{
+    int samples = maxSamples;
+
+    // Next step boundary (rounded up to the first sample at or past it)
+    if (samplesPerStep_ > 0.0f)
+    {
+        const double untilStep = std::ceil(samplesPerStep_ - position_);
+        samples = std::min(samples, std::max(1, static_cast<int>(untilStep)));
+    }
+
+    // Next pending hit
+    if (!hitQueue_.empty())
+    {
+        const int64_t untilHit = hitQueue_.next().samplePosition - renderPosition_;
+        samples = std::min(samples, static_cast<int>(std::max<int64_t>(1, untilHit)));
     }
+
+    return std::max(1, samples);
 }
 
 void StepSequencer::advance(int numSamples)
 {
     position_ += numSamples;
+    renderPosition_ += numSamples;
 
     // Check if we've advanced past the current step
-    while (position_ >= samplesPerStep_)
+    while (samplesPerStep_ > 0.0f && position_ >= samplesPerStep_)
     {
         position_ -= samplesPerStep_;
         advanceStep();
@@ -935,32 +1950,97 @@ void StepSequencer::advance(int numSamples)
 void StepSequencer::advanceStep()
 {
     currentStep_ = (currentStep_ + 1) % patternLength_;
+    ++stepCount_;
+
+    // Keep the lookahead full, so early (push) offsets can land before
+    // their grid position. Blocks that ran scheduleAhead() resolved these
+    // already.
+    resolveThrough(stepCount_ + lookaheadSteps_);
+}
+
+void StepSequencer::resolveThrough(int64_t stepNumber)
+{
+    const double stepStart = static_cast<double>(renderPosition_) - position_;
+    for (; nextResolveStep_ <= stepNumber; ++nextResolveStep_)
+    {
+        const int64_t stepsAhead = nextResolveStep_ - stepCount_;
+        const int stepIndex = static_cast<int>((currentStep_ + stepsAhead) % patternLength_);
+        scheduleStep(stepIndex, nextResolveStep_, stepStart + static_cast<double>(stepsAhead) * samplesPerStep_);
+    }
+}
 
-    // Update bar index for automation
-    updateBarIndex();
+void StepSequencer::scheduleAhead(int numSamples)
+{
+    if (samplesPerStep_ <= 0.0f || numSamples <= 0) return;
 
-    // Check if we're at the start of a new bar (step 0)
-    if (currentStep_ == 0)
+    if (!started_)
     {
-        // Apply phrase-aware intelligence to fill policy for the new bar
-        DrillFillPolicy phraseAwareFill = drillFillPolicy_;
+        started_ = true;
+        nextResolveStep_ = stepCount_;
+    }
 
-        // Phrase boundaries get more aggressive fill triggering
-        if (phraseDetector_.isPhraseEnd(currentBar_))
-        {
-            phraseAwareFill.triggerChance = std::max(phraseAwareFill.triggerChance, 0.9f);
-        }
-        else
-        {
-            phraseAwareFill.triggerChance = std::min(phraseAwareFill.triggerChance, 0.4f);
-        }
+    // Every step the block starts resolves its own lookahead; do all of
+    // that now
+    const int64_t stepsInBlock = static_cast<int64_t>((position_ + numSamples) / samplesPerStep_);
+    resolveThrough(stepCount_ + stepsInBlock + lookaheadSteps_);
+}
+
+double StepSequencer::getStepPosition() const
+{
+    const double phase = samplesPerStep_ > 0.0f ? position_ / samplesPerStep_ : 0.0;
+    return static_cast<double>(stepCount_) + phase;
+}
+
+void StepSequencer::locate(double stepPosition)
+{
+    // Hits resolved for the old position would play in the wrong place
+    hitQueue_.clearGrid();
+
+    const double step = std::floor(std::max(0.0, stepPosition));
+    stepCount_ = static_cast<int64_t>(step);
+    currentStep_ = static_cast<int>(stepCount_ % patternLength_);
+    position_ = (std::max(0.0, stepPosition) - step) * samplesPerStep_;
+
+    // Landing on a step start plays it; mid-step, the next step is the
+    // first to sound
+    started_ = true;
+    nextResolveStep_ = position_ < 1.0 ? stepCount_ : stepCount_ + 1;
+    resolveThrough(stepCount_ + lookaheadSteps_);
+}
 
-        // Update fill state for the new bar (phrase-aware)
-        updateFillState(phraseAwareFill);
+void StepSequencer::syncToHost(const HostTransport& transport)
+{
+    if (!transport.valid) return;
+
+    if (transport.tempo > 0.0 && static_cast<float>(transport.tempo) != tempo_)
+        setTempo(static_cast<float>(transport.tempo));
+
+    // Pre-roll (before the timeline start) counts as stopped
+    const bool rolling = transport.playing && transport.ppqPosition >= 0.0;
+    const bool starting = rolling && !playing_;
+    if (rolling != playing_)
+        setPlaying(rolling);
+    if (!rolling || samplesPerStep_ <= 0.0f) return;
+
+    // The host timeline in steps (16th notes), against the step clock
+    const double hostStep = transport.ppqPosition * 4.0;
+    const double drift = (hostStep - getStepPosition()) * samplesPerStep_;
+    if (!starting && std::abs(drift) <= kHostSyncToleranceSamples) return;
+
+    // Small drift inside the current step (integrating a tempo ramp one
+    // block at a time): slide the grid and its resolved hits under the
+    // playhead instead of resolving the steps again
+    const double phase = position_ + drift;
+    if (!starting && started_ && std::abs(drift) < 0.25 * samplesPerStep_
+        && phase >= 0.0 && phase < samplesPerStep_)
+    {
+        position_ = phase;
+        hitQueue_.retime(renderPosition_, 1.0, -drift);
+        return;
     }
 
-    // Trigger all tracks at current step
-    triggerAllTracks(currentStep_);
+    // Loop jump, scrub or transport start
+    locate(hostStep);
 }
 
 //==============================================================================
@@ -975,14 +2055,15 @@ float StepSequencer::getSwingOffset(int stepIndex) const
     {
         // Apply eased swing curve for more natural feel
         // Swing amount 0-1 maps to 0-50% of step duration
-        float swingFraction = swingAmount_ * 0.5f;
+        const float swing = swingAutomation_.empty() ? swingAmount_ : barSwingAmount_;
+        float swingFraction = swing * 0.5f;
 
         // Apply slight curve to swing for more musical feel
         // At low swing: linear, at high swing: eased
-        if (swingAmount_ > 0.5f)
+        if (swing > 0.5f)
         {
             // Ease out curve for heavy swing
-            float t = (swingAmount_ - 0.5f) * 2.0f;  // 0-1
+            float t = (swing - 0.5f) * 2.0f;  // 0-1
             swingFraction = 0.25f + t * t * 0.25f;  // 25% to 50%
         }
 
@@ -995,6 +2076,7 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
 {
     DillaState& state = dillaStates_[trackIndex];
     const DillaParams& p = dillaParams_;
+    const float amount = dillaAutomation_.empty() ? p.amount : barDillaAmount_;
 
     float instability = 0.0f;
     float bias = 0.0f;
@@ -1005,7 +2087,7 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
     {
         case TimingRole::Pocket:
             // Kick and toms: tight but with micro-variation
-            instability = 0.015f * p.amount * (1.0f - p.kickTight);  // Less if kick tight
+            instability = 0.015f * amount * (1.0f - p.kickTight);  // Less if kick tight
             bias = 0.0f;
             correctionStrength = 0.02f;  // Stronger correction for pocket
             break;
@@ -1015,7 +2097,7 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
             // Hi-hats, shaker, tambourine: push forward (early)
             // Interpolate between pull and push based on hatBias
             float pushAmount = p.hatBias;  // 0 = pull, 1 = push
-            instability = 0.07f * p.amount;
+            instability = 0.07f * amount;
             bias = -pushAmount * 0.08f + (1.0f - pushAmount) * 0.02f;  // More push early
             correctionStrength = 0.005f;  // Weaker correction for push
             break;
@@ -1024,7 +2106,7 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
         case TimingRole::Pull:
         {
             // Snares, claps: lay back (late)
-            instability = 0.05f * p.amount;
+            instability = 0.05f * amount;
             bias = +p.snareLate * 0.10f;  // Positive = late
             correctionStrength = 0.008f;  // Medium correction for pull
             break;
@@ -1032,8 +2114,7 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
     }
 
     // Enhanced random walk with deterministic PRNG
-    probSeed = probSeed * 1103515245 + 12345;
-    float randomVal = static_cast<float>((probSeed & 0x7fffffff)) / static_cast<float>(0x7fffffff);
+    float randomVal = trackRng_[trackIndex].next01();
 
     // Perlin-like smoothed noise for more natural drift
     float delta = (randomVal - 0.5f) * instability;
@@ -1059,9 +2140,10 @@ void StepSequencer::updateDillaDrift(int trackIndex, TimingRole role)
 void StepSequencer::applyTimingLayers(int trackIndex, int stepIndex)
 {
     if (trackIndex < 0 || trackIndex >= static_cast<int>(tracks_.size())) return;
-    if (stepIndex < 0 || stepIndex >= 16) return;
+    StepCell* stored = tracks_[trackIndex].steps.find(stepIndex);
+    if (stored == nullptr) return;  // Inactive, nothing to offset
 
-    StepCell& cell = tracks_[trackIndex].steps[stepIndex];
+    StepCell& cell = *stored;
     TimingRole role = tracks_[trackIndex].timingRole;
 
     // Clear existing offset
@@ -1112,130 +2194,493 @@ void StepSequencer::processTrack(int trackIndex, float* output, int numSamples)
     // Clear output
     std::fill(output, output + numSamples, 0.0f);
 
-    // Process the drum voice for this track
-    Track::DrumType type = tracks_[trackIndex].type;
+    // Render this track's active voices from its drum type's pool
+    visitVoicePool(*this, tracks_[trackIndex].type,
+                   [=](auto& pool) { pool.render(trackIndex, output, numSamples); });
+}
 
-    for (int i = 0; i < numSamples; ++i)
+void StepSequencer::setTrack(int index, const Track& track)
+{
+    if (index >= 0 && index < static_cast<int>(tracks_.size()))
     {
-        output[i] = processDrumVoice(type, 0.0f);  // 0 velocity = process existing envelope
+        // Voices of the old type would never be rendered again
+        if (track.type != tracks_[index].type)
+            visitVoicePool(*this, tracks_[index].type, [index](auto& pool) { pool.stopTrack(index); });
+
+        tracks_[index] = track;
+        updateStepLanes(index);
     }
 }
 
-void StepSequencer::setTrack(int index, const Track& track)
+void StepSequencer::updateStepLanes(int trackIndex)
+{
+    // Every way a track gets here (setTrack, snapshots, setTrackLength)
+    // goes through this clamp: the resolver indexes lanes by step % length
+    Track& edited = tracks_[trackIndex];
+    edited.length = std::max(0, std::min(TrackSteps::kMaxSteps, edited.length));
+
+    const uint32_t bit = 1u << trackIndex;
+    const Track& track = edited;
+    for (int step = 0; step < TrackSteps::kMaxSteps; ++step)
+    {
+        StepLane& lane = stepLanes_[step];
+        const StepCell& cell = track.steps[step];
+        lane.activeTracks = static_cast<uint16_t>(cell.active ? (lane.activeTracks | bit) : (lane.activeTracks & ~bit));
+        lane.velocity[trackIndex] = cell.velocity;
+        lane.probability[trackIndex] = cell.probability;
+    }
+
+    polymetricTracks_ = static_cast<uint16_t>(track.length > 0 ? (polymetricTracks_ | bit) : (polymetricTracks_ & ~bit));
+}
+
+void StepSequencer::swapTrack(int index, Track& track)
+{
+    if (track.type != tracks_[index].type)
+        visitVoicePool(*this, tracks_[index].type, [index](auto& pool) { pool.stopTrack(index); });
+
+    std::swap(tracks_[index], track);
+    updateStepLanes(index);
+}
+
+void StepSequencer::setTrackLength(int index, int length)
 {
     if (index >= 0 && index < static_cast<int>(tracks_.size()))
     {
-        tracks_[index] = track;
+        tracks_[index].length = std::max(0, std::min(TrackSteps::kMaxSteps, length));
+        updateStepLanes(index);
     }
 }
 
-Track StepSequencer::getTrack(int index) const
+const Track& StepSequencer::getTrack(int index) const
 {
+    static const Track emptyTrack{};
     if (index >= 0 && index < static_cast<int>(tracks_.size()))
     {
         return tracks_[index];
     }
-    return Track{};
+    return emptyTrack;
 }
 
 bool StepSequencer::hasActiveVoices() const
 {
     // Check if any drum voice is currently playing
-    if (kick_.isActive()) return true;
-    if (snare_.isActive()) return true;
-    if (hihatClosed_.isActive()) return true;
-    if (hihatOpen_.isActive()) return true;
-    if (clap_.isActive()) return true;
-    if (tomLow_.isActive()) return true;
-    if (tomMid_.isActive()) return true;
-    if (tomHigh_.isActive()) return true;
-    if (crash_.isActive()) return true;
-    if (ride_.isActive()) return true;
-    if (cowbell_.isActive()) return true;
-    if (shaker_.isActive()) return true;
-    if (tambourine_.isActive()) return true;
-    if (percussion_.isActive()) return true;
-    if (special_.isActive()) return true;
-
-    return false;
+    return getActiveVoiceCount() > 0;
 }
 
-float StepSequencer::processDrumVoice(Track::DrumType type, float velocity)
+int StepSequencer::getActiveVoiceCount() const
 {
-    switch (type)
-    {
-        case Track::DrumType::Kick:
-            if (velocity > 0.0f) kick_.trigger(velocity);
-            return kick_.processSample();
+    int count = 0;
+    forEachVoicePool(*this, [&count](const auto& pool) { count += pool.getActiveCount(); });
+    return count;
+}
 
-        case Track::DrumType::Snare:
-            if (velocity > 0.0f) snare_.trigger(velocity);
-            return snare_.processSample();
+int StepSequencer::getMaxPolyphony() const
+{
+    int total = 0;
+    forEachVoicePool(*this, [&total](const auto& pool) { total += pool.getPolyphony(); });
+    return total;
+}
 
-        case Track::DrumType::HiHatClosed:
-            if (velocity > 0.0f) hihatClosed_.trigger(velocity);
-            return hihatClosed_.processSample();
+void StepSequencer::setVoicePolyphony(Track::DrumType type, int numVoices)
+{
+    visitVoicePool(*this, type, [numVoices](auto& pool) { pool.setPolyphony(numVoices); });
+}
 
-        case Track::DrumType::HiHatOpen:
-            if (velocity > 0.0f) hihatOpen_.trigger(velocity);
-            return hihatOpen_.processSample();
+int StepSequencer::getVoicePolyphony(Track::DrumType type) const
+{
+    int polyphony = 0;
+    visitVoicePool(*this, type, [&polyphony](const auto& pool) { polyphony = pool.getPolyphony(); });
+    return polyphony;
+}
 
-        case Track::DrumType::Clap:
-            if (velocity > 0.0f) clap_.trigger(velocity);
-            return clap_.processSample();
+void StepSequencer::setVoiceStealMode(Track::DrumType type, VoiceStealMode mode)
+{
+    visitVoicePool(*this, type, [mode](auto& pool) { pool.setStealMode(mode); });
+}
 
-        case Track::DrumType::TomLow:
-            if (velocity > 0.0f) tomLow_.trigger(velocity);
-            return tomLow_.processSample();
+void StepSequencer::setHitCache(const HitCacheBank* bank)
+{
+    if (bank == hitCache_) return;
+    hitCache_ = bank;
 
-        case Track::DrumType::TomMid:
-            if (velocity > 0.0f) tomMid_.trigger(velocity);
-            return tomMid_.processSample();
+    for (int group = 0; group < kNumVoiceGroups; ++group)
+    {
+        const HitCacheLayer* layers = bank != nullptr ? bank->layers[group].data() : nullptr;
+        visitVoicePool(*this, static_cast<Track::DrumType>(group), [layers](auto& pool) { pool.setHitCache(layers); });
+    }
+}
 
-        case Track::DrumType::TomHigh:
-            if (velocity > 0.0f) tomHigh_.trigger(velocity);
-            return tomHigh_.processSample();
+int StepSequencer::getCachedVoiceCount() const
+{
+    int count = 0;
+    forEachVoicePool(*this, [&count](const auto& pool) { count += pool.getCachedActiveCount(); });
+    return count;
+}
 
-        case Track::DrumType::Crash:
-            if (velocity > 0.0f) crash_.trigger(velocity);
-            return crash_.processSample();
+void StepSequencer::triggerDrumVoice(int trackIndex, float velocity)
+{
+    visitVoicePool(*this, tracks_[trackIndex].type,
+                   [=](auto& pool) { pool.trigger(trackIndex, velocity); });
+}
 
-        case Track::DrumType::Ride:
-            if (velocity > 0.0f) ride_.trigger(velocity);
-            return ride_.processSample();
+//==============================================================================
+// Parameter Definitions
+//==============================================================================
 
-        case Track::DrumType::Cowbell:
-            if (velocity > 0.0f) cowbell_.trigger(velocity);
-            return cowbell_.processSample();
+struct DrumParamTable
+{
+    std::array<DrumParamInfo, kNumDrumParams> info{};
 
-        case Track::DrumType::Shaker:
-            if (velocity > 0.0f) shaker_.trigger(velocity);
-            return shaker_.processSample();
+    // Storage for the generated per-track IDs
+    char trackIds[32][24];
+    char trackAliases[32][24];
 
-        case Track::DrumType::Tambourine:
-            if (velocity > 0.0f) tambourine_.trigger(velocity);
-            return tambourine_.processSample();
+    // Both spellings of every ID, sorted by strcmp for findDrumParam
+    struct IdEntry
+    {
+        const char* id;
+        DrumParam param;
+    };
+    std::array<IdEntry, 2 * kNumDrumParams> sortedIds{};
 
-        case Track::DrumType::Percussion:
-            if (velocity > 0.0f) percussion_.trigger(velocity);
-            return percussion_.processSample();
+    DrumParamTable()
+    {
+        static const DrumParamInfo globals[] = {
+            { "tempo",            "tempo",          60.0f, 200.0f, 120.0f },
+            { "swing",            "swing",           0.0f,   1.0f,   0.0f },
+            { "master_volume",    "masterVolume",    0.0f,   1.0f,   0.8f },
+            { "pattern_length",   "patternLength",   1.0f, 128.0f,  16.0f },
+            { "pocket_offset",    "pocketOffset",   -0.1f,   0.1f,   0.0f },
+            { "push_offset",      "pushOffset",     -0.1f,   0.1f,  -0.04f },
+            { "pull_offset",      "pullOffset",     -0.1f,   0.1f,   0.06f },
+            { "dilla_amount",     "dillaAmount",     0.0f,   1.0f,   0.6f },
+            { "dilla_hat_bias",   "dillaHatBias",    0.0f,   1.0f,   0.55f },
+            { "dilla_snare_late", "dillaSnareLate",  0.0f,   1.0f,   0.8f },
+            { "dilla_kick_tight", "dillaKickTight",  0.0f,   1.0f,   0.7f },
+            { "dilla_max_drift",  "dillaMaxDrift",   0.0f,   0.3f,   0.15f },
+            { "structure",        "structure",       0.0f,   1.0f,   0.5f },
+            { "stereo_width",     "stereoWidth",     0.0f,   1.0f,   0.5f },
+            { "room_width",       "roomWidth",       0.0f,   1.0f,   0.3f },
+            { "effects_width",    "effectsWidth",    0.0f,   1.0f,   0.7f },
+        };
+        static_assert(sizeof(globals) / sizeof(globals[0]) == static_cast<size_t>(DrumParam::TrackVolume0),
+                      "one entry per global parameter");
+
+        for (size_t i = 0; i < sizeof(globals) / sizeof(globals[0]); ++i)
+            info[i] = globals[i];
+
+        for (int track = 0; track < 16; ++track)
+        {
+            std::snprintf(trackIds[track], sizeof(trackIds[track]), "track_%d_volume", track);
+            std::snprintf(trackAliases[track], sizeof(trackAliases[track]), "trackVolume_%d", track);
+            info[static_cast<int>(trackVolumeParam(track))] = { trackIds[track], trackAliases[track], 0.0f, 1.0f, 0.8f };
 
-        case Track::DrumType::Special:
-            if (velocity > 0.0f) special_.trigger(velocity);
-            return special_.processSample();
+            std::snprintf(trackIds[16 + track], sizeof(trackIds[16 + track]), "track_%d_pan", track);
+            std::snprintf(trackAliases[16 + track], sizeof(trackAliases[16 + track]), "trackPan_%d", track);
+            info[static_cast<int>(trackPanParam(track))] = { trackIds[16 + track], trackAliases[16 + track], -1.0f, 1.0f, 0.0f };
+        }
 
-        default:
-            return 0.0f;
+        for (int i = 0; i < kNumDrumParams; ++i)
+        {
+            sortedIds[2 * i] = { info[i].id, static_cast<DrumParam>(i) };
+            sortedIds[2 * i + 1] = { info[i].aliasId, static_cast<DrumParam>(i) };
+        }
+        std::sort(sortedIds.begin(), sortedIds.end(),
+                  [](const IdEntry& a, const IdEntry& b) { return std::strcmp(a.id, b.id) < 0; });
     }
+};
+
+static const DrumParamTable& getDrumParamTable()
+{
+    static const DrumParamTable table;
+    return table;
+}
+
+const DrumParamInfo& getDrumParamInfo(DrumParam param)
+{
+    return getDrumParamTable().info[static_cast<size_t>(param)];
+}
+
+DrumParam findDrumParam(const char* paramId)
+{
+    if (paramId == nullptr) return DrumParam::Count;
+
+    // Binary search: preset loads and wrapper calls look IDs up by name
+    const auto& ids = getDrumParamTable().sortedIds;
+    const auto it = std::lower_bound(ids.begin(), ids.end(), paramId,
+                                     [](const DrumParamTable::IdEntry& entry, const char* key)
+                                     { return std::strcmp(entry.id, key) < 0; });
+    return (it != ids.end() && std::strcmp(it->id, paramId) == 0) ? it->param : DrumParam::Count;
 }
 
+//==============================================================================
+// Render Worker Pool
+//==============================================================================
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+    stop();
+}
+
+void RenderWorkerPool::start(int numWorkers, bool pinThreads)
+{
+    stop();
+
+    running_.store(true, std::memory_order_release);
+    threads_.reserve(static_cast<size_t>(std::max(0, numWorkers)));
+    for (int i = 0; i < numWorkers; ++i)
+        threads_.emplace_back([this, i, pinThreads] { workerLoop(i + 1, pinThreads); });
+}
+
+void RenderWorkerPool::stop()
+{
+    running_.store(false, std::memory_order_release);
+    for (auto& thread : threads_)
+        thread.join();
+    threads_.clear();
+}
+
+void RenderWorkerPool::run(JobFn fn, void* context, int numJobs)
+{
+    numJobs = std::max(0, std::min(numJobs, 0xffff));
+
+    // The previous batch is fully done, so no worker reads these now
+    fn_ = fn;
+    context_ = context;
+    pendingJobs_.store(numJobs, std::memory_order_relaxed);
+
+    const uint64_t generation = (batch_.load(std::memory_order_relaxed) >> 32) + 1;
+    batch_.store((generation << 32) | (static_cast<uint64_t>(numJobs) << 16), std::memory_order_release);
+
+    runJobs(0);
+
+    while (pendingJobs_.load(std::memory_order_acquire) > 0)
+        cpuRelax();
+}
+
+bool RenderWorkerPool::runJobs(int workerIndex)
+{
+    bool ranJob = false;
+    uint64_t batch = batch_.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const int numJobs = static_cast<int>((batch >> 16) & 0xffff);
+        const int job = static_cast<int>(batch & 0xffff);
+        if (job >= numJobs)
+            return ranJob;
+
+        // Claim fails (and reloads batch) if another thread got there first
+        if (batch_.compare_exchange_weak(batch, batch + 1,
+                                         std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            fn_(context_, job, workerIndex);
+            pendingJobs_.fetch_sub(1, std::memory_order_release);
+            ranJob = true;
+            batch = batch_.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void RenderWorkerPool::workerLoop(int workerIndex, bool pinThread)
+{
+#if defined(__linux__)
+    if (pinThread)
+    {
+        const unsigned numCores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(static_cast<int>(workerIndex % numCores), &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#else
+    (void)pinThread;
+#endif
+
+    // Jobs are render work: same no-allocation rule as the audio thread
+    RealtimeNoAllocScope noAlloc;
+
+    // Spin while blocks arrive back to back, back off once idle
+    int idleSpins = 0;
+    while (running_.load(std::memory_order_acquire))
+    {
+        if (runJobs(workerIndex))
+        {
+            idleSpins = 0;
+        }
+        else if (++idleSpins < 2048)
+        {
+            cpuRelax();
+        }
+        else if (idleSpins < 8192)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+//==============================================================================
+// Render Profiling
+//==============================================================================
+
+#if DRUMMACHINE_PROFILING
+void RenderProfiler::endBlock(int64_t start, int numSamples, double sampleRate, const StepSequencer& sequencer)
+{
+    const uint64_t blockNs = static_cast<uint64_t>(now() - start);
+    const double audioNs = sampleRate > 0.0 ? numSamples * 1.0e9 / sampleRate : 0.0;
+
+    blocks_.fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(blockNs, std::memory_order_relaxed);
+    audioNs_.fetch_add(static_cast<uint64_t>(audioNs), std::memory_order_relaxed);
+    lastBlockNs_.store(blockNs, std::memory_order_relaxed);
+    activeVoices_.store(sequencer.getActiveVoiceCount(), std::memory_order_relaxed);
+
+    // Only the render thread writes the maxima
+    if (blockNs > worstBlockNs_.load(std::memory_order_relaxed))
+        worstBlockNs_.store(blockNs, std::memory_order_relaxed);
+    const float load = audioNs > 0.0 ? static_cast<float>(blockNs / audioNs) : 0.0f;
+    if (load > worstLoad_.load(std::memory_order_relaxed))
+        worstLoad_.store(load, std::memory_order_relaxed);
+}
+
+void RenderProfiler::reset()
+{
+    // Counters keep running; a block in flight may land on either side
+    blocks_.store(0, std::memory_order_relaxed);
+    totalNs_.store(0, std::memory_order_relaxed);
+    audioNs_.store(0, std::memory_order_relaxed);
+    lastBlockNs_.store(0, std::memory_order_relaxed);
+    worstBlockNs_.store(0, std::memory_order_relaxed);
+    worstLoad_.store(0.0f, std::memory_order_relaxed);
+    for (auto& ns : stageNs_) ns.store(0, std::memory_order_relaxed);
+    for (auto& ns : voiceGroupNs_) ns.store(0, std::memory_order_relaxed);
+}
+
+RenderProfile RenderProfiler::get() const
+{
+    RenderProfile profile;
+    profile.blocks = blocks_.load(std::memory_order_relaxed);
+    profile.totalNs = totalNs_.load(std::memory_order_relaxed);
+    profile.lastBlockNs = lastBlockNs_.load(std::memory_order_relaxed);
+    profile.worstBlockNs = worstBlockNs_.load(std::memory_order_relaxed);
+    profile.worstLoad = worstLoad_.load(std::memory_order_relaxed);
+    profile.activeVoices = activeVoices_.load(std::memory_order_relaxed);
+
+    const uint64_t audioNs = audioNs_.load(std::memory_order_relaxed);
+    profile.averageLoad = audioNs > 0 ? static_cast<float>(static_cast<double>(profile.totalNs) / audioNs) : 0.0f;
+
+    for (int stage = 0; stage < kNumProfileStages; ++stage)
+        profile.stageNs[stage] = stageNs_[stage].load(std::memory_order_relaxed);
+    for (int group = 0; group < StepSequencer::kNumVoiceGroups; ++group)
+    {
+        profile.voiceGroupNs[group] = voiceGroupNs_[group].load(std::memory_order_relaxed);
+        profile.stageNs[static_cast<int>(ProfileStage::Voices)] += profile.voiceGroupNs[group];
+    }
+    return profile;
+}
+#endif
+
 //==============================================================================
 // Main Drum Machine Implementation
 //==============================================================================
 
+// Global parameters stored in the preset "parameters" section
+static const DrumParam kPresetGlobalParams[] = {
+    DrumParam::Tempo, DrumParam::Swing, DrumParam::MasterVolume, DrumParam::PatternLength,
+    DrumParam::PocketOffset, DrumParam::PushOffset, DrumParam::PullOffset,
+    DrumParam::DillaAmount, DrumParam::DillaHatBias, DrumParam::DillaSnareLate,
+    DrumParam::DillaKickTight, DrumParam::DillaMaxDrift
+};
+
+// Preset names, indexed by Track::DrumType and TimingRole
+static const char* const kDrumTypeNames[] = {
+    "Kick", "Snare", "HiHatClosed", "HiHatOpen", "Clap", "TomLow", "TomMid", "TomHigh",
+    "Crash", "Ride", "Cowbell", "Shaker", "Tambourine", "Percussion", "Special"
+};
+static const char* const kTimingRoleNames[] = { "Pocket", "Push", "Pull" };
+static constexpr int kNumDrumTypes = static_cast<int>(sizeof(kDrumTypeNames) / sizeof(kDrumTypeNames[0]));
+static_assert(kNumDrumTypes == StepSequencer::kNumVoiceGroups, "one name per drum type");
+
+// Kit voice parameters in preset order ("kit"/"voices"/voice/key). The
+// clap's impulse count is an int and is handled next to this table.
+struct VoiceParamField
+{
+    const char* voice;
+    const char* key;
+    float VoiceParams::* member;
+};
+
+static const VoiceParamField kVoiceParamFields[] = {
+    { "kick", "pitch", &VoiceParams::kickPitch },
+    { "kick", "decay", &VoiceParams::kickDecay },
+    { "kick", "click", &VoiceParams::kickClick },
+    { "snare", "tone", &VoiceParams::snareTone },
+    { "snare", "decay", &VoiceParams::snareDecay },
+    { "snare", "snap", &VoiceParams::snareSnap },
+    { "hihat_closed", "tone", &VoiceParams::hihatClosedTone },
+    { "hihat_closed", "decay", &VoiceParams::hihatClosedDecay },
+    { "hihat_closed", "metallic", &VoiceParams::hihatClosedMetallic },
+    { "hihat_open", "tone", &VoiceParams::hihatOpenTone },
+    { "hihat_open", "decay", &VoiceParams::hihatOpenDecay },
+    { "hihat_open", "metallic", &VoiceParams::hihatOpenMetallic },
+    { "clap", "tone", &VoiceParams::clapTone },
+    { "clap", "decay", &VoiceParams::clapDecay },
+    { "tom_low", "pitch", &VoiceParams::tomLowPitch },
+    { "tom_low", "decay", &VoiceParams::tomLowDecay },
+    { "tom_low", "tone", &VoiceParams::tomLowTone },
+    { "tom_mid", "pitch", &VoiceParams::tomMidPitch },
+    { "tom_mid", "decay", &VoiceParams::tomMidDecay },
+    { "tom_mid", "tone", &VoiceParams::tomMidTone },
+    { "tom_high", "pitch", &VoiceParams::tomHighPitch },
+    { "tom_high", "decay", &VoiceParams::tomHighDecay },
+    { "tom_high", "tone", &VoiceParams::tomHighTone },
+    { "crash", "tone", &VoiceParams::crashTone },
+    { "crash", "decay", &VoiceParams::crashDecay },
+    { "crash", "metallic", &VoiceParams::crashMetallic },
+    { "ride", "tone", &VoiceParams::rideTone },
+    { "ride", "decay", &VoiceParams::rideDecay },
+    { "ride", "metallic", &VoiceParams::rideMetallic },
+    { "cowbell", "pitch", &VoiceParams::cowbellPitch },
+    { "cowbell", "decay", &VoiceParams::cowbellDecay },
+    { "cowbell", "tone", &VoiceParams::cowbellTone },
+    { "shaker", "tone", &VoiceParams::shakerTone },
+    { "shaker", "decay", &VoiceParams::shakerDecay },
+    { "shaker", "metallic", &VoiceParams::shakerMetallic },
+    { "tambourine", "tone", &VoiceParams::tambourineTone },
+    { "tambourine", "decay", &VoiceParams::tambourineDecay },
+    { "tambourine", "metallic", &VoiceParams::tambourineMetallic },
+    { "percussion", "pitch", &VoiceParams::percussionPitch },
+    { "percussion", "decay", &VoiceParams::percussionDecay },
+    { "percussion", "tone", &VoiceParams::percussionTone },
+    { "special", "tone", &VoiceParams::specialTone },
+    { "special", "decay", &VoiceParams::specialDecay },
+    { "special", "snap", &VoiceParams::specialSnap },
+};
+
 DrumMachinePureDSP::DrumMachinePureDSP()
 {
     // Deterministic PRNG - don't seed srand()
+    allocateRenderBuffers(blockSize_);
+    DrumLookupTables::get();  // Build the shared tables off the audio thread
+
+    for (int i = 0; i < kNumDrumParams; ++i)
+        paramValues_[i].store(getDrumParamInfo(static_cast<DrumParam>(i)).defaultValue, std::memory_order_relaxed);
+
+    resetNoteMapping();
+    telemetry_.startLogging();
 }
 
 DrumMachinePureDSP::~DrumMachinePureDSP()
@@ -1247,6 +2692,12 @@ bool DrumMachinePureDSP::prepare(double sampleRate, int blockSize)
     sampleRate_ = sampleRate;
     blockSize_ = blockSize;
 
+    // Pending parameter changes must land in params_ before it is read below
+    applyParameterChanges();
+
+    // Hosts may still send larger blocks; renderTracks() splits at this size
+    allocateRenderBuffers(blockSize);
+
     sequencer_.prepare(sampleRate, blockSize);
     sequencer_.setTempo(params_.tempo);
     sequencer_.setPatternLength(static_cast<int>(params_.patternLength));
@@ -1266,52 +2717,415 @@ bool DrumMachinePureDSP::prepare(double sampleRate, int blockSize)
     dillaParams.maxDrift = params_.dillaMaxDrift;
     sequencer_.setDillaParams(dillaParams);
 
+    if (isHitCacheEnabled())
+        hitCache_.request(kitGeneration_.load(std::memory_order_relaxed), sampleRate_);
+
     return true;
 }
 
+void DrumMachinePureDSP::setHitCacheEnabled(bool enabled)
+{
+    if (enabled == isHitCacheEnabled()) return;
+
+    if (enabled)
+    {
+        hitCache_.start();
+        hitCache_.request(kitGeneration_.load(std::memory_order_relaxed), sampleRate_);
+    }
+    else
+    {
+        // Voices still playing a cached hit keep their (never freed) bank
+        hitCache_.stop();
+    }
+    hitCacheEnabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void DrumMachinePureDSP::updateHitCache()
+{
+    const HitCacheBank* bank = nullptr;
+    if (isHitCacheEnabled())
+    {
+        // A newer bank swaps in once nothing plays from the current one
+        if (sequencer_.getCachedVoiceCount() == 0)
+            hitCache_.acquire();
+        if (hitCache_.isCurrent(kitGeneration_.load(std::memory_order_relaxed), sampleRate_))
+            bank = &hitCache_.current();
+    }
+
+    sequencer_.setHitCache(bank);
+    hitCacheActive_.store(bank != nullptr, std::memory_order_relaxed);
+}
+
 void DrumMachinePureDSP::reset()
 {
     sequencer_.reset();
+    mixGainsValid_ = false;
 }
 
 void DrumMachinePureDSP::process(float** outputs, int numChannels, int numSamples)
 {
-    // Clear output buffers
+    RealtimeNoAllocScope noAlloc;
+    const int64_t blockStart = RenderProfiler::now();
+    renderTracks(outputs, numChannels, numSamples);
+    profiler_.endBlock(blockStart, numSamples, sampleRate_, sequencer_);
+}
+
+RenderProfile DrumMachinePureDSP::getRenderProfile() const
+{
+    RenderProfile profile = profiler_.get();
+    profile.microHits = sequencer_.getMicroHitStats();
+    return profile;
+}
+
+void DrumMachinePureDSP::updateMixGains(int numSamples)
+{
+    const float rampScale = 1.0f / static_cast<float>(std::max(1, numSamples));
+
+    for (int track = 0; track < 16; ++track)
+    {
+        TrackMixGain& gain = mixGains_[track];
+        const float pan = params_.trackPans[track];
+        const float volume = params_.trackVolumes[track] * params_.masterVolume;
+
+        // Pan law lookup only when pan or level changed
+        if (!mixGainsValid_ || pan != gain.pan || volume != gain.volume)
+        {
+            float panLeft, panRight;
+            constantPowerPan(pan, panLeft, panRight);
+            gain.pan = pan;
+            gain.volume = volume;
+            gain.targetLeft = panLeft * volume;
+            gain.targetRight = panRight * volume;
+        }
+
+        if (!mixGainsValid_)
+        {
+            gain.left = gain.targetLeft;
+            gain.right = gain.targetRight;
+        }
+        gain.stepLeft = (gain.targetLeft - gain.left) * rampScale;
+        gain.stepRight = (gain.targetRight - gain.right) * rampScale;
+    }
+    mixGainsValid_ = true;
+}
+
+void DrumMachinePureDSP::resolveOutputBuses(float** outputs, int numChannels)
+{
+    const int numBuses = numChannels / 2;
+    blockMultiBus_ = false;
+    for (int track = 0; track < 16; ++track)
+    {
+        int bus = getTrackOutputBus(track);
+        if (bus >= numBuses || outputs[2 * bus] == nullptr || outputs[2 * bus + 1] == nullptr)
+            bus = 0;
+        blockTrackBus_[track] = static_cast<uint8_t>(bus);
+        blockMultiBus_ = blockMultiBus_ || bus != 0;
+    }
+}
+
+void DrumMachinePureDSP::renderTracks(float** outputs, int numChannels, int numSamples, float** stems)
+{
+    beginTracks(outputs, numChannels, numSamples);
+
+    bool silent = true;
+    int offset = 0;
+    while (offset < numSamples)
+    {
+        const int chunk = std::min(numSamples - offset, maxChunk_);
+        if (renderChunk(outputs, stems, numChannels, offset, chunk))
+            silent = false;
+        advanceMixGains(chunk);
+        offset += chunk;
+    }
+
+    finishTracks(silent);
+}
+
+void DrumMachinePureDSP::beginTracks(float** outputs, int numChannels, int numSamples)
+{
+    applyParameterChanges();
+    updateHitCache();
+
+    // Host clock first (its tempo wins over the parameter), then every step
+    // the block reaches is resolved before anything renders
+    if (hostTransport_.valid)
+    {
+        sequencer_.syncToHost(hostTransport_);
+        hostTransport_.valid = false;
+    }
+    sequencer_.scheduleAhead(numSamples);
+
+    // Clear output buffers (aux bus pairs may be null)
     for (int ch = 0; ch < numChannels; ++ch)
     {
-        std::fill(outputs[ch], outputs[ch] + numSamples, 0.0f);
+        if (outputs[ch] != nullptr)
+            std::fill(outputs[ch], outputs[ch] + numSamples, 0.0f);
+    }
+
+    updateMixGains(numSamples);
+    resolveOutputBuses(outputs, numChannels);
+}
+
+void DrumMachinePureDSP::advanceMixGains(int numSamples)
+{
+    for (auto& gain : mixGains_)
+    {
+        gain.left += gain.stepLeft * numSamples;
+        gain.right += gain.stepRight * numSamples;
+    }
+}
+
+void DrumMachinePureDSP::finishTracks(bool silent)
+{
+    // Land exactly on the targets so rounding never accumulates
+    for (auto& gain : mixGains_)
+    {
+        gain.left = gain.targetLeft;
+        gain.right = gain.targetRight;
+    }
+
+    lastBlockSilent_.store(silent, std::memory_order_relaxed);
+}
+
+bool DrumMachinePureDSP::renderChunk(float** outputs, float** stems, int numChannels, int offset, int numSamples)
+{
+    if (!beginChunk(outputs, stems, numChannels, offset, numSamples))
+        return false;
+
+    const int numWorkers = workerPool_.getNumWorkers();
+    chunkDeferMix_ = numWorkers > 0 && blockMultiBus_;
+    if (numWorkers == 0)
+    {
+        for (int group = 0; group < StepSequencer::kNumVoiceGroups; ++group)
+            renderVoiceGroupJob(group, 0);
+        return true;
+    }
+
+    for (int worker = 0; worker < numWorkers; ++worker)
+    {
+        float* bus = workerMix_.data() + static_cast<size_t>(worker) * 2 * maxChunk_;
+        std::fill(bus, bus + numSamples, 0.0f);
+        std::fill(bus + maxChunk_, bus + maxChunk_ + numSamples, 0.0f);
+    }
+
+    workerPool_.run(&DrumMachinePureDSP::runVoiceGroupJob, this, StepSequencer::kNumVoiceGroups);
+
+    // Several buses: the track buffers are complete, mix them into their
+    // buses here instead of keeping a worker copy of every bus
+    if (chunkDeferMix_)
+    {
+        for (int group = 0; group < StepSequencer::kNumVoiceGroups; ++group)
+            mixVoiceGroup(group, 0);
+        return true;
+    }
+
+    // Reduce the worker buses into the outputs
+    const int64_t stageStart = RenderProfiler::now();
+    for (int worker = 0; worker < numWorkers; ++worker)
+    {
+        const float* bus = workerMix_.data() + static_cast<size_t>(worker) * 2 * maxChunk_;
+        for (int ch = 0; ch < std::min(numChannels, 2); ++ch)
+        {
+            const float* in = bus + ch * maxChunk_;
+            float* out = outputs[ch] + offset;
+            for (int i = 0; i < numSamples; ++i)
+                out[i] += in[i];
+        }
     }
+    profiler_.addStage(ProfileStage::Mix, stageStart);
+    return true;
+}
 
-    // Create temp buffer for mixing
-    float* tempBuffer = new float[numSamples];
-    std::fill(tempBuffer, tempBuffer + numSamples, 0.0f);
+bool DrumMachinePureDSP::beginChunk(float** outputs, float** stems, int numChannels, int offset, int numSamples)
+{
+    // Serial pass: run the clock and collect every hit that lands in the
+    // chunk, so voice groups below only touch their own pools
+    const int64_t stageStart = RenderProfiler::now();
+    numBlockHits_ = sequencer_.collectBlockHits(numSamples, blockHits_.data(), kMaxBlockHits);
+    profiler_.addStage(ProfileStage::Sequencer, stageStart);
+
+    // Idle: nothing sounding and nothing starting. The outputs are already
+    // clear, the stems are not.
+    if (numBlockHits_ == 0 && !sequencer_.hasActiveVoices())
+    {
+        if (stems != nullptr)
+        {
+            for (int ch = 0; ch < 32; ++ch)
+                std::fill(stems[ch] + offset, stems[ch] + offset + numSamples, 0.0f);
+        }
+        return false;
+    }
 
-    // Process each track
+    chunkOutputs_ = outputs;
+    chunkStems_ = stems;
+    chunkChannels_ = numChannels;
+    chunkOffset_ = offset;
+    chunkSamples_ = numSamples;
+    chunkDeferMix_ = false;
+    return true;
+}
+
+void DrumMachinePureDSP::runVoiceGroupJob(void* context, int jobIndex, int workerIndex)
+{
+    static_cast<DrumMachinePureDSP*>(context)->renderVoiceGroupJob(jobIndex, workerIndex);
+}
+
+void DrumMachinePureDSP::renderVoiceGroupJob(int group, int workerIndex)
+{
+    const int64_t voiceStart = RenderProfiler::now();
+    sequencer_.renderVoiceGroup(group, blockHits_.data(), numBlockHits_, trackBuffers_.data(), chunkSamples_);
+    profiler_.addVoiceGroup(group, voiceStart);
+
+    if (!chunkDeferMix_)
+        mixVoiceGroup(group, workerIndex);
+}
+
+void DrumMachinePureDSP::mixVoiceGroup(int group, int workerIndex)
+{
+    const int64_t mixStart = RenderProfiler::now();
+
+    // Worker 0 (the audio thread) mixes straight into the outputs, each
+    // track into its own bus; other workers only ever see bus 0
+    float* workerLeft = nullptr;
+    if (workerIndex != 0)
+        workerLeft = workerMix_.data() + static_cast<size_t>(workerIndex - 1) * 2 * maxChunk_;
+
+    const auto type = static_cast<Track::DrumType>(group);
     for (int track = 0; track < 16; ++track)
     {
-        sequencer_.processTrack(track, tempBuffer, numSamples);
+        if (sequencer_.getTrack(track).type != type) continue;
+
+        float* left = nullptr;
+        float* right = nullptr;
+        if (workerIndex == 0)
+        {
+            const int bus = blockTrackBus_[track];
+            left = chunkChannels_ > 2 * bus ? chunkOutputs_[2 * bus] + chunkOffset_ : nullptr;
+            right = chunkChannels_ > 2 * bus + 1 ? chunkOutputs_[2 * bus + 1] + chunkOffset_ : nullptr;
+        }
+        else
+        {
+            left = workerLeft;
+            right = chunkChannels_ > 1 ? workerLeft + maxChunk_ : nullptr;
+        }
 
-        // Apply track volume and pan
-        float volume = params_.trackVolumes[track];
-        float pan = 0.5f;  // Default center (could be per-track)
+        const TrackMixGain& gain = mixGains_[track];
+        const float* trackBuffer = trackBuffers_[track];
 
-        for (int i = 0; i < numSamples; ++i)
+        // Each track belongs to exactly one group, so its stem pair is
+        // written by this job alone
+        if (chunkStems_ != nullptr)
         {
-            float sample = tempBuffer[i] * volume * params_.masterVolume;
+            float* stemLeft = chunkStems_[2 * track] + chunkOffset_;
+            float* stemRight = chunkStems_[2 * track + 1] + chunkOffset_;
+            std::fill(stemLeft, stemLeft + chunkSamples_, 0.0f);
+            std::fill(stemRight, stemRight + chunkSamples_, 0.0f);
+            mixRamped(trackBuffer, stemLeft, chunkSamples_, gain.left, gain.stepLeft);
+            mixRamped(trackBuffer, stemRight, chunkSamples_, gain.right, gain.stepRight);
+        }
 
-            // Apply pan
-            outputs[0][i] += sample * std::sqrt(1.0f - pan);
-            if (numChannels > 1)
-            {
-                outputs[1][i] += sample * std::sqrt(pan);
-            }
+        if (left == nullptr) continue;
+        if (right != nullptr)
+        {
+            mixRamped(trackBuffer, left, chunkSamples_, gain.left, gain.stepLeft);
+            mixRamped(trackBuffer, right, chunkSamples_, gain.right, gain.stepRight);
+        }
+        else
+        {
+            // Mono bus: pan does not apply, keep the track's level
+            mixRamped(trackBuffer, left, chunkSamples_, gain.volume, 0.0f);
+        }
+    }
+    profiler_.addStage(ProfileStage::Mix, mixStart);
+}
+
+void DrumMachinePureDSP::allocateRenderBuffers(int maxChunk)
+{
+    maxChunk_ = std::max(1, maxChunk);
+
+    trackScratch_.assign(static_cast<size_t>(maxChunk_) * 16, 0.0f);
+    for (int track = 0; track < 16; ++track)
+        trackBuffers_[track] = trackScratch_.data() + static_cast<size_t>(track) * maxChunk_;
+
+    workerMix_.assign(static_cast<size_t>(workerPool_.getNumWorkers()) * 2 * maxChunk_, 0.0f);
+}
+
+void DrumMachinePureDSP::setRenderThreads(int numThreads, bool pinThreads)
+{
+    const int threads = std::max(1, std::min(numThreads, StepSequencer::kNumVoiceGroups));
+
+    workerPool_.stop();
+    if (threads > 1)
+        workerPool_.start(threads - 1, pinThreads);
+    allocateRenderBuffers(maxChunk_);
+}
+
+void DrumMachinePureDSP::setOutputBusLayout(OutputBusLayout layout)
+{
+    outputBusLayout_.store(static_cast<uint8_t>(layout), std::memory_order_relaxed);
+    markDirty(PRESET_GLOBAL);
+}
+
+OutputBusLayout DrumMachinePureDSP::getOutputBusLayout() const
+{
+    return static_cast<OutputBusLayout>(outputBusLayout_.load(std::memory_order_relaxed));
+}
+
+void DrumMachinePureDSP::setTrackOutputBus(int track, int bus)
+{
+    if (track < 0 || track >= 16) return;
+
+    // Start the custom routing from what is playing now
+    if (getOutputBusLayout() != OutputBusLayout::Custom)
+    {
+        for (int t = 0; t < 16; ++t)
+            trackOutputBus_[t].store(static_cast<uint8_t>(getTrackOutputBus(t)), std::memory_order_relaxed);
+        setOutputBusLayout(OutputBusLayout::Custom);
+    }
+
+    const int clamped = std::max(0, std::min(bus, kMaxOutputBuses - 1));
+    trackOutputBus_[track].store(static_cast<uint8_t>(clamped), std::memory_order_relaxed);
+    markDirty(PRESET_GLOBAL);
+}
+
+int DrumMachinePureDSP::getTrackOutputBus(int track) const
+{
+    if (track < 0 || track >= 16) return 0;
+
+    switch (getOutputBusLayout())
+    {
+        case OutputBusLayout::PerTrack:
+            return track;
+        case OutputBusLayout::Groups:
+        {
+            const int type = static_cast<int>(sequencer_.getTrack(track).type);
+            return (type >= 0 && type < 15) ? kGroupOutputBus[type] : 0;
         }
+        case OutputBusLayout::Custom:
+            return trackOutputBus_[track].load(std::memory_order_relaxed);
+        case OutputBusLayout::Mix:
+        default:
+            return 0;
     }
+}
 
-    // Advance sequencer
-    sequencer_.advance(numSamples);
+void DrumMachinePureDSP::setNoteMapping(int midiNote, int trackIndex)
+{
+    if (midiNote < 0 || midiNote >= 128) return;
+    const int track = (trackIndex >= 0 && trackIndex < 16) ? trackIndex : -1;
+    noteMap_[midiNote].store(static_cast<int8_t>(track), std::memory_order_relaxed);
+}
 
-    delete[] tempBuffer;
+int DrumMachinePureDSP::getNoteMapping(int midiNote) const
+{
+    if (midiNote < 0 || midiNote >= 128) return -1;
+    return noteMap_[midiNote].load(std::memory_order_relaxed);
+}
+
+void DrumMachinePureDSP::resetNoteMapping()
+{
+    for (int note = 0; note < 128; ++note)
+        setNoteMapping(note, (note >= 36 && note < 52) ? note - 36 : -1);
 }
 
 void DrumMachinePureDSP::handleEvent(const ScheduledEvent& event)
@@ -1319,12 +3133,13 @@ void DrumMachinePureDSP::handleEvent(const ScheduledEvent& event)
     switch (event.type)
     {
         case ScheduledEvent::NOTE_ON:
-            // For drum machine, note on can trigger specific drums
-            // Map MIDI notes to tracks
+            // Map the note to a track and queue it at its sample offset in
+            // the next block, alongside the sequencer's own hits
             {
-                int track = event.data.note.midiNote % 16;
+                int track = getNoteMapping(event.data.note.midiNote);
                 float velocity = event.data.note.velocity;  // Already normalized (0-1)
-                sequencer_.triggerTrack(track, sequencer_.getCurrentStep(), velocity);
+                if (track >= 0)
+                    sequencer_.triggerTrackAt(track, velocity, static_cast<int>(event.sampleOffset));
             }
             break;
 
@@ -1335,611 +3150,1362 @@ void DrumMachinePureDSP::handleEvent(const ScheduledEvent& event)
 
 float DrumMachinePureDSP::getParameter(const char* paramId) const
 {
-    if (std::strcmp(paramId, "tempo") == 0)
-        return params_.tempo;
-    if (std::strcmp(paramId, "swing") == 0)
-        return params_.swing;
-    if (std::strcmp(paramId, "master_volume") == 0)
-        return params_.masterVolume;
-    if (std::strcmp(paramId, "pattern_length") == 0)
-        return params_.patternLength;
-
-    // Role timing parameters
-    if (std::strcmp(paramId, "pocket_offset") == 0)
-        return params_.pocketOffset;
-    if (std::strcmp(paramId, "push_offset") == 0)
-        return params_.pushOffset;
-    if (std::strcmp(paramId, "pull_offset") == 0)
-        return params_.pullOffset;
-
-    // Dilla parameters
-    if (std::strcmp(paramId, "dilla_amount") == 0)
-        return params_.dillaAmount;
-    if (std::strcmp(paramId, "dilla_hat_bias") == 0)
-        return params_.dillaHatBias;
-    if (std::strcmp(paramId, "dilla_snare_late") == 0)
-        return params_.dillaSnareLate;
-    if (std::strcmp(paramId, "dilla_kick_tight") == 0)
-        return params_.dillaKickTight;
-    if (std::strcmp(paramId, "dilla_max_drift") == 0)
-        return params_.dillaMaxDrift;
-
-    // Track volumes
-    for (int i = 0; i < 16; ++i)
-    {
-        char name[32];
-        std::snprintf(name, sizeof(name), "track_%d_volume", i);
-        if (std::strcmp(paramId, name) == 0)
-            return params_.trackVolumes[i];
+    const DrumParam param = findDrumParam(paramId);
+    return (param != DrumParam::Count) ? getParameter(param) : 0.0f;
+}
+
+void DrumMachinePureDSP::setParameter(const char* paramId, float value)
+{
+    const DrumParam param = findDrumParam(paramId);
+    if (param != DrumParam::Count)
+        setParameter(param, value);
+}
+
+float DrumMachinePureDSP::getParameter(DrumParam param) const
+{
+    const int index = static_cast<int>(param);
+    if (index < 0 || index >= kNumDrumParams) return 0.0f;
+    return paramValues_[index].load(std::memory_order_relaxed);
+}
+
+void DrumMachinePureDSP::setParameter(DrumParam param, float value)
+{
+    const int index = static_cast<int>(param);
+    if (index < 0 || index >= kNumDrumParams || !std::isfinite(value)) return;
+
+    // Held to the parameter's range before the audio thread sees it
+    const DrumParamInfo& info = getDrumParamInfo(param);
+    value = std::max(info.minValue, std::min(info.maxValue, value));
+
+    // Only values that actually changed are flagged for the audio thread
+    const float oldValue = paramValues_[index].exchange(value, std::memory_order_relaxed);
+    if (oldValue == value) return;
+    dirtyParams_.fetch_or(uint64_t{1} << index, std::memory_order_release);
+    markDirty(PRESET_GLOBAL);
+
+    // Recorded only; formatting and logging happen on the telemetry thread
+    telemetry_.push(param, oldValue, value);
+}
+
+void DrumMachinePureDSP::applyParameterChanges()
+{
+    uint64_t dirty = dirtyParams_.exchange(0, std::memory_order_acquire);
+    for (int index = 0; dirty != 0; ++index, dirty >>= 1)
+    {
+        if (dirty & 1)
+            applyParameter(static_cast<DrumParam>(index), paramValues_[index].load(std::memory_order_relaxed));
     }
+}
+
+void DrumMachinePureDSP::applyParameter(DrumParam param, float value)
+{
+    switch (param)
+    {
+        case DrumParam::Tempo:
+            params_.tempo = value;
+            sequencer_.setTempo(value);
+            break;
+        case DrumParam::Swing:
+            params_.swing = value;
+            sequencer_.setSwing(value);
+            break;
+        case DrumParam::MasterVolume:
+            params_.masterVolume = value;
+            break;
+        case DrumParam::PatternLength:
+            params_.patternLength = value;
+            sequencer_.setPatternLength(static_cast<int>(value));
+            break;
+
+        // Role timing parameters
+        case DrumParam::PocketOffset:
+        case DrumParam::PushOffset:
+        case DrumParam::PullOffset:
+        {
+            RoleTimingParams params = sequencer_.getRoleTimingParams();
+            if (param == DrumParam::PocketOffset)
+                params.pocketOffset = params_.pocketOffset = value;
+            else if (param == DrumParam::PushOffset)
+                params.pushOffset = params_.pushOffset = value;
+            else
+                params.pullOffset = params_.pullOffset = value;
+            sequencer_.setRoleTimingParams(params);
+            break;
+        }
+
+        // Dilla parameters
+        case DrumParam::DillaAmount:
+        case DrumParam::DillaHatBias:
+        case DrumParam::DillaSnareLate:
+        case DrumParam::DillaKickTight:
+        case DrumParam::DillaMaxDrift:
+        {
+            DillaParams params = sequencer_.getDillaParams();
+            if (param == DrumParam::DillaAmount)
+                params.amount = params_.dillaAmount = value;
+            else if (param == DrumParam::DillaHatBias)
+                params.hatBias = params_.dillaHatBias = value;
+            else if (param == DrumParam::DillaSnareLate)
+                params.snareLate = params_.dillaSnareLate = value;
+            else if (param == DrumParam::DillaKickTight)
+                params.kickTight = params_.dillaKickTight = value;
+            else
+                params.maxDrift = params_.dillaMaxDrift = value;
+            sequencer_.setDillaParams(params);
+            break;
+        }
+
+        // Structure and stereo
+        case DrumParam::Structure:
+            params_.structure = value;
+            break;
+        case DrumParam::StereoWidth:
+            params_.stereoWidth = value;
+            break;
+        case DrumParam::RoomWidth:
+            params_.roomWidth = value;
+            break;
+        case DrumParam::EffectsWidth:
+            params_.effectsWidth = value;
+            break;
+
+        default:
+        {
+            // Per-track mix
+            const int index = static_cast<int>(param);
+            const int volume0 = static_cast<int>(DrumParam::TrackVolume0);
+            const int pan0 = static_cast<int>(DrumParam::TrackPan0);
+            if (index >= volume0 && index < volume0 + 16)
+                params_.trackVolumes[index - volume0] = value;
+            else if (index >= pan0 && index < pan0 + 16)
+                params_.trackPans[index - pan0] = value;
+            break;
+        }
+    }
+}
+
+//==============================================================================
+// Single-Pass JSON Reader
+//==============================================================================
+
+// Scalar value reported by readJson(); strings point into the document and
+// keep their escape sequences
+struct JsonScalar
+{
+    enum Type { Number, Bool, String, Null };
+
+    Type type = Null;
+    double number = 0.0;
+    bool boolean = false;
+    const char* text = nullptr;
+    int length = 0;
+
+    float asFloat(float fallback) const { return type == Number ? static_cast<float>(number) : fallback; }
+    bool asBool(bool fallback) const { return type == Bool ? boolean : (type == Number ? number != 0.0 : fallback); }
+    // Counts and offsets: clamped before the cast, so huge values stay defined
+    int asInt(int fallback) const
+    {
+        if (type != Number || !std::isfinite(number)) return fallback;
+        return static_cast<int>(std::max(-16777216.0, std::min(16777216.0, number)));
+    }
+    bool equals(const char* s) const
+    {
+        return type == String && static_cast<int>(std::strlen(s)) == length && std::memcmp(text, s, length) == 0;
+    }
+};
+
+// Object keys and array indices leading to the current value
+struct JsonPath
+{
+    static constexpr int kMaxDepth = 8;
+
+    struct Level
+    {
+        const char* key = nullptr;  // Object member (not terminated)
+        int keyLength = 0;
+        int index = -1;             // Array element
+    };
+
+    Level levels[kMaxDepth];
+    int depth = 0;
+
+    bool isKey(int level, const char* key) const
+    {
+        const Level& l = levels[level];
+        return l.key != nullptr && static_cast<int>(std::strlen(key)) == l.keyLength
+            && std::memcmp(l.key, key, l.keyLength) == 0;
+    }
+
+    bool copyKey(int level, char* out, int outSize) const
+    {
+        const Level& l = levels[level];
+        if (l.key == nullptr || l.keyLength >= outSize) return false;
+        std::memcpy(out, l.key, l.keyLength);
+        out[l.keyLength] = '\0';
+        return true;
+    }
+};
+
+// Recursive descent over the text, calling handler(path, scalar) for every
+// scalar. One pass and no allocation, where the old per-key strstr lookup
+// rescanned the whole document for each key.
+template <typename Handler>
+class JsonReader
+{
+public:
+    JsonReader(const char* text, Handler& handler) : p_(text), handler_(handler) {}
+
+    bool read()
+    {
+        skipSpace();
+        if (!parseValue()) return false;
+        skipSpace();
+        return *p_ == '\0';
+    }
+
+private:
+    const char* p_;
+    Handler& handler_;
+    JsonPath path_;
+
+    void skipSpace()
+    {
+        while (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t') ++p_;
+    }
+
+    bool parseString(const char*& text, int& length)
+    {
+        if (*p_ != '"') return false;
+        text = ++p_;
+        while (*p_ != '"')
+        {
+            if (*p_ == '\0') return false;
+            if (*p_ == '\\' && p_[1] != '\0') ++p_;
+            ++p_;
+        }
+        length = static_cast<int>(p_ - text);
+        ++p_;
+        return true;
+    }
+
+    bool parseLiteral(const char* word)
+    {
+        const size_t length = std::strlen(word);
+        if (std::strncmp(p_, word, length) != 0) return false;
+        p_ += length;
+        return true;
+    }
+
+    bool pushLevel(const char* key, int keyLength, int index)
+    {
+        if (path_.depth >= JsonPath::kMaxDepth) return false;
+        path_.levels[path_.depth++] = { key, keyLength, index };
+        return true;
+    }
+
+    bool parseValue()
+    {
+        JsonScalar scalar;
+        switch (*p_)
+        {
+            case '{':
+            {
+                ++p_;
+                skipSpace();
+                while (*p_ != '}')
+                {
+                    const char* key;
+                    int keyLength;
+                    if (!parseString(key, keyLength)) return false;
+                    skipSpace();
+                    if (*p_++ != ':') return false;
+                    skipSpace();
+                    if (!pushLevel(key, keyLength, -1) || !parseValue()) return false;
+                    --path_.depth;
+                    skipSpace();
+                    if (*p_ == ',') { ++p_; skipSpace(); }   // Tolerates a trailing comma
+                    else if (*p_ != '}') return false;
+                }
+                ++p_;
+                return true;
+            }
+
+            case '[':
+            {
+                ++p_;
+                skipSpace();
+                for (int index = 0; *p_ != ']'; ++index)
+                {
+                    if (!pushLevel(nullptr, 0, index) || !parseValue()) return false;
+                    --path_.depth;
+                    skipSpace();
+                    if (*p_ == ',') { ++p_; skipSpace(); }
+                    else if (*p_ != ']') return false;
+                }
+                ++p_;
+                return true;
+            }
+
+            case '"':
+                scalar.type = JsonScalar::String;
+                if (!parseString(scalar.text, scalar.length)) return false;
+                break;
+
+            case 't':
+            case 'f':
+                scalar.type = JsonScalar::Bool;
+                scalar.boolean = *p_ == 't';
+                if (!parseLiteral(scalar.boolean ? "true" : "false")) return false;
+                break;
+
+            case 'n':
+                if (!parseLiteral("null")) return false;
+                break;
+
+            default:
+            {
+                char* end = nullptr;
+                scalar.type = JsonScalar::Number;
+                scalar.number = std::strtod(p_, &end);
+                if (end == p_) return false;
+                p_ = end;
+                break;
+            }
+        }
+
+        handler_(static_cast<const JsonPath&>(path_), static_cast<const JsonScalar&>(scalar));
+        return true;
+    }
+};
+
+template <typename Handler>
+static bool readJson(const char* json, Handler&& handler)
+{
+    JsonReader<Handler> reader(json, handler);
+    return reader.read();
+}
+
+//==============================================================================
+// Base Class Preset Interface
+//==============================================================================
+
+bool DrumMachinePureDSP::savePreset(char* jsonBuffer, int jsonBufferSize) const
+{
+    return savePresetEx(jsonBuffer, jsonBufferSize, PRESET_ALL);
+}
+
+bool DrumMachinePureDSP::loadPreset(const char* jsonData)
+{
+    return loadPresetEx(jsonData, PRESET_ALL);
+}
+
+//==============================================================================
+// Enhanced Preset System with Section Support
+//==============================================================================
+
+namespace
+{
+// Counts every byte; stores those that fit in a buffer, or hands them to a
+// sink in staged pieces. Fields are comma-separated as they are written,
+// and closing a field list drops the comma after its last field.
+class PresetJsonWriter
+{
+public:
+    PresetJsonWriter(char* buffer, int capacity) : buffer_(buffer), capacity_(buffer != nullptr ? capacity : 0) {}
+    explicit PresetJsonWriter(StateSink& sink) : sink_(&sink) {}
+
+    void text(const char* str)
+    {
+        if (pendingComma_) put(',');
+        pendingComma_ = false;
+        while (*str != '\0') put(*str++);
+    }
+
+    // Ends a field list: no comma after its last field
+    void close(const char* str)
+    {
+        pendingComma_ = false;
+        text(str);
+    }
+
+    void format(const char* fmt, ...)
+    {
+        char line[256];
+        va_list args;
+        va_start(args, fmt);
+        std::vsnprintf(line, sizeof(line), fmt, args);
+        va_end(args);
+        text(line);
+    }
+
+    void field(const char* name, double value)
+    {
+        format("\"%s\":%.6f", name, value);
+        pendingComma_ = true;
+    }
+
+    void field(const char* name, const char* value)
+    {
+        format("\"%s\":\"%s\"", name, value);
+        pendingComma_ = true;
+    }
+
+    // Terminates the buffer (or flushes the sink); false if the document
+    // did not fit or the sink stopped
+    bool finish()
+    {
+        if (sink_ != nullptr)
+        {
+            flush();
+            return ok_;
+        }
+        if (capacity_ > 0)
+            buffer_[std::min(size_, capacity_ - 1)] = '\0';
+        return size_ < capacity_;
+    }
+
+    int size() const { return size_; }
+
+private:
+    static constexpr int kStagingSize = 512;
+
+    void put(char c)
+    {
+        if (sink_ != nullptr)
+        {
+            staging_[pending_++] = c;
+            if (pending_ == kStagingSize) flush();
+        }
+        else if (size_ < capacity_)
+        {
+            buffer_[size_] = c;
+        }
+        ++size_;
+    }
+
+    void flush()
+    {
+        if (ok_ && pending_ > 0)
+            ok_ = sink_->write(staging_, pending_);
+        pending_ = 0;
+    }
+
+    char* buffer_ = nullptr;
+    int capacity_ = 0;
+    StateSink* sink_ = nullptr;
+    char staging_[kStagingSize];
+    int pending_ = 0;
+    int size_ = 0;
+    bool pendingComma_ = false;
+    bool ok_ = true;
+};
+
+void writePresetJson(PresetJsonWriter& out, const DecodedPreset& preset, int sections)
+{
+    out.text("{\n");
+
+    // Always write metadata and global parameters
+    out.field("version", "1.0.0");
+    out.field("name", "Drum Machine Preset");
+    out.field("author", "Schill Instruments");
+    out.field("category", "Uncategorized");
+    out.field("creationDate", "2025-01-07");
+
+    out.text("  \"parameters\": {\n");
+    for (DrumParam param : kPresetGlobalParams)
+        out.field(getDrumParamInfo(param).id, preset.params[static_cast<int>(param)]);
+    out.close("\n  },\n");
+
+    // Pattern section (rhythms)
+    if (sections & PRESET_PATTERN)
+    {
+        out.text("  \"pattern\": {\n");
+        out.text("    \"tracks\": [\n");
+
+        for (int trackIdx = 0; trackIdx < 16; ++trackIdx)
+        {
+            const Track& track = preset.pattern.tracks[trackIdx];
+
+            out.text("      {\n");
+            out.field("index", trackIdx);
+
+            // Drum type and timing role as strings
+            out.field("type", kDrumTypeNames[static_cast<int>(track.type)]);
+            out.field("timing_role", kTimingRoleNames[static_cast<int>(track.timingRole)]);
+
+            out.field("volume", track.volume);
+            out.field("pan", track.pan);
+            out.field("pitch", track.pitch);
+            if (track.length > 0)
+                out.field("length", track.length);
+
+            // Write steps: at least one bar, more for longer tracks
+            const int numSteps = std::max({ 16, track.length, track.steps.getLastStored() + 1 });
+            out.text("        \"steps\": [");
+
+            for (int stepIdx = 0; stepIdx < numSteps; ++stepIdx)
+            {
+                const StepCell& step = track.steps[stepIdx];
+                out.format("{\"active\":%s,\"velocity\":%d,\"probability\":%.3f,\"flam\":%s,\"roll\":%s,\"roll_notes\":%d}",
+                           step.active ? "true" : "false",
+                           step.velocity,
+                           step.probability,
+                           step.hasFlam ? "true" : "false",
+                           step.isRoll ? "true" : "false",
+                           step.rollNotes);
+
+                if (stepIdx < numSteps - 1)
+                    out.text(",");
+            }
+
+            out.text("]\n");
+            out.text(trackIdx < 15 ? "      }," : "      }\n");
+        }
+
+        out.text("    ]\n");
+        out.text("  },\n");
+    }
+
+    // Kit section (drum sounds)
+    if (sections & PRESET_KIT)
+    {
+        out.text("  \"kit\": {\n");
+        out.text("    \"voices\": {\n");
+
+        // One object per voice, fields in table order
+        const int numFields = static_cast<int>(sizeof(kVoiceParamFields) / sizeof(kVoiceParamFields[0]));
+        for (int field = 0; field < numFields; ++field)
+        {
+            const VoiceParamField& info = kVoiceParamFields[field];
+            const bool firstOfVoice = field == 0 || std::strcmp(kVoiceParamFields[field - 1].voice, info.voice) != 0;
+            const bool lastOfVoice = field == numFields - 1 || std::strcmp(kVoiceParamFields[field + 1].voice, info.voice) != 0;
+
+            if (firstOfVoice)
+                out.format("      \"%s\": {\n", info.voice);
+
+            out.field(info.key, preset.voices.*info.member);
+            if (lastOfVoice && std::strcmp(info.voice, "clap") == 0)
+                out.field("num_impulses", preset.voices.clapNumImpulses);
+
+            if (lastOfVoice)
+                out.close(field == numFields - 1 ? "\n      }\n" : "\n      },\n");
+        }
+
+        out.text("    }\n");
+        out.text("  }\n");
+    }
+
+    out.text("}");
+}
+} // namespace
+
+bool DrumMachinePureDSP::savePresetEx(char* jsonBuffer, int jsonBufferSize, int sections) const
+{
+    if (jsonBuffer == nullptr || jsonBufferSize <= 0) return false;
+
+    PresetJsonWriter out(jsonBuffer, jsonBufferSize);
+    writePresetJson(out, capturePreset(), sections);
+    return out.finish();
+}
+
+int DrumMachinePureDSP::getPresetSize(int sections) const
+{
+    PresetJsonWriter out(nullptr, 0);
+    writePresetJson(out, capturePreset(), sections);
+    return out.size() + 1;
+}
+
+bool DrumMachinePureDSP::savePreset(StateSink& sink, int sections) const
+{
+    PresetJsonWriter out(sink);
+    writePresetJson(out, capturePreset(), sections);
+    return out.finish();
+}
+
+bool DrumMachinePureDSP::loadPresetEx(const char* jsonData, int sections)
+{
+    // Start from the current state so sections or keys the document leaves
+    // out keep their values
+    DecodedPreset preset = capturePreset();
+    if (!decodePreset(jsonData, sections, preset)) return false;
+
+    // Pattern edits land with the next step, as they did before
+    applyPreset(preset, false);
+    return true;
+}
+
+bool DrumMachinePureDSP::decodePreset(const char* jsonData, int sections, DecodedPreset& preset)
+{
+    if (jsonData == nullptr) return false;
+
+    SequencerSnapshot& pattern = preset.pattern;
+    VoiceParams& voices = preset.voices;
+    bool patternChanged = false;
+    bool voicesChanged = false;
+
+    // One pass over the document, whatever its size or key count
+    const bool valid = readJson(jsonData, [&](const JsonPath& path, const JsonScalar& value)
+    {
+        if (path.depth == 2 && path.isKey(0, "parameters") && value.type == JsonScalar::Number)
+        {
+            // Globals, plus any other parameter by id or alias
+            char id[32];
+            if (!path.copyKey(1, id, sizeof(id))) return;
+            const DrumParam param = findDrumParam(id);
+            if (param == DrumParam::Count) return;
+            preset.setParameter(param, static_cast<float>(value.number));
+        }
+        else if ((sections & PRESET_PATTERN) && path.depth >= 4 && path.isKey(0, "pattern") && path.isKey(1, "tracks"))
+        {
+            const int trackIndex = path.levels[2].index;
+            if (trackIndex < 0 || trackIndex >= 16) return;
+            Track& track = pattern.tracks[trackIndex];
+            patternChanged = true;
+
+            if (path.depth == 4)
+            {
+                if (path.isKey(3, "type") && value.type == JsonScalar::String)
+                {
+                    for (int type = 0; type < kNumDrumTypes; ++type)
+                        if (value.equals(kDrumTypeNames[type])) track.type = static_cast<Track::DrumType>(type);
+                }
+                else if (path.isKey(3, "timing_role") && value.type == JsonScalar::String)
+                {
+                    for (int role = 0; role < 3; ++role)
+                        if (value.equals(kTimingRoleNames[role])) track.timingRole = static_cast<TimingRole>(role);
+                }
+                else if (path.isKey(3, "volume")) track.volume = value.asFloat(track.volume);
+                else if (path.isKey(3, "pan")) track.pan = std::max(-1.0f, std::min(1.0f, value.asFloat(track.pan)));
+                else if (path.isKey(3, "pitch")) track.pitch = value.asInt(track.pitch);
+                else if (path.isKey(3, "length"))
+                    track.length = std::max(0, std::min(TrackSteps::kMaxSteps, value.asInt(0)));
+            }
+            else if (path.depth == 6 && path.isKey(3, "steps"))
+            {
+                const int stepIndex = path.levels[4].index;
+                if (stepIndex < 0 || stepIndex >= TrackSteps::kMaxSteps) return;
+                StepCell& step = track.steps.edit(stepIndex);
+
+                if (path.isKey(5, "active")) step.active = value.asBool(step.active);
+                else if (path.isKey(5, "velocity"))
+                    step.velocity = static_cast<uint8_t>(std::max(0.0f, std::min(127.0f, value.asFloat(step.velocity))));
+                else if (path.isKey(5, "probability")) step.probability = value.asFloat(step.probability);
+                else if (path.isKey(5, "flam")) step.hasFlam = value.asBool(step.hasFlam);
+                else if (path.isKey(5, "roll")) step.isRoll = value.asBool(step.isRoll);
+                else if (path.isKey(5, "roll_notes")) step.rollNotes = value.asInt(step.rollNotes);
+            }
+        }
+        else if ((sections & PRESET_KIT) && path.depth == 4 && path.isKey(0, "kit") && path.isKey(1, "voices")
+                 && value.type == JsonScalar::Number)
+        {
+            if (path.isKey(2, "clap") && path.isKey(3, "num_impulses"))
+            {
+                voices.clapNumImpulses = value.asInt(voices.clapNumImpulses);
+                voicesChanged = true;
+                return;
+            }
+            for (const VoiceParamField& field : kVoiceParamFields)
+            {
+                if (path.isKey(2, field.voice) && path.isKey(3, field.key))
+                {
+                    voices.*field.member = static_cast<float>(value.number);
+                    voicesChanged = true;
+                    return;
+                }
+            }
+        }
+    });
+
+    if (!valid) return false;
+
+    if (patternChanged)
+    {
+        // Inactive default steps written out by the document take no memory
+        for (Track& track : pattern.tracks)
+            track.steps.compact();
+        pattern.parts |= SequencerSnapshot::Tracks;
+    }
+    if (voicesChanged) preset.hasVoices = true;
+    return preset.validate();
+}
+
+DecodedPreset DrumMachinePureDSP::capturePreset() const
+{
+    DecodedPreset preset;
+    for (int i = 0; i < kNumDrumParams; ++i)
+        preset.params[i] = getParameter(static_cast<DrumParam>(i));
 
-    return 0.0f;
+    for (int track = 0; track < 16; ++track)
+        preset.pattern.tracks[track] = sequencer_.getTrack(track);
+    preset.pattern.drillMode = sequencer_.getDrillMode();
+    preset.pattern.drillFillPolicy = sequencer_.getDrillFillPolicy();
+    preset.pattern.drillGatePolicy = sequencer_.getDrillGatePolicy();
+    preset.pattern.drillAutomation = sequencer_.getDrillAutomation();
+    preset.pattern.swingAutomation = sequencer_.getSwingAutomation();
+    preset.pattern.dillaAutomation = sequencer_.getDillaAutomation();
+    preset.voices = voiceParams_;
+
+    preset.outputBusLayout = static_cast<int8_t>(getOutputBusLayout());
+    for (int track = 0; track < 16; ++track)
+        preset.trackOutputBus[track] = trackOutputBus_[track].load(std::memory_order_relaxed);
+    return preset;
 }
 
-void DrumMachinePureDSP::setParameter(const char* paramId, float value)
+void DrumMachinePureDSP::applyPreset(const DecodedPreset& preset, bool atBar)
 {
-    // Get old value for logging (before change)
-    float oldValue = getParameter(paramId);
+    // Parameters reach the sequencer at the start of the next block
+    for (int i = 0; i < kNumDrumParams; ++i)
+        if (preset.paramMask & (uint64_t(1) << i)) setParameter(static_cast<DrumParam>(i), preset.params[i]);
 
-    if (std::strcmp(paramId, "tempo") == 0)
-    {
-        params_.tempo = value;
-        sequencer_.setTempo(value);
-    }
-    else if (std::strcmp(paramId, "swing") == 0)
-    {
-        params_.swing = value;
-        sequencer_.setSwing(value);
-    }
-    else if (std::strcmp(paramId, "master_volume") == 0)
-    {
-        params_.masterVolume = value;
-    }
-    else if (std::strcmp(paramId, "pattern_length") == 0)
-    {
-        params_.patternLength = value;
-        sequencer_.setPatternLength(static_cast<int>(value));
-    }
-    // Role timing parameters
-    else if (std::strcmp(paramId, "pocket_offset") == 0)
-    {
-        params_.pocketOffset = value;
-        RoleTimingParams params = sequencer_.getRoleTimingParams();
-        params.pocketOffset = value;
-        sequencer_.setRoleTimingParams(params);
-    }
-    else if (std::strcmp(paramId, "push_offset") == 0)
-    {
-        params_.pushOffset = value;
-        RoleTimingParams params = sequencer_.getRoleTimingParams();
-        params.pushOffset = value;
-        sequencer_.setRoleTimingParams(params);
-    }
-    else if (std::strcmp(paramId, "pull_offset") == 0)
+    if (preset.pattern.parts != 0)
     {
-        params_.pullOffset = value;
-        RoleTimingParams params = sequencer_.getRoleTimingParams();
-        params.pullOffset = value;
-        sequencer_.setRoleTimingParams(params);
+        // Copied into the sequencer's mailbox here, swapped in by the audio
+        // thread at the next bar or step
+        sequencer_.publishSnapshot(preset.pattern, atBar);
+        markDirty(PRESET_PATTERN);
     }
-    // Dilla parameters
-    else if (std::strcmp(paramId, "dilla_amount") == 0)
-    {
-        params_.dillaAmount = value;
-        DillaParams params = sequencer_.getDillaParams();
-        params.amount = value;
-        sequencer_.setDillaParams(params);
-    }
-    else if (std::strcmp(paramId, "dilla_hat_bias") == 0)
-    {
-        params_.dillaHatBias = value;
-        DillaParams params = sequencer_.getDillaParams();
-        params.hatBias = value;
-        sequencer_.setDillaParams(params);
-    }
-    else if (std::strcmp(paramId, "dilla_snare_late") == 0)
-    {
-        params_.dillaSnareLate = value;
-        DillaParams params = sequencer_.getDillaParams();
-        params.snareLate = value;
-        sequencer_.setDillaParams(params);
-    }
-    else if (std::strcmp(paramId, "dilla_kick_tight") == 0)
-    {
-        params_.dillaKickTight = value;
-        DillaParams params = sequencer_.getDillaParams();
-        params.kickTight = value;
-        sequencer_.setDillaParams(params);
-    }
-    else if (std::strcmp(paramId, "dilla_max_drift") == 0)
+
+    if (preset.hasVoices)
     {
-        params_.dillaMaxDrift = value;
-        DillaParams params = sequencer_.getDillaParams();
-        params.maxDrift = value;
-        sequencer_.setDillaParams(params);
+        voiceParams_ = preset.voices;
+        markDirty(PRESET_KIT);
+
+        // New kit: cached hits are stale until rebuilt
+        const uint32_t generation = kitGeneration_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (isHitCacheEnabled())
+            hitCache_.request(generation, sampleRate_);
     }
-    else
+
+    if (preset.outputBusLayout >= 0 && preset.outputBusLayout <= static_cast<int8_t>(OutputBusLayout::Custom))
     {
-        // Track volumes
-        for (int i = 0; i < 16; ++i)
+        for (int track = 0; track < 16; ++track)
         {
-            char name[32];
-            std::snprintf(name, sizeof(name), "track_%d_volume", i);
-            if (std::strcmp(paramId, name) == 0)
-            {
-                params_.trackVolumes[i] = value;
-                break;
-            }
+            const int bus = std::min<int>(preset.trackOutputBus[track], kMaxOutputBuses - 1);
+            trackOutputBus_[track].store(static_cast<uint8_t>(bus), std::memory_order_relaxed);
         }
+        setOutputBusLayout(static_cast<OutputBusLayout>(preset.outputBusLayout));
     }
-
-    // Log parameter change (shared telemetry infrastructure)
-    LOG_PARAMETER_CHANGE("DrumMachine", paramId, oldValue, value);
 }
 
 //==============================================================================
-// Base Class Preset Interface
+// Decoded Preset
 //==============================================================================
 
-bool DrumMachinePureDSP::savePreset(char* jsonBuffer, int jsonBufferSize) const
+DecodedPreset::DecodedPreset()
 {
-    return savePresetEx(jsonBuffer, jsonBufferSize, PRESET_ALL);
+    for (int i = 0; i < kNumDrumParams; ++i)
+        params[i] = getDrumParamInfo(static_cast<DrumParam>(i)).defaultValue;
+    pattern.parts = 0;
 }
 
-bool DrumMachinePureDSP::loadPreset(const char* jsonData)
+void DecodedPreset::setParameter(DrumParam param, float value)
 {
-    return loadPresetEx(jsonData, PRESET_ALL);
+    params[static_cast<int>(param)] = value;
+    paramMask |= uint64_t(1) << static_cast<int>(param);
 }
 
-//==============================================================================
-// Enhanced Preset System with Section Support
-//==============================================================================
-
-bool DrumMachinePureDSP::savePresetEx(char* jsonBuffer, int jsonBufferSize, int sections) const
+void DecodedPreset::setDrill(const IdmMacroPreset& macro)
 {
-    int offset = 0;
+    macro.applyTo(pattern.drillMode, pattern.drillFillPolicy, pattern.drillGatePolicy);
+    pattern.parts |= SequencerSnapshot::Drill;
+}
 
-    // Write opening brace
-    std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "{\n");
-    offset = 2;
+namespace
+{
+constexpr int kMaxRollNotes = 16;
+constexpr int kMaxBurstHits = 16;
+constexpr int kMaxPitchOffset = 48;
+constexpr int kMaxClapImpulses = 8;
 
-    // Always write metadata and global parameters
-    writeJsonString("version", "1.0.0", jsonBuffer, offset, jsonBufferSize);
-    writeJsonString("name", "Drum Machine Preset", jsonBuffer, offset, jsonBufferSize);
-    writeJsonString("author", "Schill Instruments", jsonBuffer, offset, jsonBufferSize);
-    writeJsonString("category", "Uncategorized", jsonBuffer, offset, jsonBufferSize);
-    writeJsonString("creationDate", "2025-01-07", jsonBuffer, offset, jsonBufferSize);
-
-    // Global parameters (always saved)
-    std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "  \"parameters\": {\n");
-    offset += std::strlen(jsonBuffer + offset);
-
-    writeJsonParameter("tempo", params_.tempo, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("swing", params_.swing, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("master_volume", params_.masterVolume, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("pattern_length", params_.patternLength, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("pocket_offset", params_.pocketOffset, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("push_offset", params_.pushOffset, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("pull_offset", params_.pullOffset, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("dilla_amount", params_.dillaAmount, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("dilla_hat_bias", params_.dillaHatBias, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("dilla_snare_late", params_.dillaSnareLate, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("dilla_kick_tight", params_.dillaKickTight, jsonBuffer, offset, jsonBufferSize);
-    writeJsonParameter("dilla_max_drift", params_.dillaMaxDrift, jsonBuffer, offset, jsonBufferSize);
-
-    // Remove trailing comma
-    if (offset > 2 && jsonBuffer[offset - 1] == ',') offset--;
-    std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n  },\n");
-    offset += std::strlen(jsonBuffer + offset);
+bool isFinite(float value) { return std::isfinite(value); }
 
-    // Pattern section (rhythms)
-    if (sections & PRESET_PATTERN)
-    {
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "  \"pattern\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
+int clampCount(int value, int lo, int hi) { return std::max(lo, std::min(hi, value)); }
 
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "    \"tracks\": [\n");
-        offset += std::strlen(jsonBuffer + offset);
+bool validateDrill(DrillMode& drill)
+{
+    if (static_cast<int>(drill.grid) > static_cast<int>(DrillGrid::RandomPrime)) return false;
+    for (float value : { drill.amount, drill.mutationRate, drill.dropout, drill.chaos, drill.spread,
+                         drill.velDecay, drill.accentFlip, drill.temporalAggression, drill.transitionBeats })
+        if (!isFinite(value)) return false;
 
-        for (int trackIdx = 0; trackIdx < 16; ++trackIdx)
-        {
-            const Track& track = sequencer_.getTrack(trackIdx);
+    drill.minBurst = clampCount(drill.minBurst, 1, kMaxBurstHits);
+    drill.maxBurst = clampCount(drill.maxBurst, 1, kMaxBurstHits);
+    return true;
+}
 
-            std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      {\n");
-            offset += std::strlen(jsonBuffer + offset);
+bool validateLane(BarAutomationLane& lane)
+{
+    for (BarAutomationPoint& point : lane.points)
+    {
+        if (!isFinite(point.amount)) return false;
+        point.amount = std::max(0.0f, std::min(1.0f, point.amount));
+    }
+    return true;
+}
 
-            writeJsonParameter("index", trackIdx, jsonBuffer, offset, jsonBufferSize);
+bool validateStep(StepCell& step)
+{
+    if (static_cast<int>(step.drillIntent) > static_cast<int>(DrillIntent::Emphasize)) return false;
+    for (float value : { step.probability, step.timingOffset, step.burstChaos, step.burstDropout })
+        if (!isFinite(value)) return false;
 
-            // Write drum type as string
-            const char* drumType = "Kick";
-            switch (track.type)
-            {
-                case Track::DrumType::Kick: drumType = "Kick"; break;
-                case Track::DrumType::Snare: drumType = "Snare"; break;
-                case Track::DrumType::HiHatClosed: drumType = "HiHatClosed"; break;
-                case Track::DrumType::HiHatOpen: drumType = "HiHatOpen"; break;
-                case Track::DrumType::Clap: drumType = "Clap"; break;
-                case Track::DrumType::TomLow: drumType = "TomLow"; break;
-                case Track::DrumType::TomMid: drumType = "TomMid"; break;
-                case Track::DrumType::TomHigh: drumType = "TomHigh"; break;
-                case Track::DrumType::Crash: drumType = "Crash"; break;
-                case Track::DrumType::Ride: drumType = "Ride"; break;
-                case Track::DrumType::Cowbell: drumType = "Cowbell"; break;
-                case Track::DrumType::Shaker: drumType = "Shaker"; break;
-                case Track::DrumType::Tambourine: drumType = "Tambourine"; break;
-                case Track::DrumType::Percussion: drumType = "Percussion"; break;
-                case Track::DrumType::Special: drumType = "Special"; break;
-            }
-            writeJsonString("type", drumType, jsonBuffer, offset, jsonBufferSize);
+    step.velocity = std::min<uint8_t>(step.velocity, 127);
+    step.rollNotes = clampCount(step.rollNotes, 1, kMaxRollNotes);
+    step.burstCount = clampCount(step.burstCount, 1, kMaxBurstHits);
+    return true;
+}
 
-            // Write timing role
-            const char* timingRole = "Pocket";
-            switch (track.timingRole)
-            {
-                case TimingRole::Pocket: timingRole = "Pocket"; break;
-                case TimingRole::Push: timingRole = "Push"; break;
-                case TimingRole::Pull: timingRole = "Pull"; break;
-            }
-            writeJsonString("timing_role", timingRole, jsonBuffer, offset, jsonBufferSize);
+bool validateTrack(Track& track)
+{
+    const int type = static_cast<int>(track.type);
+    const int role = static_cast<int>(track.timingRole);
+    if (type < 0 || type >= kNumDrumVoiceTypes || role < 0 || role > static_cast<int>(TimingRole::Pull))
+        return false;
+    if (!isFinite(track.volume) || !isFinite(track.pan)) return false;
 
-            writeJsonParameter("volume", track.volume, jsonBuffer, offset, jsonBufferSize);
-            writeJsonParameter("pan", track.pan, jsonBuffer, offset, jsonBufferSize);
-            writeJsonParameter("pitch", track.pitch, jsonBuffer, offset, jsonBufferSize);
+    track.pitch = clampCount(track.pitch, -kMaxPitchOffset, kMaxPitchOffset);
+    track.length = clampCount(track.length, 0, TrackSteps::kMaxSteps);  // 0: the pattern length
+    if (track.drillOverride.useOverride && !validateDrill(track.drillOverride.drill)) return false;
 
-            // Write steps
-            std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "        \"steps\": [");
-            offset += std::strlen(jsonBuffer + offset);
+    bool valid = true;
+    track.steps.forEachStored([&](int, StepCell& step) { valid = valid && validateStep(step); });
+    return valid;
+}
+} // namespace
 
-            for (int stepIdx = 0; stepIdx < 16; ++stepIdx)
-            {
-                const StepCell& step = track.steps[stepIdx];
+bool DecodedPreset::validate()
+{
+    for (float value : params)
+        if (!isFinite(value)) return false;
 
-                std::snprintf(jsonBuffer + offset, jsonBufferSize - offset,
-                    "{\"active\":%s,\"velocity\":%d,\"probability\":%.3f,\"flam\":%s,\"roll\":%s,\"roll_notes\":%d}",
-                    step.active ? "true" : "false",
-                    step.velocity,
-                    step.probability,
-                    step.hasFlam ? "true" : "false",
-                    step.isRoll ? "true" : "false",
-                    step.rollNotes);
+    if (pattern.parts & SequencerSnapshot::Tracks)
+    {
+        for (Track& track : pattern.tracks)
+            if (!validateTrack(track)) return false;
+    }
 
-                offset += std::strlen(jsonBuffer + offset);
+    if (pattern.parts & SequencerSnapshot::Drill)
+    {
+        DrillFillPolicy& fill = pattern.drillFillPolicy;
+        DrillGatePolicy& gate = pattern.drillGatePolicy;
+        if (!validateDrill(pattern.drillMode) || !validateLane(pattern.drillAutomation)) return false;
+        for (float value : { fill.triggerChance, fill.fillAmount, fill.decayPerStep, gate.silenceChance, gate.burstChance })
+            if (!isFinite(value)) return false;
+
+        fill.fillLengthSteps = clampCount(fill.fillLengthSteps, 0, 16);
+        gate.minSilentSteps = clampCount(gate.minSilentSteps, 0, 16);
+        gate.maxSilentSteps = clampCount(gate.maxSilentSteps, gate.minSilentSteps, 16);
+    }
 
-                if (stepIdx < 15)
-                {
-                    std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, ",");
-                    offset++;
-                }
-            }
+    if ((pattern.parts & SequencerSnapshot::Groove)
+        && (!validateLane(pattern.swingAutomation) || !validateLane(pattern.dillaAutomation)))
+        return false;
 
-            std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "]\n");
-            offset += std::strlen(jsonBuffer + offset);
+    if (hasVoices)
+    {
+        for (const VoiceParamField& field : kVoiceParamFields)
+            if (!isFinite(voices.*field.member)) return false;
+        voices.clapNumImpulses = clampCount(voices.clapNumImpulses, 1, kMaxClapImpulses);
+    }
+    return true;
+}
 
-            // Remove trailing comma before closing track
-            if (offset > 2 && jsonBuffer[offset - 2] == ',') offset -= 2;
+size_t DecodedPreset::getMemoryUsage() const
+{
+    const size_t automationPoints = pattern.drillAutomation.points.capacity()
+        + pattern.swingAutomation.points.capacity() + pattern.dillaAutomation.points.capacity();
+    size_t bytes = sizeof(DecodedPreset) + automationPoints * sizeof(BarAutomationPoint);
+    for (const Track& track : pattern.tracks)
+        bytes += static_cast<size_t>(track.steps.getNumStored()) * sizeof(StepCell);
+    return bytes;
+}
 
-            std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      }");
-            offset += std::strlen(jsonBuffer + offset);
+bool DrumMachinePureDSP::savePattern(char* jsonBuffer, int jsonBufferSize) const
+{
+    return savePresetEx(jsonBuffer, jsonBufferSize, PRESET_PATTERN);
+}
 
-            if (trackIdx < 15)
-            {
-                std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, ",\n");
-                offset++;
-            }
-            else
-            {
-                std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n");
-                offset++;
-            }
-        }
+bool DrumMachinePureDSP::loadPattern(const char* jsonData)
+{
+    return loadPresetEx(jsonData, PRESET_PATTERN);
+}
 
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "    ]\n");
-        offset += std::strlen(jsonBuffer + offset);
+bool DrumMachinePureDSP::saveKit(char* jsonBuffer, int jsonBufferSize) const
+{
+    return savePresetEx(jsonBuffer, jsonBufferSize, PRESET_KIT);
+}
 
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "  },\n");
-        offset += std::strlen(jsonBuffer + offset);
-    }
+bool DrumMachinePureDSP::loadKit(const char* jsonData)
+{
+    return loadPresetEx(jsonData, PRESET_KIT);
+}
 
-    // Kit section (drum sounds)
-    if (sections & PRESET_KIT)
-    {
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "  \"kit\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "    \"voices\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Kick
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"kick\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.kickPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.kickDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("click", voiceParams_.kickClick, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Snare
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"snare\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.snareTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.snareDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("snap", voiceParams_.snareSnap, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // HiHat Closed
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"hihat_closed\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.hihatClosedTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.hihatClosedDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.hihatClosedMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // HiHat Open
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"hihat_open\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.hihatOpenTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.hihatOpenDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.hihatOpenMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Clap
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"clap\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.clapTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.clapDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("num_impulses", voiceParams_.clapNumImpulses, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Tom Low
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"tom_low\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.tomLowPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.tomLowDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("tone", voiceParams_.tomLowTone, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Tom Mid
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"tom_mid\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.tomMidPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.tomMidDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("tone", voiceParams_.tomMidTone, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Tom High
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"tom_high\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.tomHighPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.tomHighDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("tone", voiceParams_.tomHighTone, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Crash
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"crash\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.crashTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.crashDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.crashMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Ride
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"ride\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.rideTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.rideDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.rideMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Cowbell
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"cowbell\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.cowbellPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.cowbellDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("tone", voiceParams_.cowbellTone, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Shaker
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"shaker\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.shakerTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.shakerDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.shakerMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Tambourine
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"tambourine\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.tambourineTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.tambourineDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("metallic", voiceParams_.tambourineMetallic, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Percussion
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"percussion\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("pitch", voiceParams_.percussionPitch, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.percussionDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("tone", voiceParams_.percussionTone, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      },\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        // Special
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "      \"special\": {\n");
-        offset += std::strlen(jsonBuffer + offset);
-        writeJsonParameter("tone", voiceParams_.specialTone, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("decay", voiceParams_.specialDecay, jsonBuffer, offset, jsonBufferSize);
-        writeJsonParameter("snap", voiceParams_.specialSnap, jsonBuffer, offset, jsonBufferSize);
-        if (jsonBuffer[offset - 1] == ',') offset--;
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "\n      }\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "    }\n");
-        offset += std::strlen(jsonBuffer + offset);
-
-        std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "  }\n");
-        offset += std::strlen(jsonBuffer + offset);
-    }
-
-    // Closing brace
-    std::snprintf(jsonBuffer + offset, jsonBufferSize - offset, "}");
+//==============================================================================
+// Binary State (host sessions)
+//==============================================================================
 
-    return true;
+// Layout: "DRMS" magic, u16 version, u16 reserved, then chunks of
+// { u32 fourcc, u32 length, payload }. All values little-endian. Readers skip
+// unknown chunks and keep defaults for fields a short (older) payload lacks,
+// so chunks can grow by appending fields.
+namespace
+{
+constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+{
+    return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
 }
 
-bool DrumMachinePureDSP::loadPresetEx(const char* jsonData, int sections)
+constexpr uint32_t kStateMagic = makeFourCC('D', 'R', 'M', 'S');
+constexpr uint16_t kStateVersion = 1;
+constexpr uint32_t kChunkParams = makeFourCC('P', 'A', 'R', 'M');
+constexpr uint32_t kChunkDensePattern = makeFourCC('P', 'A', 'T', 'N');  // Read only
+constexpr uint32_t kChunkPattern = makeFourCC('P', 'T', 'N', '2');
+constexpr uint32_t kChunkDrill = makeFourCC('D', 'R', 'I', 'L');
+constexpr uint32_t kChunkGroove = makeFourCC('G', 'R', 'O', 'V');
+constexpr uint32_t kChunkVoices = makeFourCC('V', 'O', 'I', 'C');
+constexpr uint32_t kChunkOutputs = makeFourCC('O', 'U', 'T', 'S');
+constexpr int kMaxStateAutomationPoints = 1024;
+
+// Counts every byte; stores those that fit in a buffer, or hands them to a
+// sink in staged pieces
+class StateWriter
 {
-    (void)sections;  // Ignore sections parameter for now
-    double value;
+public:
+    StateWriter(uint8_t* buffer, int capacity) : buffer_(buffer), capacity_(buffer != nullptr ? capacity : 0) {}
+    explicit StateWriter(StateSink& sink) : sink_(&sink) {}
+
+    static constexpr bool kLoading = false;
+
+    void raw(uint32_t value, int numBytes)
+    {
+        // Common case: the whole value fits where it goes
+        uint8_t* dest = sink_ != nullptr ? (pending_ + numBytes <= kStagingSize ? staging_ + pending_ : nullptr)
+                                         : (size_ + numBytes <= capacity_ ? buffer_ + size_ : nullptr);
+        if (dest == nullptr)
+        {
+            for (int i = 0; i < numBytes; ++i)
+                put(static_cast<uint8_t>(value >> (8 * i)));
+            return;
+        }
+
+        for (int i = 0; i < numBytes; ++i)
+            dest[i] = static_cast<uint8_t>(value >> (8 * i));
+        size_ += numBytes;
+        if (sink_ != nullptr) pending_ += numBytes;
+    }
 
-    if (parseJsonParameter(jsonData, "tempo", value))
+    // { fourcc, length, payload }. A buffer gets the length patched in
+    // afterwards; a stream measures the payload first.
+    template <typename Fn>
+    void chunk(uint32_t fourcc, Fn&& writePayload)
     {
-        params_.tempo = static_cast<float>(value);
-        sequencer_.setTempo(params_.tempo);
+        raw(fourcc, 4);
+        if (sink_ == nullptr)
+        {
+            const int start = size_ + 4;
+            raw(0, 4);
+            writePayload(*this);
+            const uint32_t length = static_cast<uint32_t>(size_ - start);
+            for (int i = 0; i < 4; ++i)
+                if (start - 4 + i < capacity_) buffer_[start - 4 + i] = static_cast<uint8_t>(length >> (8 * i));
+            return;
+        }
+
+        StateWriter measure(nullptr, 0);
+        writePayload(measure);
+        raw(static_cast<uint32_t>(measure.size()), 4);
+        writePayload(*this);
     }
-    if (parseJsonParameter(jsonData, "swing", value))
+
+    void io(uint8_t& v) { raw(v, 1); }
+    void io(bool& v) { raw(v ? 1 : 0, 1); }
+    void io(int& v) { raw(static_cast<uint32_t>(v), 4); }
+    void io(uint32_t& v) { raw(v, 4); }
+    void io(float& v)
     {
-        params_.swing = static_cast<float>(value);
-        sequencer_.setSwing(params_.swing);
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        raw(bits, 4);
     }
-    if (parseJsonParameter(jsonData, "master_volume", value))
-        params_.masterVolume = static_cast<float>(value);
-    if (parseJsonParameter(jsonData, "pattern_length", value))
+    template <typename E>
+    void ioEnum(E& v) { raw(static_cast<uint8_t>(v), 1); }
+
+    // Flushes a sink; false if it stopped the save
+    bool finish()
     {
-        params_.patternLength = static_cast<float>(value);
-        sequencer_.setPatternLength(static_cast<int>(params_.patternLength));
+        if (sink_ != nullptr && ok_ && pending_ > 0)
+            ok_ = sink_->write(staging_, pending_);
+        pending_ = 0;
+        return ok_;
     }
 
-    // Role timing parameters
-    RoleTimingParams roleParams = sequencer_.getRoleTimingParams();
-    if (parseJsonParameter(jsonData, "pocket_offset", value))
+    int size() const { return size_; }
+
+private:
+    static constexpr int kStagingSize = 512;
+
+    void put(uint8_t byte)
     {
-        params_.pocketOffset = static_cast<float>(value);
-        roleParams.pocketOffset = params_.pocketOffset;
+        if (sink_ != nullptr)
+        {
+            if (pending_ >= kStagingSize) finish();
+            staging_[pending_++] = byte;
+        }
+        else if (size_ < capacity_)
+        {
+            buffer_[size_] = byte;
+        }
+        ++size_;
     }
-    if (parseJsonParameter(jsonData, "push_offset", value))
+
+    uint8_t* buffer_ = nullptr;
+    int capacity_ = 0;
+    StateSink* sink_ = nullptr;
+    uint8_t staging_[kStagingSize];
+    int pending_ = 0;
+    int size_ = 0;
+    bool ok_ = true;
+};
+
+// Reads until the data runs out; later fields then keep their values
+class StateReader
+{
+public:
+    StateReader(const uint8_t* data, int size) : p_(data), end_(data + size) {}
+
+    static constexpr bool kLoading = true;
+
+    bool raw(uint32_t& value, int numBytes)
     {
-        params_.pushOffset = static_cast<float>(value);
-        roleParams.pushOffset = params_.pushOffset;
+        if (end_ - p_ < numBytes) { p_ = end_; return false; }
+        value = 0;
+        for (int i = 0; i < numBytes; ++i)
+            value |= uint32_t(*p_++) << (8 * i);
+        return true;
     }
-    if (parseJsonParameter(jsonData, "pull_offset", value))
+
+    // Splits off the next chunk's payload
+    bool nextChunk(uint32_t& fourcc, StateReader& payload)
     {
-        params_.pullOffset = static_cast<float>(value);
-        roleParams.pullOffset = params_.pullOffset;
+        uint32_t length = 0;
+        if (!raw(fourcc, 4) || !raw(length, 4) || static_cast<uint32_t>(end_ - p_) < length) return false;
+        payload = StateReader(p_, static_cast<int>(length));
+        p_ += length;
+        return true;
     }
-    sequencer_.setRoleTimingParams(roleParams);
 
-    // Dilla parameters
-    DillaParams dillaParams = sequencer_.getDillaParams();
-    if (parseJsonParameter(jsonData, "dilla_amount", value))
+    void io(uint8_t& v) { uint32_t x; if (raw(x, 1)) v = static_cast<uint8_t>(x); }
+    void io(bool& v) { uint32_t x; if (raw(x, 1)) v = x != 0; }
+    void io(int& v) { uint32_t x; if (raw(x, 4)) v = static_cast<int>(x); }
+    void io(uint32_t& v) { uint32_t x; if (raw(x, 4)) v = x; }
+    void io(float& v)
     {
-        params_.dillaAmount = static_cast<float>(value);
-        dillaParams.amount = params_.dillaAmount;
+        uint32_t bits;
+        if (raw(bits, 4)) std::memcpy(&v, &bits, sizeof(v));
     }
-    if (parseJsonParameter(jsonData, "dilla_hat_bias", value))
+    template <typename E>
+    void ioEnum(E& v) { uint32_t x; if (raw(x, 1)) v = static_cast<E>(x); }
+
+    bool atEnd() const { return p_ == end_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+// One field list per struct, shared by save and load
+template <typename Archive>
+void serialize(Archive& ar, DrillMode& d)
+{
+    ar.io(d.enabled);
+    ar.io(d.amount);
+    ar.io(d.mutationRate);
+    ar.io(d.dropout);
+    ar.io(d.chaos);
+    ar.io(d.spread);
+    ar.io(d.velDecay);
+    ar.io(d.accentFlip);
+    ar.io(d.temporalAggression);
+    ar.io(d.minBurst);
+    ar.io(d.maxBurst);
+    ar.ioEnum(d.grid);
+    ar.io(d.transitionBeats);
+}
+
+template <typename Archive>
+void serialize(Archive& ar, StepCell& step)
+{
+    ar.io(step.active);
+    ar.io(step.velocity);
+    ar.io(step.probability);
+    ar.io(step.hasFlam);
+    ar.io(step.isRoll);
+    ar.io(step.rollNotes);
+    ar.io(step.useDrill);
+    ar.io(step.burstCount);
+    ar.io(step.burstChaos);
+    ar.io(step.burstDropout);
+    ar.ioEnum(step.drillIntent);
+}
+
+// Track fields shared by both pattern chunk layouts
+template <typename Archive>
+void serializeTrackHeader(Archive& ar, Track& track)
+{
+    ar.ioEnum(track.type);
+    ar.ioEnum(track.timingRole);
+    ar.io(track.volume);
+    ar.io(track.pan);
+    ar.io(track.pitch);
+    ar.io(track.drillOverride.useOverride);
+    serialize(ar, track.drillOverride.drill);
+}
+
+// PATN (first layout): 16 steps, all written
+void readDenseTrack(StateReader& ar, Track& track)
+{
+    serializeTrackHeader(ar, track);
+    for (int step = 0; step < 16; ++step)
     {
-        params_.dillaHatBias = static_cast<float>(value);
-        dillaParams.hatBias = params_.dillaHatBias;
+        StepCell cell = track.steps[step];
+        serialize(ar, cell);
+        if (TrackSteps::isDefault(cell))
+            track.steps.erase(step);
+        else
+            track.steps.edit(step) = cell;
     }
-    if (parseJsonParameter(jsonData, "dilla_snare_late", value))
+}
+
+// PTN2: own length, then only the stored steps
+template <typename Archive>
+void serialize(Archive& ar, Track& track)
+{
+    serializeTrackHeader(ar, track);
+    ar.io(track.length);
+
+    uint32_t numSteps = static_cast<uint32_t>(track.steps.getNumStored());
+    ar.io(numSteps);
+
+    if (Archive::kLoading)
     {
-        params_.dillaSnareLate = static_cast<float>(value);
-        dillaParams.snareLate = params_.dillaSnareLate;
+        track.steps.clear();
+        for (uint32_t i = 0; i < numSteps && i < static_cast<uint32_t>(TrackSteps::kMaxSteps); ++i)
+        {
+            uint8_t step = 0;
+            StepCell cell;
+            ar.io(step);
+            serialize(ar, cell);
+            if (step < TrackSteps::kMaxSteps)
+                track.steps.edit(step) = cell;
+        }
     }
-    if (parseJsonParameter(jsonData, "dilla_kick_tight", value))
+    else
     {
-        params_.dillaKickTight = static_cast<float>(value);
-        dillaParams.kickTight = params_.dillaKickTight;
+        track.steps.forEachStored([&](int stepIndex, const StepCell& stored)
+        {
+            uint8_t step = static_cast<uint8_t>(stepIndex);
+            StepCell cell = stored;
+            ar.io(step);
+            serialize(ar, cell);
+        });
     }
-    if (parseJsonParameter(jsonData, "dilla_max_drift", value))
+}
+
+template <typename Archive>
+void serialize(Archive& ar, BarAutomationLane& lane)
+{
+    std::vector<BarAutomationPoint>& points = lane.points;
+    uint32_t numPoints = static_cast<uint32_t>(points.size());
+    ar.io(numPoints);
+    if (Archive::kLoading)
+        points.resize(std::min<uint32_t>(numPoints, kMaxStateAutomationPoints));
+    for (BarAutomationPoint& point : points)
     {
-        params_.dillaMaxDrift = static_cast<float>(value);
-        dillaParams.maxDrift = params_.dillaMaxDrift;
+        ar.io(point.bar);
+        ar.io(point.amount);
     }
-    sequencer_.setDillaParams(dillaParams);
+    if (Archive::kLoading)
+        lane.sortPoints();
+}
 
-    return true;
+template <typename Archive>
+void serialize(Archive& ar, SequencerSnapshot& s)
+{
+    serialize(ar, s.drillMode);
+
+    DrillFillPolicy& fill = s.drillFillPolicy;
+    ar.io(fill.enabled);
+    ar.io(fill.fillLengthSteps);
+    ar.io(fill.triggerChance);
+    ar.io(fill.fillAmount);
+    ar.io(fill.decayPerStep);
+
+    DrillGatePolicy& gate = s.drillGatePolicy;
+    ar.io(gate.enabled);
+    ar.io(gate.silenceChance);
+    ar.io(gate.burstChance);
+    ar.io(gate.minSilentSteps);
+    ar.io(gate.maxSilentSteps);
+
+    serialize(ar, s.drillAutomation);
 }
 
-int DrumMachinePureDSP::getActiveVoiceCount() const
+template <typename Archive>
+void serialize(Archive& ar, VoiceParams& voices)
 {
-    // Check if any drum voices are actively playing
-    return sequencer_.hasActiveVoices() ? 1 : 0;
+    for (const VoiceParamField& field : kVoiceParamFields)
+        ar.io(voices.*field.member);
+    ar.io(voices.clapNumImpulses);
 }
 
-bool DrumMachinePureDSP::writeJsonParameter(const char* name, double value,
-                                              char* buffer, int& offset,
-                                              int bufferSize) const
+// Chunks per section: parameters and output routing are global, the
+// pattern carries drill and groove, the kit is the voice parameters
+void writeState(StateWriter& out, DecodedPreset& preset, int sections)
 {
-    int remaining = bufferSize - offset;
-    if (remaining < 50) return false;
+    out.raw(kStateMagic, 4);
+    out.raw(kStateVersion, 2);
+    out.raw(0, 2);
 
-    int written = std::snprintf(buffer + offset, remaining,
-                               "\"%s\":%.6f,",
-                               name, value);
+    if (sections & PRESET_GLOBAL)
+    {
+        out.chunk(kChunkParams, [&](StateWriter& ar)
+        {
+            uint32_t numParams = kNumDrumParams;
+            ar.io(numParams);
+            for (float& value : preset.params)
+                ar.io(value);
+        });
+    }
 
-    if (written < 0 || written >= remaining) return false;
+    if (sections & PRESET_PATTERN)
+    {
+        out.chunk(kChunkPattern, [&](StateWriter& ar)
+        {
+            for (Track& track : preset.pattern.tracks)
+                serialize(ar, track);
+        });
+        out.chunk(kChunkDrill, [&](StateWriter& ar) { serialize(ar, preset.pattern); });
+        out.chunk(kChunkGroove, [&](StateWriter& ar)
+        {
+            serialize(ar, preset.pattern.swingAutomation);
+            serialize(ar, preset.pattern.dillaAutomation);
+        });
+    }
 
-    offset += written;
-    return true;
+    if (sections & PRESET_KIT)
+        out.chunk(kChunkVoices, [&](StateWriter& ar) { serialize(ar, preset.voices); });
+
+    if (sections & PRESET_GLOBAL)
+    {
+        out.chunk(kChunkOutputs, [&](StateWriter& ar)
+        {
+            uint8_t layout = static_cast<uint8_t>(preset.outputBusLayout);
+            ar.io(layout);
+            for (uint8_t& bus : preset.trackOutputBus)
+                ar.io(bus);
+        });
+    }
 }
+} // namespace
 
-bool DrumMachinePureDSP::writeJsonString(const char* name, const char* value,
-                                         char* buffer, int& offset,
-                                         int bufferSize) const
+int DrumMachinePureDSP::saveState(uint8_t* buffer, int bufferSize, int sections) const
 {
-    int remaining = bufferSize - offset;
-    if (remaining < 50) return false;
+    DecodedPreset preset = capturePreset();
+    StateWriter out(buffer, bufferSize);
+    writeState(out, preset, sections);
+    return out.size();
+}
 
-    int written = std::snprintf(buffer + offset, remaining,
-                               "\"%s\":\"%s\",",
-                               name, value);
+bool DrumMachinePureDSP::saveState(StateSink& sink, int sections) const
+{
+    DecodedPreset preset = capturePreset();
+    StateWriter out(sink);
+    writeState(out, preset, sections);
+    return out.finish();
+}
 
-    if (written < 0 || written >= remaining) return false;
+bool DrumMachinePureDSP::loadState(const uint8_t* data, int size)
+{
+    DecodedPreset preset = capturePreset();
+    if (!decodeState(data, size, preset)) return false;
 
-    offset += written;
+    applyPreset(preset, false);
     return true;
 }
 
-bool DrumMachinePureDSP::parseJsonParameter(const char* json, const char* param,
-                                              double& value) const
+bool DrumMachinePureDSP::decodeState(const uint8_t* data, int size, DecodedPreset& preset)
 {
-    const char* search = json;
-    char pattern[100];
-    std::snprintf(pattern, sizeof(pattern), "\"%s\":", param);
+    if (data == nullptr || size < 8) return false;
+
+    StateReader in(data, size);
+    uint32_t magic = 0, version = 0, reserved = 0;
+    in.raw(magic, 4);
+    in.raw(version, 2);
+    in.raw(reserved, 2);
+    if (magic != kStateMagic || version == 0 || version > kStateVersion) return false;
+
+    uint32_t fourcc = 0;
+    StateReader chunk(nullptr, 0);
+    while (!in.atEnd())
+    {
+        if (!in.nextChunk(fourcc, chunk)) return false;
 
-    const char* found = std::strstr(search, pattern);
-    if (!found) return false;
+        if (fourcc == kChunkParams)
+        {
+            uint32_t numParams = 0;
+            chunk.io(numParams);
+            for (uint32_t i = 0; i < numParams && i < static_cast<uint32_t>(kNumDrumParams); ++i)
+            {
+                float value = preset.params[i];
+                chunk.io(value);
+                preset.setParameter(static_cast<DrumParam>(i), value);
+            }
+        }
+        else if (fourcc == kChunkDensePattern)
+        {
+            for (Track& track : preset.pattern.tracks)
+                readDenseTrack(chunk, track);
+            preset.pattern.parts |= SequencerSnapshot::Tracks;
+        }
+        else if (fourcc == kChunkPattern)
+        {
+            for (Track& track : preset.pattern.tracks)
+                serialize(chunk, track);
+            preset.pattern.parts |= SequencerSnapshot::Tracks;
+        }
+        else if (fourcc == kChunkDrill)
+        {
+            serialize(chunk, preset.pattern);
+            preset.pattern.parts |= SequencerSnapshot::Drill;
+        }
+        else if (fourcc == kChunkGroove)
+        {
+            serialize(chunk, preset.pattern.swingAutomation);
+            serialize(chunk, preset.pattern.dillaAutomation);
+            preset.pattern.parts |= SequencerSnapshot::Groove;
+        }
+        else if (fourcc == kChunkVoices)
+        {
+            serialize(chunk, preset.voices);
+            preset.hasVoices = true;
+        }
+        else if (fourcc == kChunkOutputs)
+        {
+            uint8_t layout = 0;
+            chunk.io(layout);
+            for (uint8_t& bus : preset.trackOutputBus)
+                chunk.io(bus);
+            preset.outputBusLayout = static_cast<int8_t>(layout);
+        }
+    }
 
-    found += std::strlen(pattern);
-    value = std::atof(found);
+    return preset.validate();
+}
 
-    return true;
+int DrumMachinePureDSP::getActiveVoiceCount() const
+{
+    // Count sounding voices across all pools
+    return sequencer_.getActiveVoiceCount();
 }
 
 //==============================================================================
@@ -2055,11 +4621,60 @@ bool StepSequencer::shouldGateStep(const DrillGatePolicy& policy)
 // Bar Tracking for Automation
 //==============================================================================
 
-void StepSequencer::updateBarIndex()
+void StepSequencer::updateBarIndex(int64_t absoluteBar)
+{
+    // Automation and phrase position run on the song timeline, not the
+    // pattern loop: a 16-step pattern still advances one bar per bar
+    const int bar = static_cast<int>(std::min<int64_t>(absoluteBar, std::numeric_limits<int>::max()));
+    if (bar != currentBar_)
+    {
+        currentBar_ = bar;
+        barPoliciesDirty_ = true;
+    }
+}
+
+void StepSequencer::seekRandomStreams(int64_t bar)
+{
+    randomBar_ = bar;
+    const uint32_t position = static_cast<uint32_t>(bar);
+    for (int track = 0; track < static_cast<int>(trackRng_.size()); ++track)
+        trackRng_[track].seek(RandomStream::makeKey(kRandomSeed, static_cast<uint32_t>(track), position));
+    drillRng_.seek(RandomStream::makeKey(kRandomSeed, kDrillStream, position));
+}
+
+void StepSequencer::invalidateAutomation()
+{
+    drillCursor_ = BarAutomationLane::Cursor{};
+    swingCursor_ = BarAutomationLane::Cursor{};
+    dillaCursor_ = BarAutomationLane::Cursor{};
+    barPoliciesDirty_ = true;
+}
+
+void StepSequencer::updateBarPolicies()
 {
-    // Calculate bar index from current step
-    // Assuming 16 steps per bar (4/4 time at 16th note resolution)
-    currentBar_ = currentStep_ / getStepsPerBar();
+    barPoliciesDirty_ = false;
+    barFillPolicy_ = drillFillPolicy_;
+    barGatePolicy_ = drillGatePolicy_;
+
+    // Automation lanes hold for the whole bar
+    barDrillAmount_ = drillAutomation_.evaluateAt(currentBar_, drillCursor_);
+    barSwingAmount_ = swingAutomation_.evaluateAt(currentBar_, swingCursor_);
+    barDillaAmount_ = dillaAutomation_.evaluateAt(currentBar_, dillaCursor_);
+
+    if (phraseDetector_.isPhraseEnd(currentBar_))
+    {
+        // Phrase boundaries: more intense fills, and the gate comes on
+        // (temporal collapse)
+        barFillPolicy_.triggerChance = std::max(barFillPolicy_.triggerChance, 0.9f);
+        barFillPolicy_.fillAmount = std::max(barFillPolicy_.fillAmount, 1.0f);
+        barGatePolicy_.enabled = true;
+    }
+    else
+    {
+        // Mid-phrase: gentler fills
+        barFillPolicy_.triggerChance = std::min(barFillPolicy_.triggerChance, 0.4f);
+        barFillPolicy_.fillAmount = std::min(barFillPolicy_.fillAmount, 0.6f);
+    }
 }
 
 
@@ -2108,12 +4723,10 @@ void StepSequencer::scheduleMicroBurst(int trackIndex, const StepCell& cell,
         int sampleDelay = static_cast<int>(cell.timingOffset * samplesPerStep_);
         if (sampleDelay >= 0 && sampleDelay < static_cast<int>(samplesPerStep_))
         {
-            // Safety check for single hit
-            if (microHitsThisBlock_ < kMaxMicroHitsPerBlock)
-            {
-                triggerTrack(trackIndex, 0, cell.velocity / 127.0f);
-                microHitsThisBlock_++;
-            }
+            // Single hits are the groove itself: counted, never cut
+            queueTrackHit(trackIndex, cell, cell.velocity / 127.0f, cell.probability,
+                          stepStartSeconds * sampleRate_ + sampleDelay);
+            microHitsThisStep_++;
         }
         return;
     }
@@ -2141,10 +4754,25 @@ void StepSequencer::scheduleMicroBurst(int trackIndex, const StepCell& cell,
         burstCount = std::max(1, burstCount);
     }
 
+    // Step probability decides whether the burst plays at all
+    if (cell.probability < 1.0f)
+    {
+        if (trackRng_[trackIndex].next01() >= cell.probability) return;
+    }
+
     // Get per-cell drill params or use defaults from drill mode
     const float cellChaos = cell.useDrill ? cell.burstChaos : drill.chaos;
     const float cellDropout = cell.useDrill ? cell.burstDropout : drill.dropout;
-    const int cellBurstCount = cell.useDrill ? cell.burstCount : burstCount;
+    const int requestedBurstCount = std::max(1, cell.useDrill ? cell.burstCount : burstCount);
+
+    // Buy the burst up front from this cell's share of the step budget.
+    // Over budget it plays thinned across the same span, keeping its first hit.
+    const int cellBurstCount = std::max(1, std::min(requestedBurstCount, getMicroHitAllowance(cell.drillIntent)));
+    if (cellBurstCount < requestedBurstCount)
+    {
+        countDroppedMicroHits(requestedBurstCount - cellBurstCount);
+        thinnedBursts_.fetch_add(1, std::memory_order_relaxed);
+    }
 
     // Compute how wide the burst spans inside this step
     const double span = stepDurationSeconds * std::max(0.0, std::min(1.0, static_cast<double>(drill.spread)));
@@ -2166,13 +4794,6 @@ void StepSequencer::scheduleMicroBurst(int trackIndex, const StepCell& cell,
     // Schedule micro-hits
     for (int i = 0; i < cellBurstCount; ++i)
     {
-        // Safety check: prevent audio thread DOS
-        if (microHitsThisBlock_ >= kMaxMicroHitsPerBlock)
-        {
-            // Drop remaining micro-hits if we've exceeded the limit
-            break;
-        }
-
         // Dropout: chance to skip this micro-hit (scaled by amt)
         if (drillRng_.next01() < std::max(0.0f, std::min(1.0f, static_cast<float>(cellDropout))) * amt)
             continue;
@@ -2224,23 +4845,53 @@ void StepSequencer::scheduleMicroBurst(int trackIndex, const StepCell& cell,
             v = std::max(0.0f, std::min(1.0f, v * spike));
         }
 
-        // Convert velocity back to MIDI range
-        uint8_t midiVel = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, v)) * 127.0f);
+        // Place the micro-hit at its own sample inside the step
+        const double hitSample = stepStartSeconds * sampleRate_ + timingOffsetFraction * samplesPerStep_;
+        if (!pushHit(trackIndex, hitSample, std::max(0.0f, std::min(1.0f, v))))
+        {
+            countDroppedMicroHits(cellBurstCount - i);  // Queue full
+            break;
+        }
 
-        // Create temporary cell for this micro-hit
-        StepCell microCell = cell;
-        microCell.timingOffset = timingOffsetFraction;
-        microCell.velocity = midiVel;
-        microCell.useDrill = false; // Prevent infinite recursion
+        // Increment safety counter
+        microHitsThisStep_++;
+        microHitsScheduled_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
-        // Trigger the micro-hit
-        triggerTrack(trackIndex, 0, v);
+int StepSequencer::getMicroHitAllowance(DrillIntent intent) const
+{
+    // Fills and accents (Emphasize) get the whole budget; optional drill
+    // leaves the last quarter to them
+    const int limit = (intent == DrillIntent::Emphasize) ? microHitBudget_ : microHitBudget_ * 3 / 4;
+    return std::max(0, limit - microHitsThisStep_);
+}
 
-        // Increment safety counter
-        microHitsThisBlock_++;
+void StepSequencer::countDroppedMicroHits(int count)
+{
+    microHitsDropped_.fetch_add(static_cast<uint32_t>(count), std::memory_order_relaxed);
+    if (!budgetLimitedThisStep_)
+    {
+        budgetLimitedThisStep_ = true;
+        limitedSteps_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
+void StepSequencer::setMicroHitBudget(int hitsPerStep)
+{
+    microHitBudget_ = std::max(1, std::min(kMaxMicroHitsPerStep, hitsPerStep));
+}
+
+MicroHitStats StepSequencer::getMicroHitStats() const
+{
+    MicroHitStats stats;
+    stats.scheduled = microHitsScheduled_.load(std::memory_order_relaxed);
+    stats.dropped = microHitsDropped_.load(std::memory_order_relaxed);
+    stats.thinnedBursts = thinnedBursts_.load(std::memory_order_relaxed);
+    stats.limitedSteps = limitedSteps_.load(std::memory_order_relaxed);
+    return stats;
+}
+
 // Drill Preset Implementations
 
 DrillMode StepSequencer::presetDrillLite()
@@ -21,55 +21,20 @@ void DrumMachinePureDSP::processStereo(float** outputs, int numChannels, int num
 {
     using namespace StereoProcessor;
 
+    RealtimeNoAllocScope noAlloc;
+    const int64_t blockStart = RenderProfiler::now();
+
     // Get stereo parameters
     float width = params_.stereoWidth;
     float roomWidth = params_.roomWidth;
     float effectsWidth = params_.effectsWidth;
 
-    // Clear output buffers
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            outputs[ch][i] = 0.0f;
-        }
-    }
+    // Panned, level-scaled track mix (shared with process())
+    renderTracks(outputs, numChannels, numSamples);
+    const int64_t stereoStart = RenderProfiler::now();
 
-    // Process each track with stereo panning
-    for (int track = 0; track < sequencer_.getNumTracks(); ++track)
-    {
-        Track currentTrack = sequencer_.getTrack(track);
-
-        // Get track pan (-1.0 to 1.0, -1=left, 0=center, 1=right)
-        float pan = currentTrack.pan;
-        float trackVolume = params_.trackVolumes[track];
-
-        // Calculate pan gains using constant power panning
-        float panAngle = (pan + 1.0f) * 0.5f * M_PI * 0.5f;  // Map to 0-90 degrees
-        float leftGain = std::cos(panAngle) * trackVolume;
-        float rightGain = std::sin(panAngle) * trackVolume;
-
-        // Process track
-        std::vector<float> trackBuffer(numSamples);
-        sequencer_.processTrack(track, trackBuffer.data(), numSamples);
-
-        // Pan to stereo output
-        for (int i = 0; i < numSamples; ++i)
-        {
-            if (numChannels >= 2)
-            {
-                outputs[0][i] += trackBuffer[i] * leftGain;
-                outputs[1][i] += trackBuffer[i] * rightGain;
-            }
-            else if (numChannels == 1)
-            {
-                outputs[0][i] += trackBuffer[i] * trackVolume;
-            }
-        }
-    }
-
-    // Apply stereo width to overall mix
-    if (numChannels >= 2 && width > 0.0f)
+    // Apply stereo width to overall mix (nothing to widen in an idle block)
+    if (numChannels >= 2 && width > 0.0f && !isLastBlockSilent())
     {
         for (int i = 0; i < numSamples; ++i)
         {
@@ -96,15 +61,9 @@ void DrumMachinePureDSP::processStereo(float** outputs, int numChannels, int num
         }
     }
 
-    // Apply master volume
-    float masterVol = params_.masterVolume;
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            outputs[ch][i] *= masterVol;
-        }
-    }
+    // Master volume is already folded into the track gains
+    profiler_.addStage(ProfileStage::Stereo, stereoStart);
+    profiler_.endBlock(blockStart, numSamples, sampleRate_, sequencer_);
 }
 
 //==============================================================================
@@ -14,7 +14,14 @@
 #include <iostream>
 #include <cstdio>
 #include <cmath>
+#include <limits>
+#include <cstring>
+#include <string>
 #include <vector>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 using namespace DSP;
 
@@ -280,8 +287,42 @@ bool testParameterChanges(TestStats& stats) {
 
     std::cout << "    Volume: " << vol << ", Tempo: " << tempo << ", Swing: " << swing << std::endl;
 
-    // Note: DrumMachine may use different parameter IDs or return different values
-    // Just verify parameters were handled without crash
+    // Wrapper (camelCase) and DSP (snake_case) IDs address the same parameter
+    if (std::abs(vol - 0.9f) > 1e-6f ||
+        dm.getParameter(DrumParam::MasterVolume) != vol ||
+        dm.getParameter("master_volume") != vol ||
+        std::abs(swing - 0.5f) > 1e-6f) {
+        stats.fail("parameters", "String and integer parameter IDs disagree");
+        return false;
+    }
+
+    // Every ID in both spellings finds its parameter; unknown IDs do not
+    for (int i = 0; i < kNumDrumParams; ++i) {
+        const DrumParam param = static_cast<DrumParam>(i);
+        const DrumParamInfo& info = getDrumParamInfo(param);
+        if (findDrumParam(info.id) != param || findDrumParam(info.aliasId) != param) {
+            stats.fail("parameters", "Parameter ID lookup failed");
+            return false;
+        }
+    }
+    if (findDrumParam("tempo_") != DrumParam::Count || findDrumParam("") != DrumParam::Count
+        || findDrumParam(nullptr) != DrumParam::Count) {
+        stats.fail("parameters", "Unknown parameter ID matched");
+        return false;
+    }
+
+    // Values are held to the descriptor range; NaN is ignored
+    dm.setParameter(DrumParam::Tempo, 1000.0f);
+    dm.setParameter(trackPanParam(3), -5.0f);
+    dm.setParameter(DrumParam::Swing, std::numeric_limits<float>::quiet_NaN());
+    std::cout << "    Tempo 1000 -> " << dm.getParameter(DrumParam::Tempo)
+              << ", pan -5 -> " << dm.getParameter(trackPanParam(3)) << std::endl;
+    if (dm.getParameter(DrumParam::Tempo) != 200.0f || dm.getParameter(trackPanParam(3)) != -1.0f
+        || dm.getParameter(DrumParam::Swing) != swing) {
+        stats.fail("parameters", "Parameter values not clamped to their range");
+        return false;
+    }
+
     stats.pass("parameters");
     return true;
 }
@@ -326,6 +367,2136 @@ bool testStereoOutput(TestStats& stats) {
     return true;
 }
 
+//==============================================================================
+// Test 8: Sample-Accurate Step Timing
+//==============================================================================
+
+int findOnsetForBlockSize(int blockSize) {
+    StepSequencer seq;
+    seq.prepare(48000.0, blockSize);
+    seq.reset();
+    seq.setTempo(120.0f);  // 6000 samples per 16th step
+
+    // Kick on step 4 (pocket timing role)
+    Track kick = seq.getTrack(0);
+    kick.steps.edit(4).active = true;
+    kick.steps.edit(4).velocity = 127;
+    seq.setTrack(0, kick);
+
+    const int numSamples = 48000;
+    std::vector<float> out(numSamples, 0.0f);
+
+    int offset = 0;
+    while (offset < numSamples) {
+        int blockEnd = std::min(numSamples, offset + blockSize);
+        while (offset < blockEnd) {
+            seq.dispatchDueHits();
+            int subBlock = seq.getSamplesUntilNextEvent(blockEnd - offset);
+            seq.processTrack(0, out.data() + offset, subBlock);
+            seq.advance(subBlock);
+            offset += subBlock;
+        }
+    }
+
+    for (int i = 0; i < numSamples; ++i) {
+        if (std::abs(out[i]) > 0.0f) return i;
+    }
+    return -1;
+}
+
+bool testSampleAccurateTiming(TestStats& stats) {
+    std::cout << "\n[Test 8] Sample-Accurate Step Timing" << std::endl;
+
+    int onsetSmall = findOnsetForBlockSize(64);
+    int onsetLarge = findOnsetForBlockSize(1024);
+
+    std::cout << "    Onset @64: " << onsetSmall << ", @1024: " << onsetLarge << std::endl;
+
+    if (onsetSmall < 0 || onsetSmall != onsetLarge) {
+        stats.fail("sample_accurate_timing", "Step onset depends on block size");
+        return false;
+    }
+
+    // Step 4 sits 24000 samples in; groove offsets stay within one step
+    if (std::abs(onsetSmall - 24000) > 6000) {
+        stats.fail("sample_accurate_timing", "Step onset far from its grid position");
+        return false;
+    }
+
+    stats.pass("sample_accurate_timing");
+    return true;
+}
+
+//==============================================================================
+// Test 9: Voice Pool Stealing
+//==============================================================================
+
+bool testVoiceStealing(TestStats& stats) {
+    std::cout << "\n[Test 9] Voice Pool Stealing" << std::endl;
+
+    StepSequencer seq;
+    seq.prepare(48000.0, 512);
+    seq.reset();
+    seq.setVoicePolyphony(Track::DrumType::Snare, 3);
+
+    // Snare is track 1; five back-to-back hits must share three voices
+    std::vector<float> out(64, 0.0f);
+    for (int i = 0; i < 5; ++i) {
+        seq.triggerTrack(1, 0, 1.0f);
+        seq.dispatchDueHits();
+        seq.processTrack(1, out.data(), 64);
+    }
+
+    int active = seq.getActiveVoiceCount();
+    std::cout << "    Active voices: " << active << std::endl;
+
+    if (active != 3) {
+        stats.fail("voice_stealing", "Overlapping hits not limited to pool polyphony");
+        return false;
+    }
+
+    stats.pass("voice_stealing");
+    return true;
+}
+
+//==============================================================================
+// Test 10: Voice Block Kernels
+//==============================================================================
+
+template <typename Voice>
+float maxBlockDeviation() {
+    Voice scalar, block;
+    scalar.prepare(48000.0);
+    block.prepare(48000.0);
+    scalar.trigger(1.0f);
+    block.trigger(1.0f);
+
+    // Odd block size exercises partial kernel chunks
+    const int numSamples = 4800;
+    const int blockSize = 100;
+    std::vector<float> out(numSamples, 0.0f);
+    for (int offset = 0; offset < numSamples; offset += blockSize)
+        block.processBlock(out.data() + offset, blockSize);
+
+    float maxDiff = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+        maxDiff = std::max(maxDiff, std::abs(out[i] - scalar.processSample()));
+    return maxDiff;
+}
+
+bool testBlockKernels(TestStats& stats) {
+    std::cout << "\n[Test 10] Voice Block Kernels" << std::endl;
+
+    float deviations[] = {
+        maxBlockDeviation<KickVoice>(),
+        maxBlockDeviation<SnareVoice>(),
+        maxBlockDeviation<HiHatVoice>(),
+        maxBlockDeviation<ClapVoice>(),
+        maxBlockDeviation<PercVoice>(),
+        maxBlockDeviation<CymbalVoice>()
+    };
+
+    float worst = *std::max_element(std::begin(deviations), std::end(deviations));
+    std::cout << "    Max block/sample deviation: " << worst << std::endl;
+
+    if (worst > 1.0e-3f) {
+        stats.fail("block_kernels", "processBlock diverges from processSample");
+        return false;
+    }
+
+    stats.pass("block_kernels");
+    return true;
+}
+
+//==============================================================================
+// Test 11: Allocation-Free Render
+//==============================================================================
+
+bool testAllocationFreeRender(TestStats& stats) {
+    std::cout << "\n[Test 11] Allocation-Free Render" << std::endl;
+
+    // Built with DRUMMACHINE_ASSERT_NO_ALLOC: any heap use inside
+    // process()/processStereo() aborts the test run
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 64);
+
+    ScheduledEvent event;
+    event.type = ScheduledEvent::NOTE_ON;
+    event.time = 0.0;
+    event.sampleOffset = 0;
+    event.data.note.midiNote = 38;
+    event.data.note.velocity = 1.0f;
+    dm.handleEvent(event);
+
+    // Host block larger than the prepared size must still render in place
+    const int numSamples = 1000;
+    std::vector<float> left(numSamples, 0.0f);
+    std::vector<float> right(numSamples, 0.0f);
+    float* outputs[2] = { left.data(), right.data() };
+    dm.process(outputs, 2, numSamples);
+    float monoPeak = getPeakLevel(left.data(), numSamples);
+
+    dm.handleEvent(event);
+    dm.processStereo(outputs, 2, numSamples);
+    float stereoPeak = getPeakLevel(left.data(), numSamples);
+
+    std::cout << "    process peak: " << monoPeak << ", processStereo peak: " << stereoPeak << std::endl;
+
+    if (monoPeak < 0.0001f || stereoPeak < 0.0001f) {
+        stats.fail("allocation_free_render", "No audio from oversized host block");
+        return false;
+    }
+
+    stats.pass("allocation_free_render");
+    return true;
+}
+
+//==============================================================================
+// Test 12: Per-Track Pan
+//==============================================================================
+
+bool testTrackPan(TestStats& stats) {
+    std::cout << "\n[Test 12] Per-Track Pan" << std::endl;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    dm.setParameter("track_0_pan", -1.0f);  // Note 36 plays the kick track
+
+    ScheduledEvent event;
+    event.type = ScheduledEvent::NOTE_ON;
+    event.time = 0.0;
+    event.sampleOffset = 0;
+    event.data.note.midiNote = 36;
+    event.data.note.velocity = 1.0f;
+    dm.handleEvent(event);
+
+    const int numSamples = 4096;
+    std::vector<float> left(numSamples);
+    std::vector<float> right(numSamples);
+    processAudioInChunks(dm, left.data(), right.data(), numSamples);
+
+    float leftPeak = getPeakLevel(left.data(), numSamples);
+    float rightPeak = getPeakLevel(right.data(), numSamples);
+    std::cout << "    Left: " << leftPeak << ", Right: " << rightPeak << std::endl;
+
+    if (leftPeak < 0.0001f || rightPeak > leftPeak * 0.01f) {
+        stats.fail("track_pan", "Hard-left track leaks into the right channel");
+        return false;
+    }
+
+    // Pan is mixer state: swapping in new tracks keeps the host's value
+    SequencerSnapshot snapshot;
+    snapshot.tracks[0].steps.edit(4).active = true;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = false;
+    dm.publishPattern(snapshot);
+    processAudioInChunks(dm, left.data(), right.data(), numSamples);
+    dm.handleEvent(event);
+    processAudioInChunks(dm, left.data(), right.data(), numSamples);
+    leftPeak = getPeakLevel(left.data(), numSamples);
+    rightPeak = getPeakLevel(right.data(), numSamples);
+    std::cout << "    After track swap - Left: " << leftPeak << ", Right: " << rightPeak << std::endl;
+    if (leftPeak < 0.0001f || rightPeak > leftPeak * 0.01f || dm.getParameter("track_0_pan") != -1.0f) {
+        stats.fail("track_pan", "Track swap overwrote the host's pan");
+        return false;
+    }
+
+    stats.pass("track_pan");
+    return true;
+}
+
+//==============================================================================
+// Test 13: MIDI Sample Offset
+//==============================================================================
+
+bool testMidiSampleOffset(TestStats& stats) {
+    std::cout << "\n[Test 13] MIDI Sample Offset" << std::endl;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+
+    // Pad note remapped onto the kick, landing 300 samples into the block
+    dm.setNoteMapping(60, 0);
+
+    ScheduledEvent event;
+    event.type = ScheduledEvent::NOTE_ON;
+    event.time = 0.0;
+    event.sampleOffset = 300;
+    event.data.note.midiNote = 60;
+    event.data.note.velocity = 1.0f;
+    dm.handleEvent(event);
+
+    std::vector<float> left(512, 0.0f);
+    std::vector<float> right(512, 0.0f);
+    float* outputs[2] = { left.data(), right.data() };
+    dm.process(outputs, 2, 512);
+
+    int onset = -1;
+    for (int i = 0; i < 512 && onset < 0; ++i)
+        if (std::abs(left[i]) > 0.0f) onset = i;
+
+    std::cout << "    Onset: " << onset << std::endl;
+
+    if (onset != 300) {
+        stats.fail("midi_sample_offset", "Note-on not rendered at its sample offset");
+        return false;
+    }
+
+    stats.pass("midi_sample_offset");
+    return true;
+}
+
+//==============================================================================
+// Test 14: Multi-Core Render
+//==============================================================================
+
+bool testParallelRender(TestStats& stats) {
+    std::cout << "\n[Test 14] Multi-Core Render" << std::endl;
+
+    const int blockSize = 32;
+    DrumMachinePureDSP serial;
+    DrumMachinePureDSP parallel;
+    serial.prepare(48000.0, blockSize);
+    parallel.prepare(48000.0, blockSize);
+    parallel.setRenderThreads(4);
+
+    if (parallel.getRenderThreads() != 4) {
+        stats.fail("parallel_render", "Render thread count not applied");
+        return false;
+    }
+
+    // Every pad at staggered offsets, at the smallest host buffer
+    float maxDiff = 0.0f;
+    float peak = 0.0f;
+    std::vector<float> buffers(4 * blockSize);
+    for (int block = 0; block < 400; ++block) {
+        if (block % 25 == 0) {
+            for (int pad = 0; pad < 16; ++pad) {
+                ScheduledEvent event;
+                event.type = ScheduledEvent::NOTE_ON;
+                event.time = 0.0;
+                event.sampleOffset = (pad * 7) % blockSize;
+                event.data.note.midiNote = 36 + pad;
+                event.data.note.velocity = 0.5f + 0.03f * pad;
+                serial.handleEvent(event);
+                parallel.handleEvent(event);
+            }
+        }
+
+        float* serialOut[2] = { buffers.data(), buffers.data() + blockSize };
+        float* parallelOut[2] = { buffers.data() + 2 * blockSize, buffers.data() + 3 * blockSize };
+        serial.process(serialOut, 2, blockSize);
+        parallel.process(parallelOut, 2, blockSize);
+
+        for (int i = 0; i < 2 * blockSize; ++i) {
+            maxDiff = std::max(maxDiff, std::abs(buffers[i] - buffers[2 * blockSize + i]));
+            peak = std::max(peak, std::abs(buffers[i]));
+        }
+    }
+
+    std::cout << "    Peak: " << peak << ", max serial/parallel diff: " << maxDiff << std::endl;
+
+    if (peak < 0.0001f || maxDiff > 1e-5f) {
+        stats.fail("parallel_render", "Parallel render differs from serial render");
+        return false;
+    }
+
+    stats.pass("parallel_render");
+    return true;
+}
+
+//==============================================================================
+// Test 15: Offline Render
+//==============================================================================
+
+// Collects every block written by renderOffline()
+struct CollectingSink : OfflineRenderSink {
+    std::vector<std::vector<float>> channels;
+    bool interleaved = false;
+
+    bool write(const float* const* data, int numChannels, int numSamples) override {
+        channels.resize(static_cast<size_t>(numChannels));
+        for (int ch = 0; ch < numChannels; ++ch) {
+            for (int i = 0; i < numSamples; ++i) {
+                channels[ch].push_back(interleaved ? data[0][i * numChannels + ch] : data[ch][i]);
+            }
+        }
+        return true;
+    }
+};
+
+bool testOfflineRender(TestStats& stats) {
+    std::cout << "\n[Test 15] Offline Render" << std::endl;
+
+    // Two-slot chain: kick-only bar, then snare-only bar
+    DrumPattern kicks{};
+    DrumPattern snares{};
+    for (int track = 0; track < 16; ++track) {
+        kicks[track].type = static_cast<Track::DrumType>(track < 15 ? track : 14);
+        snares[track].type = kicks[track].type;
+    }
+    for (int step = 0; step < 16; step += 4) {
+        kicks[0].steps.edit(step).active = true;
+        snares[1].steps.edit(step).active = true;
+    }
+    const OfflineChainSlot chain[] = { { &kicks, 1 }, { &snares, 1 } };
+
+    OfflineRenderSettings settings;
+    settings.sampleRate = 48000.0;
+    settings.blockSize = 4096;
+    settings.chain = chain;
+    settings.chainLength = 2;
+    settings.maxTailSeconds = 0.5;
+
+    DrumMachinePureDSP dm;
+    CollectingSink mix;
+    CollectingSink mixAgain;
+    mix.interleaved = mixAgain.interleaved = settings.interleaved = true;
+    bool ok = dm.renderOffline(settings, mix) && dm.renderOffline(settings, mixAgain);
+
+    settings.interleaved = false;
+    settings.output = OfflineRenderOutput::TrackStems;
+    settings.renderThreads = 4;
+    CollectingSink stems;
+    ok = ok && dm.renderOffline(settings, stems);
+
+    if (!ok || mix.channels.size() != 2 || stems.channels.size() != 32) {
+        stats.fail("offline_render", "Render failed or wrong channel layout");
+        return false;
+    }
+
+    const size_t length = mix.channels[0].size();
+    const size_t barLength = static_cast<size_t>(48000.0 * 60.0 / 120.0 * 4.0);
+    std::cout << "    Rendered " << length << " samples (2 bars = " << 2 * barLength << ")" << std::endl;
+
+    // Repeat renders match; stems sum to the mix; the snare stem is silent
+    // until the chain reaches its bar
+    float repeatDiff = 0.0f;
+    float stemDiff = 0.0f;
+    float snareBeforeSwap = 0.0f;
+    float snareAfterSwap = 0.0f;
+    for (size_t i = 0; i < length && i < mixAgain.channels[0].size() && i < stems.channels[0].size(); ++i) {
+        float stemSum = 0.0f;
+        for (int track = 0; track < 16; ++track) stemSum += stems.channels[2 * track][i];
+        stemDiff = std::max(stemDiff, std::abs(stemSum - mix.channels[0][i]));
+        repeatDiff = std::max(repeatDiff, std::abs(mix.channels[0][i] - mixAgain.channels[0][i]));
+
+        const float snare = std::abs(stems.channels[2][i]);
+        if (i < barLength - 2000) snareBeforeSwap = std::max(snareBeforeSwap, snare);
+        else snareAfterSwap = std::max(snareAfterSwap, snare);
+    }
+
+    std::cout << "    Repeat diff: " << repeatDiff << ", stem diff: " << stemDiff
+              << ", snare before/after swap: " << snareBeforeSwap << "/" << snareAfterSwap << std::endl;
+
+    if (length < 2 * barLength || mixAgain.channels[0].size() != length || stems.channels[0].size() != length) {
+        stats.fail("offline_render", "Unexpected render length");
+        return false;
+    }
+    if (repeatDiff != 0.0f || stemDiff > 1e-4f || snareBeforeSwap != 0.0f || snareAfterSwap < 0.0001f) {
+        stats.fail("offline_render", "Offline render not deterministic or chain swap misplaced");
+        return false;
+    }
+
+    stats.pass("offline_render");
+    return true;
+}
+
+//==============================================================================
+// Test 16: Live Pattern Publish
+//==============================================================================
+
+bool testPatternPublish(TestStats& stats) {
+    std::cout << "\n[Test 16] Live Pattern Publish" << std::endl;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 256);
+
+    const int barLength = 96000;  // 16 steps at 120 BPM
+    std::vector<float> left(2 * barLength, 0.0f);
+    std::vector<float> right(2 * barLength, 0.0f);
+
+    // Half a bar of the empty pattern, then a kick on every step published
+    // for the next bar
+    processAudioInChunks(dm, left.data(), right.data(), barLength / 2, 256);
+
+    SequencerSnapshot snapshot;
+    for (int step = 0; step < 16; ++step) snapshot.tracks[0].steps.edit(step).active = true;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    dm.publishPattern(snapshot);
+
+    processAudioInChunks(dm, left.data() + barLength / 2, right.data() + barLength / 2,
+                         2 * barLength - barLength / 2, 256);
+
+    int onset = -1;
+    for (int i = 0; i < 2 * barLength && onset < 0; ++i)
+        if (std::abs(left[i]) > 0.0f) onset = i;
+    std::cout << "    First hit at sample " << onset << " (bar at " << barLength << ")" << std::endl;
+
+    if (onset < barLength - 1000 || onset > barLength + 1000) {
+        stats.fail("pattern_publish", "Published pattern did not start on the bar");
+        return false;
+    }
+
+    // Editor thread hammering full snapshots (allocating drill automation)
+    // while the audio thread renders; render must stay allocation-free
+    std::atomic<bool> done{false};
+    std::thread editor([&] {
+        SequencerSnapshot edit;
+        edit.parts = SequencerSnapshot::All;
+        edit.atBar = false;
+        for (int n = 0; n < 2000; ++n) {
+            edit.tracks[n % 16].steps.edit(n % 16).active = !edit.tracks[n % 16].steps[n % 16].active;
+            edit.drillAutomation.addPoint(n % 64, 0.5f);
+            edit.drillMode.enabled = (n % 3) == 0;
+            dm.publishPattern(edit);
+        }
+        done.store(true);
+    });
+
+    std::vector<float> block(2 * 256);
+    float* outputs[2] = { block.data(), block.data() + 256 };
+    int blocks = 0;
+    while (!done.load() || blocks < 200) {
+        dm.process(outputs, 2, 256);
+        ++blocks;
+    }
+    editor.join();
+
+    std::cout << "    Rendered " << blocks << " blocks during 2000 publishes" << std::endl;
+    stats.pass("pattern_publish");
+    return true;
+}
+
+//==============================================================================
+// Test 17: Micro-Hit Budget
+//==============================================================================
+
+bool testMicroHitBudget(TestStats& stats) {
+    std::cout << "\n[Test 17] Micro-Hit Budget" << std::endl;
+
+    // 16-hit bursts on every step: snare as fills (Emphasize), hats optional
+    SequencerSnapshot snapshot;
+    snapshot.drillMode.enabled = true;
+    snapshot.drillMode.amount = 1.0f;
+    for (int step = 0; step < 16; ++step) {
+        for (int track = 1; track <= 2; ++track) {
+            StepCell& cell = snapshot.tracks[track].steps.edit(step);
+            cell.active = true;
+            cell.useDrill = true;
+            cell.burstCount = 16;
+            cell.drillIntent = (track == 1) ? DrillIntent::Emphasize : DrillIntent::Optional;
+        }
+    }
+    snapshot.tracks[1].type = Track::DrumType::Snare;
+    snapshot.tracks[2].type = Track::DrumType::HiHatClosed;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    dm.setMicroHitBudget(12);
+    dm.publishPattern(snapshot);
+
+    // Four bars; the budget must keep applying, not shut drill off for good
+    std::vector<float> left(4 * 96000);
+    std::vector<float> right(4 * 96000);
+    processAudioInChunks(dm, left.data(), right.data(), 2 * 96000);
+    const MicroHitStats half = dm.getMicroHitStats();
+    processAudioInChunks(dm, left.data() + 2 * 96000, right.data() + 2 * 96000, 2 * 96000);
+    const MicroHitStats full = dm.getMicroHitStats();
+
+    std::cout << "    Scheduled: " << full.scheduled << ", dropped: " << full.dropped
+              << ", thinned bursts: " << full.thinnedBursts
+              << ", limited steps: " << full.limitedSteps << std::endl;
+
+    if (full.dropped == 0 || full.thinnedBursts == 0 || full.limitedSteps == 0) {
+        stats.fail("micro_hit_budget", "Budget never applied");
+        return false;
+    }
+    if (full.scheduled <= half.scheduled + 64) {
+        stats.fail("micro_hit_budget", "Bursts stopped once the budget was first reached");
+        return false;
+    }
+
+    // The budget is per step: the same bursts are thinned at any host
+    // block size, so a bounce matches live playback
+    auto renderAtBlockSize = [&snapshot](int blockSize, std::vector<float>& out) {
+        DrumMachinePureDSP blockDm;
+        blockDm.prepare(48000.0, blockSize);
+        blockDm.setMicroHitBudget(12);
+        blockDm.publishPattern(snapshot);
+        std::vector<float> right(out.size());
+        processAudioInChunks(blockDm, out.data(), right.data(), static_cast<int>(out.size()), blockSize);
+        return blockDm.getMicroHitStats();
+    };
+    std::vector<float> small(96000), medium(96000), large(96000);
+    const MicroHitStats at64 = renderAtBlockSize(64, small);
+    const MicroHitStats at256 = renderAtBlockSize(256, medium);
+    const MicroHitStats at8192 = renderAtBlockSize(8192, large);
+    std::cout << "    Dropped @64: " << at64.dropped << ", @256: " << at256.dropped
+              << ", @8192: " << at8192.dropped << std::endl;
+    if (at64.dropped == 0 || at64.dropped != at256.dropped || at64.dropped != at8192.dropped
+        || at64.scheduled != at256.scheduled || at64.scheduled != at8192.scheduled
+        || small != medium || small != large) {
+        stats.fail("micro_hit_budget", "Thinning depends on the host block size");
+        return false;
+    }
+
+    stats.pass("micro_hit_budget");
+    return true;
+}
+
+//==============================================================================
+// Test 18: Preset and Binary State Round Trip
+//==============================================================================
+
+bool testStateRoundTrip(TestStats& stats) {
+    std::cout << "\n[Test 18] Preset and Binary State Round Trip" << std::endl;
+
+    std::vector<float> left(12000);
+    std::vector<float> right(12000);
+
+    DrumMachinePureDSP source;
+    source.prepare(48000.0, 512);
+    source.setParameter("tempo", 137.0f);
+    source.setParameter("swing", 0.3f);
+
+    SequencerSnapshot snapshot;
+    snapshot.drillMode.enabled = true;
+    snapshot.drillMode.amount = 0.4f;
+    snapshot.drillAutomation.addPoint(2, 0.9f);
+    for (int step = 0; step < 16; step += 3) {
+        StepCell& cell = snapshot.tracks[5].steps.edit(step);
+        cell.active = true;
+        cell.velocity = static_cast<uint8_t>(60 + step);
+        cell.useDrill = true;
+        cell.burstCount = 5;
+    }
+    snapshot.tracks[5].type = Track::DrumType::TomMid;
+    snapshot.tracks[5].pan = -0.25f;
+    snapshot.tracks[5].pitch = -3;
+    snapshot.atBar = false;
+    source.publishPattern(snapshot);
+    processAudioInChunks(source, left.data(), right.data(), 12000);
+
+    // Binary: load, let the published pattern land, save again
+    const int size = source.saveState(nullptr, 0);
+    std::vector<uint8_t> saved(size);
+    if (size <= 8 || source.saveState(saved.data(), size) != size) {
+        stats.fail("state_round_trip", "saveState size mismatch");
+        return false;
+    }
+
+    DrumMachinePureDSP restored;
+    restored.prepare(48000.0, 512);
+    if (!restored.loadState(saved.data(), size)) {
+        stats.fail("state_round_trip", "loadState rejected its own data");
+        return false;
+    }
+    processAudioInChunks(restored, left.data(), right.data(), 12000);
+
+    std::vector<uint8_t> resaved(size);
+    if (restored.saveState(resaved.data(), size) != size || resaved != saved) {
+        stats.fail("state_round_trip", "Binary state did not round trip");
+        return false;
+    }
+    std::cout << "    Binary state: " << size << " bytes" << std::endl;
+
+    // Truncated or foreign data is refused or leaves defaults in place
+    if (restored.loadState(saved.data(), 6) || restored.loadState(reinterpret_cast<const uint8_t*>("RIFF0000"), 8)) {
+        stats.fail("state_round_trip", "Invalid state accepted");
+        return false;
+    }
+
+    // JSON preset
+    std::vector<char> json(64 * 1024);
+    std::vector<char> rejson(64 * 1024);
+    DrumMachinePureDSP fromJson;
+    fromJson.prepare(48000.0, 512);
+    if (!source.savePreset(json.data(), static_cast<int>(json.size())) || !fromJson.loadPreset(json.data())) {
+        stats.fail("state_round_trip", "JSON preset save/load failed");
+        return false;
+    }
+    processAudioInChunks(fromJson, left.data(), right.data(), 12000);
+    fromJson.savePreset(rejson.data(), static_cast<int>(rejson.size()));
+    if (std::strcmp(json.data(), rejson.data()) != 0) {
+        stats.fail("state_round_trip", "JSON preset did not round trip");
+        return false;
+    }
+    if (std::abs(fromJson.getParameter("tempo") - 137.0f) > 1e-4f) {
+        stats.fail("state_round_trip", "JSON tempo not restored");
+        return false;
+    }
+
+    stats.pass("state_round_trip");
+    return true;
+}
+
+//==============================================================================
+// Test 19: Preset Bank Cache
+//==============================================================================
+
+bool testPresetBank(TestStats& stats) {
+    std::cout << "\n[Test 19] Preset Bank Cache" << std::endl;
+
+    // Four JSON presets at different tempos, one binary state, one macro
+    PresetBank bank;
+    std::vector<char> json(64 * 1024);
+    for (int i = 0; i < 4; ++i) {
+        DrumMachinePureDSP source;
+        source.prepare(48000.0, 512);
+        source.setParameter("tempo", 100.0f + 10.0f * i);
+        source.savePreset(json.data(), static_cast<int>(json.size()));
+        bank.addPreset("json " + std::to_string(i), json.data());
+    }
+
+    DrumMachinePureDSP stateSource;
+    stateSource.prepare(48000.0, 512);
+    stateSource.setParameter("swing", 0.45f);
+    std::vector<uint8_t> state(stateSource.saveState(nullptr, 0));
+    stateSource.saveState(state.data(), static_cast<int>(state.size()));
+    const int stateIndex = bank.addState("state", state.data(), static_cast<int>(state.size()));
+
+    DecodedPreset macro;
+    macro.setDrill(StepSequencer::idmMacroVenetianCollapse());
+    const int macroIndex = bank.addDecoded("macro", macro);
+    const int badIndex = bank.addPreset("broken", "{ \"parameters\": { \"tempo\": ");
+
+    bank.preloadAll();
+    bank.waitForPreload();
+    for (int i = 0; i < bank.getNumPresets(); ++i) {
+        if (bank.isCached(i) == (i == badIndex)) {
+            stats.fail("preset_bank", "Preload did not decode every valid preset");
+            return false;
+        }
+    }
+    if (bank.get(badIndex) != nullptr || bank.get(stateIndex) == nullptr
+        || std::abs(bank.get(stateIndex)->params[static_cast<int>(DrumParam::Swing)] - 0.45f) > 1e-6f) {
+        stats.fail("preset_bank", "Decoded content wrong");
+        return false;
+    }
+
+    // Program change: parameters next block, drill state at the bar
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    std::vector<float> left(96000);
+    std::vector<float> right(96000);
+    processAudioInChunks(dm, left.data(), right.data(), 24000);
+    dm.applyPreset(*bank.get(2));
+    dm.applyPreset(*bank.get(macroIndex));
+    processAudioInChunks(dm, left.data(), right.data(), 512);
+    if (std::abs(dm.getParameter("tempo") - 120.0f) > 1e-4f) {
+        stats.fail("preset_bank", "Preset parameters not applied");
+        return false;
+    }
+
+    // LRU bound: a tiny budget keeps only the most recent source-backed entry
+    bank.setMaxCachedBytes(1);
+    bank.get(1);
+    const PresetBankStats afterEvict = bank.getStats();
+    const bool residentKept = bank.isCached(macroIndex);
+    const bool recentKept = bank.isCached(1) && !bank.isCached(0) && !bank.isCached(stateIndex);
+    std::cout << "    Hits: " << afterEvict.hits << ", misses: " << afterEvict.misses
+              << ", evictions: " << afterEvict.evictions << ", cached bytes: " << bank.getCachedBytes() << std::endl;
+    if (!residentKept || !recentKept || afterEvict.evictions == 0) {
+        stats.fail("preset_bank", "LRU bound not applied");
+        return false;
+    }
+    if (bank.get(0) == nullptr || bank.getStats().misses != afterEvict.misses + 1) {
+        stats.fail("preset_bank", "Evicted preset not decoded again on demand");
+        return false;
+    }
+
+    stats.pass("preset_bank");
+    return true;
+}
+
+//==============================================================================
+// Test 20: Step Index Follows Pattern Edits
+//==============================================================================
+
+bool testStepIndex(TestStats& stats) {
+    std::cout << "\n[Test 20] Step Index Follows Pattern Edits" << std::endl;
+
+    StepSequencer seq;
+    seq.prepare(48000.0, 512);
+    seq.reset();
+    seq.setTempo(120.0f);
+
+    Track kick = seq.getTrack(0);
+    kick.steps.edit(0).active = true;
+    kick.steps.edit(0).velocity = 127;
+    kick.steps.edit(8).active = true;
+    kick.steps.edit(8).velocity = 20;
+    seq.setTrack(0, kick);
+
+    if (!seq.isTrackTriggered(0, 0) || !seq.isTrackTriggered(0, 8) || seq.isTrackTriggered(0, 4)
+        || seq.isTrackTriggered(1, 0)) {
+        stats.fail("step_index", "Active mask does not match the track");
+        return false;
+    }
+
+    // Velocity comes from the packed lane: the soft step must stay soft
+    std::vector<float> out(96000, 0.0f);
+    for (int offset = 0; offset < 96000;) {
+        seq.dispatchDueHits();
+        const int subBlock = seq.getSamplesUntilNextEvent(std::min(512, 96000 - offset));
+        seq.processTrack(0, out.data() + offset, subBlock);
+        seq.advance(subBlock);
+        offset += subBlock;
+    }
+    float loud = 0.0f, soft = 0.0f;
+    for (int i = 0; i < 48000; ++i) loud = std::max(loud, std::abs(out[i]));
+    for (int i = 48000; i < 96000; ++i) soft = std::max(soft, std::abs(out[i]));
+    std::cout << "    Peak vel 127: " << loud << ", vel 20: " << soft << std::endl;
+    if (loud <= 0.0f || soft <= 0.0f || soft >= loud * 0.5f) {
+        stats.fail("step_index", "Step velocities not applied");
+        return false;
+    }
+
+    // Editing the track updates the index
+    kick.steps.edit(8).active = false;
+    seq.setTrack(0, kick);
+    if (seq.isTrackTriggered(0, 8)) {
+        stats.fail("step_index", "Cleared step still indexed");
+        return false;
+    }
+
+    stats.pass("step_index");
+    return true;
+}
+
+//==============================================================================
+// Test 21: Long and Polymetric Patterns
+//==============================================================================
+
+// Hits the sequencer resolves for one track over numSamples
+std::vector<int> collectTrackHits(StepSequencer& seq, int trackIndex, int numSamples) {
+    std::vector<int> onsets;
+    BlockHit hits[256];
+    for (int offset = 0; offset < numSamples; offset += 512) {
+        const int numHits = seq.collectBlockHits(512, hits, 256);
+        for (int h = 0; h < numHits; ++h)
+            if (hits[h].trackIndex == trackIndex && offset + hits[h].sampleOffset < numSamples)
+                onsets.push_back(offset + hits[h].sampleOffset);
+    }
+    return onsets;
+}
+
+bool testLongPatterns(TestStats& stats) {
+    std::cout << "\n[Test 21] Long and Polymetric Patterns" << std::endl;
+
+    // 64-step pattern: step 40 is 40 x 6000 samples in (kick, pocket timing)
+    StepSequencer seq;
+    seq.prepare(48000.0, 512);
+    seq.reset();
+    seq.setTempo(120.0f);
+    seq.setPatternLength(64);
+
+    Track kick = seq.getTrack(0);
+    kick.steps.edit(40).active = true;
+    seq.setTrack(0, kick);
+
+    std::vector<int> onsets = collectTrackHits(seq, 0, 64 * 6000);
+    if (onsets.size() != 1 || std::abs(onsets[0] - 40 * 6000) > 600) {
+        stats.fail("long_patterns", "Step past 16 not played at its position");
+        return false;
+    }
+
+    // Sparse storage: only the one populated step is stored
+    if (seq.getTrack(0).steps.getNumStored() != 1 || sizeof(Track) > 256) {
+        stats.fail("long_patterns", "Step storage not sparse");
+        return false;
+    }
+
+    // Polymeter: a 3-step track against the 16-step pattern keeps its own cycle
+    StepSequencer poly;
+    poly.prepare(48000.0, 512);
+    poly.reset();
+    poly.setTempo(120.0f);
+    Track hat = poly.getTrack(0);
+    hat.steps.edit(0).active = true;
+    hat.length = 3;
+    poly.setTrack(0, hat);
+
+    onsets = collectTrackHits(poly, 0, 48 * 6000);
+    std::cout << "    3-step track hits in 48 steps: " << onsets.size() << std::endl;
+    if (onsets.size() != 16) {
+        stats.fail("long_patterns", "Polymetric track did not loop on its own length");
+        return false;
+    }
+    for (size_t i = 1; i < onsets.size(); ++i) {
+        if (std::abs(onsets[i] - onsets[i - 1] - 18000) > 600) {
+            stats.fail("long_patterns", "Polymetric hits not 3 steps apart");
+            return false;
+        }
+    }
+
+    // Long tracks survive a JSON preset round trip
+    DrumMachinePureDSP source;
+    source.prepare(48000.0, 512);
+    source.setParameter("pattern_length", 64.0f);
+    SequencerSnapshot snapshot;
+    snapshot.tracks[2].steps.edit(50).active = true;
+    snapshot.tracks[2].steps.edit(50).velocity = 77;
+    snapshot.tracks[3].length = 5;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = false;
+    source.publishPattern(snapshot);
+
+    std::vector<float> left(12000);
+    std::vector<float> right(12000);
+    processAudioInChunks(source, left.data(), right.data(), 12000);
+
+    std::vector<char> json(256 * 1024);
+    DrumMachinePureDSP restored;
+    restored.prepare(48000.0, 512);
+    if (!source.savePreset(json.data(), static_cast<int>(json.size())) || !restored.loadPreset(json.data())) {
+        stats.fail("long_patterns", "JSON save/load failed");
+        return false;
+    }
+    processAudioInChunks(restored, left.data(), right.data(), 12000);
+
+    std::vector<uint8_t> a(source.saveState(nullptr, 0));
+    std::vector<uint8_t> b(restored.saveState(nullptr, 0));
+    source.saveState(a.data(), static_cast<int>(a.size()));
+    restored.saveState(b.data(), static_cast<int>(b.size()));
+    if (a != b) {
+        stats.fail("long_patterns", "Long pattern did not survive JSON");
+        return false;
+    }
+
+    // Out-of-range lengths are clamped wherever a track comes in; the
+    // polymetric resolver then stays inside the step lanes
+    StepSequencer clamped;
+    clamped.prepare(48000.0, 512);
+    clamped.reset();
+    Track overlong = clamped.getTrack(0);
+    overlong.length = 10000;
+    overlong.steps.edit(127).active = true;
+    clamped.setTrack(0, overlong);
+    collectTrackHits(clamped, 0, 2 * 6000);
+    const int setLength = clamped.getTrack(0).length;
+
+    SequencerSnapshot negative;
+    negative.tracks[1].length = -5;
+    negative.parts = SequencerSnapshot::Tracks;
+    negative.atBar = false;
+    clamped.publishSnapshot(negative);
+    collectTrackHits(clamped, 1, 2 * 6000);
+    std::cout << "    Clamped lengths: " << setLength << ", " << clamped.getTrack(1).length << std::endl;
+    if (setLength != TrackSteps::kMaxSteps || clamped.getTrack(1).length != 0) {
+        stats.fail("long_patterns", "Track length not clamped");
+        return false;
+    }
+
+    // Fills follow the song bar, not the pattern: with 12 and 24-step
+    // patterns the burst steps are still the last two of every 16
+    auto fillSteps = [](int patternLength, int numBars) {
+        StepSequencer seq;
+        seq.prepare(48000.0, 512);
+        seq.reset();
+        seq.setTempo(120.0f);
+        seq.setPatternLength(patternLength);
+        DrillMode drill;
+        drill.enabled = true;
+        seq.setDrillMode(drill);
+        DrillFillPolicy fill;
+        fill.enabled = true;
+        fill.triggerChance = 1.0f;
+        fill.fillAmount = 1.0f;
+        seq.setDrillFillPolicy(fill);
+        DrillGatePolicy gate;
+        gate.silenceChance = 0.0f;
+        seq.setDrillGatePolicy(gate);
+        Track snare = seq.getTrack(1);
+        snare.length = patternLength;
+        for (int step = 0; step < patternLength; ++step)
+            snare.steps.edit(step).active = true;
+        seq.setTrack(1, snare);
+
+        std::vector<int> hitsPerStep(static_cast<size_t>(numBars) * 16, 0);
+        for (int onset : collectTrackHits(seq, 1, numBars * 16 * 6000))
+            hitsPerStep[static_cast<size_t>(onset / 6000)]++;
+        std::vector<int> bursts;
+        for (size_t step = 0; step < hitsPerStep.size(); ++step)
+            if (hitsPerStep[step] > 1)
+                bursts.push_back(static_cast<int>(step));
+        return bursts;
+    };
+    for (int patternLength : { 12, 24 }) {
+        const std::vector<int> bursts = fillSteps(patternLength, 8);
+        bool onBarEnds = !bursts.empty();
+        for (int step : bursts)
+            onBarEnds = onBarEnds && step % 16 >= 14;
+        std::cout << "    " << patternLength << "-step pattern, fill steps: " << bursts.size() << std::endl;
+        if (!onBarEnds) {
+            stats.fail("long_patterns", "Fills not on the last steps of each bar");
+            return false;
+        }
+    }
+
+    stats.pass("long_patterns");
+    return true;
+}
+
+//==============================================================================
+// Test 22: Bar Automation Lanes
+//==============================================================================
+
+bool testBarAutomation(TestStats& stats) {
+    std::cout << "\n[Test 22] Bar Automation Lanes" << std::endl;
+
+    // Sorted inserts, one point per bar
+    BarAutomationLane lane;
+    lane.addPoint(8, 0.8f);
+    lane.addPoint(0, 0.2f);
+    lane.addPoint(4, 0.5f);
+    lane.addPoint(4, 0.6f);
+    if (lane.points.size() != 3 || lane.points[1].bar != 4 || lane.points[1].amount != 0.6f) {
+        stats.fail("bar_automation", "Points not kept sorted and unique per bar");
+        return false;
+    }
+
+    // The cursor agrees with a full search, walking forward and jumping back
+    const int bars[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 3, 4, 12, -1, 0, 40, 2 };
+    BarAutomationLane::Cursor cursor;
+    for (int bar : bars) {
+        if (lane.evaluateAt(bar, cursor) != lane.evaluateAt(bar)) {
+            stats.fail("bar_automation", "Cursor evaluation differs from search");
+            return false;
+        }
+    }
+    if (lane.evaluateAt(-1) != 0.0f || lane.evaluateAt(5) != 0.6f || lane.evaluateAt(100) != 0.8f) {
+        stats.fail("bar_automation", "Wrong step-function value");
+        return false;
+    }
+
+    // A swing lane plays exactly like the same base swing
+    auto renderOffbeats = [](float baseSwing, const BarAutomationLane& swingLane, int bars = 1) {
+        StepSequencer seq;
+        seq.prepare(48000.0, 512);
+        seq.reset();
+        seq.setTempo(120.0f);
+        seq.setSwing(baseSwing);
+        seq.setSwingAutomation(swingLane);
+        Track hats = seq.getTrack(2);
+        for (int step = 1; step < 16; step += 2)
+            hats.steps.edit(step).active = true;
+        seq.setTrack(2, hats);
+        return collectTrackHits(seq, 2, bars * 16 * 6000);
+    };
+
+    BarAutomationLane swing;
+    swing.addPoint(0, 0.6f);
+    const std::vector<int> automated = renderOffbeats(0.0f, swing);
+    if (automated.size() != 8 || automated != renderOffbeats(0.6f, BarAutomationLane())
+        || automated == renderOffbeats(0.0f, BarAutomationLane())) {
+        stats.fail("bar_automation", "Swing lane not applied");
+        return false;
+    }
+
+    // Lanes follow the song bar, not the 16-step loop: a point at bar 1
+    // takes effect on the second pass through the pattern
+    BarAutomationLane swingFromBar1;
+    swingFromBar1.addPoint(1, 0.6f);
+    const std::vector<int> twoBars = renderOffbeats(0.0f, swingFromBar1, 2);
+    const std::vector<int> straight = renderOffbeats(0.0f, BarAutomationLane(), 2);
+    const std::vector<int> swung = renderOffbeats(0.6f, BarAutomationLane(), 2);
+    if (twoBars.size() != 16 || straight.size() != 16 || swung.size() != 16
+        || !std::equal(twoBars.begin(), twoBars.begin() + 8, straight.begin())
+        || !std::equal(twoBars.begin() + 8, twoBars.end(), swung.begin() + 8)
+        || std::equal(twoBars.begin() + 8, twoBars.end(), straight.begin() + 8)) {
+        stats.fail("bar_automation", "Swing lane did not change after bar 1");
+        return false;
+    }
+
+    // Groove lanes are part of the binary state
+    DrumMachinePureDSP source;
+    source.prepare(48000.0, 512);
+    SequencerSnapshot snapshot;
+    snapshot.swingAutomation = swing;
+    snapshot.dillaAutomation.addPoint(2, 0.7f);
+    snapshot.parts = SequencerSnapshot::Groove;
+    snapshot.atBar = false;
+    source.publishPattern(snapshot);
+
+    std::vector<float> left(12000);
+    std::vector<float> right(12000);
+    processAudioInChunks(source, left.data(), right.data(), 12000);
+
+    std::vector<uint8_t> a(source.saveState(nullptr, 0));
+    source.saveState(a.data(), static_cast<int>(a.size()));
+    DrumMachinePureDSP restored;
+    restored.prepare(48000.0, 512);
+    DrumMachinePureDSP empty;
+    empty.prepare(48000.0, 512);
+    std::vector<uint8_t> plain(empty.saveState(nullptr, 0));
+    if (!restored.loadState(a.data(), static_cast<int>(a.size())) || a.size() <= plain.size()) {
+        stats.fail("bar_automation", "Groove automation not saved");
+        return false;
+    }
+    processAudioInChunks(restored, left.data(), right.data(), 12000);
+
+    std::vector<uint8_t> b(restored.saveState(nullptr, 0));
+    restored.saveState(b.data(), static_cast<int>(b.size()));
+    if (a != b) {
+        stats.fail("bar_automation", "Groove automation did not survive the state round trip");
+        return false;
+    }
+
+    stats.pass("bar_automation");
+    return true;
+}
+
+//==============================================================================
+// Test 23: Parameter Telemetry
+//==============================================================================
+
+bool testParameterTelemetry(TestStats& stats) {
+    std::cout << "\n[Test 23] Parameter Telemetry" << std::endl;
+
+    // Repeats of the last value are coalesced on push, runs of one
+    // parameter are merged on drain
+    ParameterTelemetry telemetry;
+    telemetry.push(DrumParam::Tempo, 120.0f, 121.0f);
+    telemetry.push(DrumParam::Tempo, 121.0f, 122.0f);
+    telemetry.push(DrumParam::Swing, 0.0f, 0.1f);
+    telemetry.push(DrumParam::Swing, 0.0f, 0.1f);
+
+    std::vector<TelemetryRecord> records;
+    telemetry.drain([&](const TelemetryRecord& r) { records.push_back(r); });
+    TelemetryStats counters = telemetry.getStats();
+    if (records.size() != 2 || records[0].param != DrumParam::Tempo || records[0].oldValue != 120.0f
+        || records[0].newValue != 122.0f || records[0].changes != 2 || records[1].param != DrumParam::Swing
+        || counters.recorded != 3 || counters.coalesced != 2 || counters.dropped != 0) {
+        stats.fail("parameter_telemetry", "Records not coalesced");
+        return false;
+    }
+
+    // A full ring drops and counts instead of blocking
+    for (int i = 0; i < 300; ++i)
+        telemetry.push(static_cast<DrumParam>(i % 2), 0.0f, static_cast<float>(i));
+    if (telemetry.getStats().dropped != 300 - ParameterTelemetry::kCapacity) {
+        stats.fail("parameter_telemetry", "Overflow not counted as dropped");
+        return false;
+    }
+    telemetry.drain([](const TelemetryRecord&) {});
+
+    // Producer and consumer running concurrently lose nothing uncounted
+    ParameterTelemetry ring;
+    const int numPushes = 100000;
+    std::atomic<bool> done{false};
+    uint64_t drained = 0;
+    std::thread consumer([&] {
+        while (!done.load())
+            ring.drain([&](const TelemetryRecord& r) { drained += r.changes; });
+        ring.drain([&](const TelemetryRecord& r) { drained += r.changes; });
+    });
+    for (int i = 0; i < numPushes; ++i)
+        ring.push(static_cast<DrumParam>(i % 3), 0.0f, static_cast<float>(i));
+    done.store(true);
+    consumer.join();
+
+    counters = ring.getStats();
+    if (counters.recorded + counters.dropped != static_cast<uint64_t>(numPushes) || drained != counters.recorded) {
+        stats.fail("parameter_telemetry", "Concurrent records lost");
+        return false;
+    }
+
+    // setParameter records changed values only
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    const uint64_t before = dm.getTelemetryStats().recorded;
+    dm.setParameter(DrumParam::Swing, 0.25f);
+    dm.setParameter(DrumParam::Swing, 0.25f);
+    if (dm.getTelemetryStats().recorded != before + 1) {
+        stats.fail("parameter_telemetry", "setParameter not recorded once");
+        return false;
+    }
+
+    std::cout << "    " << counters.dropped << " of " << numPushes << " concurrent records dropped" << std::endl;
+    stats.pass("parameter_telemetry");
+    return true;
+}
+
+//==============================================================================
+// Test 24: Render Profiling
+//==============================================================================
+
+bool testRenderProfiling(TestStats& stats) {
+    std::cout << "\n[Test 24] Render Profiling" << std::endl;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+
+    SequencerSnapshot snapshot;
+    for (int step = 0; step < 16; step += 2)
+        snapshot.tracks[0].steps.edit(step).active = true;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = false;
+    dm.publishPattern(snapshot);
+
+    std::vector<float> left(48000);
+    std::vector<float> right(48000);
+    processAudioInChunks(dm, left.data(), right.data(), 48000);
+    float* outputs[2] = { left.data(), right.data() };
+    dm.processStereo(outputs, 2, 512);
+
+    const RenderProfile profile = dm.getRenderProfile();
+#if DRUMMACHINE_PROFILING
+    const int numBlocks = (48000 + 511) / 512 + 1;
+    const int kick = static_cast<int>(Track::DrumType::Kick);
+    if (profile.blocks != static_cast<uint64_t>(numBlocks) || profile.voiceGroupNs[kick] == 0
+        || profile.stageNs[static_cast<int>(ProfileStage::Sequencer)] == 0
+        || profile.stageNs[static_cast<int>(ProfileStage::Voices)] < profile.voiceGroupNs[kick]
+        || profile.worstBlockNs < profile.lastBlockNs || profile.totalNs < profile.worstBlockNs
+        || profile.averageLoad <= 0.0f || profile.worstLoad < profile.averageLoad) {
+        stats.fail("render_profiling", "Counters not recorded");
+        return false;
+    }
+
+    std::cout << "    Average load " << profile.averageLoad * 100.0f << "%, worst block "
+              << profile.worstBlockNs / 1000 << " us, kick " << profile.voiceGroupNs[kick] / 1000 << " us" << std::endl;
+
+    dm.resetRenderProfile();
+    if (dm.getRenderProfile().blocks != 0 || dm.getRenderProfile().worstBlockNs != 0) {
+        stats.fail("render_profiling", "Reset did not clear the counters");
+        return false;
+    }
+#else
+    if (profile.blocks != 0) {
+        stats.fail("render_profiling", "Counters recorded with profiling compiled out");
+        return false;
+    }
+#endif
+
+    stats.pass("render_profiling");
+    return true;
+}
+
+//==============================================================================
+// Test 25: Idle Fast Path and Voice Sleep
+//==============================================================================
+
+bool testIdleFastPath(TestStats& stats) {
+    std::cout << "\n[Test 25] Idle Fast Path and Voice Sleep" << std::endl;
+
+    // A voice stops rendering once it falls below its isActive() threshold
+    KickVoice kick;
+    kick.prepare(48000.0);
+    kick.trigger(1.0f);
+    std::vector<float> tail(5 * 48000, 0.0f);
+    kick.processBlock(tail.data(), static_cast<int>(tail.size()));
+    int lastSample = 0;
+    for (int i = 0; i < static_cast<int>(tail.size()); ++i)
+        if (tail[i] != 0.0f) lastSample = i;
+    if (kick.isActive() || lastSample > 2 * 48000) {
+        stats.fail("idle_fast_path", "Voice kept rendering after its envelope ended");
+        return false;
+    }
+
+    // Empty pattern: every block is idle and flagged silent
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    SequencerSnapshot empty;
+    empty.parts = SequencerSnapshot::Tracks;
+    empty.atBar = false;
+    dm.publishPattern(empty);
+
+    std::vector<float> left(512, 1.0f);
+    std::vector<float> right(512, 1.0f);
+    float* outputs[2] = { left.data(), right.data() };
+    for (int block = 0; block < 8; ++block)
+        dm.processStereo(outputs, 2, 512);
+    if (!dm.isLastBlockSilent() || getPeakLevel(left.data(), 512) != 0.0f) {
+        stats.fail("idle_fast_path", "Empty pattern not rendered as silent");
+        return false;
+    }
+
+    // A note wakes the instance, which goes idle again after the tail
+    ScheduledEvent note;
+    note.type = ScheduledEvent::NOTE_ON;
+    note.sampleOffset = 100;
+    note.data.note.midiNote = 36;
+    note.data.note.velocity = 1.0f;
+    dm.handleEvent(note);
+    dm.process(outputs, 2, 512);
+    if (dm.isLastBlockSilent() || getPeakLevel(left.data(), 512) == 0.0f) {
+        stats.fail("idle_fast_path", "Triggered block flagged silent");
+        return false;
+    }
+
+    int idleAfter = -1;
+    for (int block = 1; block < 1000 && idleAfter < 0; ++block) {
+        dm.process(outputs, 2, 512);
+        if (dm.isLastBlockSilent()) idleAfter = block;
+    }
+    if (idleAfter < 0 || getPeakLevel(left.data(), 512) != 0.0f) {
+        stats.fail("idle_fast_path", "Instance did not go idle after the tail");
+        return false;
+    }
+
+    std::cout << "    Idle " << idleAfter << " blocks after the hit" << std::endl;
+    stats.pass("idle_fast_path");
+    return true;
+}
+
+//==============================================================================
+// Test 26: Output Bus Routing
+//==============================================================================
+
+bool testOutputBuses(TestStats& stats) {
+    std::cout << "\n[Test 26] Output Bus Routing" << std::endl;
+
+    // Kick on track 0, snare on track 1
+    SequencerSnapshot pattern;
+    pattern.tracks[0].type = Track::DrumType::Kick;
+    pattern.tracks[0].steps.edit(0).active = true;
+    pattern.tracks[1].type = Track::DrumType::Snare;
+    pattern.tracks[1].steps.edit(2).active = true;
+    pattern.parts = SequencerSnapshot::Tracks;
+    pattern.atBar = false;
+
+    // Up to 4 buses (8 channels); nullBus1 passes a null pair for bus 1
+    const int numSamples = 48000 / 2;
+    auto render = [&](OutputBusLayout layout, int numChannels, bool nullBus1, int threads) {
+        DrumMachinePureDSP dm;
+        dm.setParameter(DrumParam::Tempo, 120.0f);
+        dm.setRenderThreads(threads);
+        dm.prepare(48000.0, 512);
+        dm.setOutputBusLayout(layout);
+        dm.publishPattern(pattern);
+
+        std::vector<std::vector<float>> buses(8, std::vector<float>(numSamples, 0.0f));
+        for (int offset = 0; offset < numSamples; offset += 512) {
+            float* outputs[8];
+            for (int ch = 0; ch < 8; ++ch)
+                outputs[ch] = buses[ch].data() + offset;
+            if (nullBus1) outputs[2] = outputs[3] = nullptr;
+            dm.process(outputs, numChannels, std::min(512, numSamples - offset));
+        }
+        return buses;
+    };
+
+    const auto mix = render(OutputBusLayout::Mix, 2, false, 1);
+    const auto perTrack = render(OutputBusLayout::PerTrack, 8, false, 1);
+
+    // Each track lands on its own bus only, and the buses sum to the mix
+    const float bus0 = getPeakLevel(perTrack[0].data(), numSamples);
+    const float bus1 = getPeakLevel(perTrack[2].data(), numSamples);
+    const float bus2 = getPeakLevel(perTrack[4].data(), numSamples);
+    if (bus0 == 0.0f || bus1 == 0.0f || bus2 != 0.0f) {
+        stats.fail("output_buses", "Per-track routing put tracks on the wrong buses");
+        return false;
+    }
+    float sumError = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            sumError = std::max(sumError, std::abs(perTrack[ch][i] + perTrack[ch + 2][i] - mix[ch][i]));
+    if (sumError > 1.0e-5f) {
+        stats.fail("output_buses", "Buses do not sum to the stereo mix");
+        return false;
+    }
+
+    // Buses the caller did not provide fall back to bus 0
+    const auto twoChannels = render(OutputBusLayout::PerTrack, 2, false, 1);
+    const auto nullPair = render(OutputBusLayout::PerTrack, 8, true, 1);
+    if (twoChannels[0] != mix[0] || twoChannels[1] != mix[1] || nullPair[0] != mix[0]) {
+        stats.fail("output_buses", "Missing bus did not fall back to the main output");
+        return false;
+    }
+
+    // Parallel render mixes every bus the same way
+    const auto parallel = render(OutputBusLayout::PerTrack, 8, false, 4);
+    for (int ch = 0; ch < 8; ++ch) {
+        for (int i = 0; i < numSamples; ++i) {
+            if (std::abs(parallel[ch][i] - perTrack[ch][i]) > 1.0e-5f) {
+                stats.fail("output_buses", "Parallel bus render differs from serial");
+                return false;
+            }
+        }
+    }
+
+    // Groups by drum family; custom routing survives the binary state
+    DrumMachinePureDSP source;
+    source.setOutputBusLayout(OutputBusLayout::Groups);
+    if (source.getTrackOutputBus(0) != 0 || source.getTrackOutputBus(1) != 1 || source.getTrackOutputBus(2) != 2) {
+        stats.fail("output_buses", "Group layout routed kick/snare/hat to the wrong buses");
+        return false;
+    }
+    source.setTrackOutputBus(5, 9);
+    std::vector<uint8_t> state(source.saveState(nullptr, 0));
+    source.saveState(state.data(), static_cast<int>(state.size()));
+
+    DrumMachinePureDSP target;
+    if (!target.loadState(state.data(), static_cast<int>(state.size()))
+        || target.getOutputBusLayout() != OutputBusLayout::Custom
+        || target.getTrackOutputBus(5) != 9 || target.getTrackOutputBus(1) != 1) {
+        stats.fail("output_buses", "Custom routing lost in the state round trip");
+        return false;
+    }
+
+    std::cout << "    Bus peaks: " << bus0 << " / " << bus1 << std::endl;
+    stats.pass("output_buses");
+    return true;
+}
+
+//==============================================================================
+// Test 27: Pre-rendered Hit Cache
+//==============================================================================
+
+bool testHitCache(TestStats& stats) {
+    std::cout << "\n[Test 27] Pre-rendered Hit Cache" << std::endl;
+
+    // One kick note on a fresh instance; returns the rendered left channel
+    auto renderNote = [](DrumMachinePureDSP& dm, float velocity) {
+        ScheduledEvent note;
+        note.type = ScheduledEvent::NOTE_ON;
+        note.sampleOffset = 0;
+        note.data.note.midiNote = 36;
+        note.data.note.velocity = velocity;
+        dm.handleEvent(note);
+
+        std::vector<float> left(8192, 0.0f);
+        std::vector<float> right(8192, 0.0f);
+        processAudioInChunks(dm, left.data(), right.data(), 8192);
+        return left;
+    };
+    auto waitForBuild = [](DrumMachinePureDSP& dm, uint32_t builds) {
+        for (int i = 0; i < 300 && dm.getHitCacheBuildCount() < builds; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return dm.getHitCacheBuildCount() >= builds;
+    };
+
+    DrumMachinePureDSP live;
+    live.prepare(48000.0, 512);
+    const auto liveFull = renderNote(live, 1.0f);
+    if (live.isHitCacheActive()) {
+        stats.fail("hit_cache", "Cache active without being enabled");
+        return false;
+    }
+
+    DrumMachinePureDSP cached;
+    cached.prepare(48000.0, 512);
+    cached.setHitCacheEnabled(true);
+    if (!waitForBuild(cached, 1)) {
+        stats.fail("hit_cache", "Cache was never built");
+        return false;
+    }
+
+    // A full-velocity layer is the fresh voice's own hit
+    const auto cachedFull = renderNote(cached, 1.0f);
+    float maxError = 0.0f;
+    for (size_t i = 0; i < liveFull.size(); ++i)
+        maxError = std::max(maxError, std::abs(cachedFull[i] - liveFull[i]));
+    if (!cached.isHitCacheActive() || getPeakLevel(cachedFull.data(), 8192) == 0.0f || maxError > 1.0e-4f) {
+        stats.fail("hit_cache", "Cached hit differs from the synthesized one");
+        return false;
+    }
+
+    // Between layers: the nearest layer scaled to the velocity
+    DrumMachinePureDSP liveSoft;
+    liveSoft.prepare(48000.0, 512);
+    const float livePeak = getPeakLevel(renderNote(liveSoft, 0.55f).data(), 8192);
+    const float cachedPeak = getPeakLevel(renderNote(cached, 0.55f).data(), 8192);
+    if (std::abs(cachedPeak - livePeak) > 0.1f * livePeak) {
+        stats.fail("hit_cache", "Velocity layer not scaled to the hit");
+        return false;
+    }
+
+    // New kit: hits synthesize until the cache is rebuilt
+    DecodedPreset kit;
+    kit.hasVoices = true;
+    cached.applyPreset(kit);
+    const auto duringRebuild = renderNote(cached, 1.0f);
+    if (cached.isHitCacheActive() || getPeakLevel(duringRebuild.data(), 8192) == 0.0f) {
+        stats.fail("hit_cache", "Stale cache played after a kit change");
+        return false;
+    }
+    if (!waitForBuild(cached, 2)) {
+        stats.fail("hit_cache", "Cache not rebuilt after a kit change");
+        return false;
+    }
+    renderNote(cached, 1.0f);
+    if (!cached.isHitCacheActive()) {
+        stats.fail("hit_cache", "Rebuilt cache not picked up");
+        return false;
+    }
+
+    std::cout << "    Peak at 0.55: live " << livePeak << ", cached " << cachedPeak << std::endl;
+    stats.pass("hit_cache");
+    return true;
+}
+
+//==============================================================================
+// Test 28: Sample-Rate Independent Envelopes
+//==============================================================================
+
+// Seconds until the voice goes idle after a full-velocity hit
+template <typename Voice>
+double voiceRingTime(double sampleRate) {
+    Voice voice;
+    voice.prepare(sampleRate);
+    voice.trigger(1.0f);
+
+    float out = 0.0f;
+    int64_t samples = 0;
+    while (voice.isActive() && samples < static_cast<int64_t>(sampleRate * 10.0)) {
+        voice.processBlock(&out, 1);
+        ++samples;
+    }
+    return static_cast<double>(samples) / sampleRate;
+}
+
+// Relative ring time error against 48 kHz, beyond the control block each
+// rate rounds the end of the tail to
+template <typename Voice>
+double maxRingTimeError() {
+    const double reference = voiceRingTime<Voice>(48000.0);
+    double worst = 0.0;
+    for (double sampleRate : { 44100.0, 96000.0, 192000.0 }) {
+        const double quantum = kVoiceControlBlock / sampleRate + kVoiceControlBlock / 48000.0;
+        const double error = std::abs(voiceRingTime<Voice>(sampleRate) - reference) - quantum;
+        worst = std::max(worst, error / reference);
+    }
+    return worst;
+}
+
+bool testSampleRateEnvelopes(TestStats& stats) {
+    std::cout << "\n[Test 28] Sample-Rate Independent Envelopes" << std::endl;
+
+    double errors[] = {
+        maxRingTimeError<KickVoice>(),
+        maxRingTimeError<SnareVoice>(),
+        maxRingTimeError<HiHatVoice>(),
+        maxRingTimeError<ClapVoice>(),
+        maxRingTimeError<PercVoice>(),
+        maxRingTimeError<CymbalVoice>()
+    };
+
+    double worst = *std::max_element(std::begin(errors), std::end(errors));
+    std::cout << "    Max ring time deviation from 48 kHz: " << worst * 100.0 << "%" << std::endl;
+
+    if (worst > 0.02) {
+        stats.fail("sample_rate_envelopes", "Voice decay time depends on the sample rate");
+        return false;
+    }
+
+    stats.pass("sample_rate_envelopes");
+    return true;
+}
+
+//==============================================================================
+// Test 29: Voice Registry
+//==============================================================================
+
+bool testVoiceRegistry(TestStats& stats) {
+    std::cout << "\n[Test 29] Voice Registry" << std::endl;
+
+    static_assert(std::is_same<DrumVoiceTraits<Track::DrumType::Kick>::Voice, KickVoice>::value, "kick voice");
+    static_assert(std::is_same<DrumVoiceTraits<Track::DrumType::Ride>::Voice, CymbalVoice>::value, "ride voice");
+    static_assert(std::is_same<DrumVoiceTraits<Track::DrumType::TomMid>::Voice, PercVoice>::value, "tom voice");
+
+    // Every type's pool takes its registered defaults and plays on track 0
+    StepSequencer seq;
+    seq.prepare(48000.0, 512);
+    seq.reset();
+
+    int maxPolyphony = 0;
+    bool allSound = true;
+    bool defaultsApplied = true;
+    forEachDrumVoiceType([&](auto type) {
+        using Traits = DrumVoiceTraitsAt<decltype(type)::value>;
+        const auto drumType = static_cast<Track::DrumType>(decltype(type)::value);
+        maxPolyphony += Traits::polyphony;
+        defaultsApplied = defaultsApplied && seq.getVoicePolyphony(drumType) == Traits::polyphony;
+
+        Track track = seq.getTrack(0);
+        track.type = drumType;
+        seq.setTrack(0, track);
+
+        std::vector<float> out(256, 0.0f);
+        seq.triggerTrack(0, 0, 1.0f);
+        seq.dispatchDueHits();
+        seq.processTrack(0, out.data(), 256);
+        allSound = allSound && getPeakLevel(out.data(), 256) > 0.0f;
+    });
+
+    if (!defaultsApplied || seq.getMaxPolyphony() != maxPolyphony) {
+        stats.fail("voice_registry", "Pool defaults differ from the registry");
+        return false;
+    }
+    if (!allSound) {
+        stats.fail("voice_registry", "A registered drum type did not sound");
+        return false;
+    }
+
+    std::cout << "    Registered voices: " << kNumDrumVoiceTypes << ", total polyphony " << maxPolyphony << std::endl;
+    stats.pass("voice_registry");
+    return true;
+}
+
+//==============================================================================
+// Test 30: Batch Rendering
+//==============================================================================
+
+bool testBatchRendering(TestStats& stats) {
+    std::cout << "\n[Test 30] Batch Rendering" << std::endl;
+
+    // Instance i: its own tempo, a track playing every (i + 1)th step and
+    // a kick on its own rhythm, so kick voices overlap and steal
+    const int numInstances = 7;
+    auto configure = [](DrumMachinePureDSP& dm, int i) {
+        dm.setParameter(DrumParam::Tempo, 120.0f + 10.0f * i);
+        SequencerSnapshot snapshot;
+        for (int step = 0; step < 16; step += i + 1)
+            snapshot.tracks[i % 16].steps.edit(step).active = true;
+        snapshot.tracks[i % 16].type = static_cast<Track::DrumType>(i % kNumDrumVoiceTypes);
+        for (int step = i % 3; step < 16; step += 2 + i % 3)
+            snapshot.tracks[15].steps.edit(step).active = true;
+        snapshot.tracks[15].type = Track::DrumType::Kick;
+        snapshot.parts = SequencerSnapshot::Tracks;
+        snapshot.atBar = false;
+        dm.publishPattern(snapshot);
+    };
+
+    // Sharded per instance and with the kicks in the shared kernel
+    const int blockSize = 256;
+    for (bool kickKernel : { false, true }) {
+        DrumMachineBatch batch(numInstances);
+        std::vector<DrumMachinePureDSP> reference(numInstances);
+        for (int i = 0; i < numInstances; ++i) {
+            configure(batch.getInstance(i), i);
+            configure(reference[i], i);
+            reference[i].prepare(48000.0, blockSize);
+        }
+        batch.setKickKernel(kickKernel);
+        batch.prepare(48000.0, blockSize, 3);
+
+        std::vector<float> batchBuffer(static_cast<size_t>(numInstances) * 2 * blockSize);
+        std::vector<float*> batchOutputs(numInstances * 2);
+        for (int ch = 0; ch < numInstances * 2; ++ch)
+            batchOutputs[ch] = batchBuffer.data() + static_cast<size_t>(ch) * blockSize;
+
+        std::vector<float> left(blockSize), right(blockSize);
+        float* outputs[2] = { left.data(), right.data() };
+        float maxDiff = 0.0f;
+        float peak = 0.0f;
+        for (int block = 0; block < 200; ++block) {
+            batch.process(batchOutputs.data(), 2, blockSize);
+            for (int i = 0; i < numInstances; ++i) {
+                reference[i].process(outputs, 2, blockSize);
+                for (int n = 0; n < blockSize; ++n) {
+                    maxDiff = std::max(maxDiff, std::abs(batchOutputs[i * 2][n] - left[n]));
+                    maxDiff = std::max(maxDiff, std::abs(batchOutputs[i * 2 + 1][n] - right[n]));
+                    peak = std::max(peak, std::abs(left[n]));
+                }
+            }
+        }
+
+        std::cout << "    Kick kernel " << (kickKernel ? "on" : "off") << ", threads: " << batch.getRenderThreads()
+                  << ", max deviation " << maxDiff << std::endl;
+        if (batch.getRenderThreads() != 3 || peak == 0.0f || maxDiff != 0.0f) {
+            stats.fail("batch_rendering", "Batch output differs from independent instances");
+            return false;
+        }
+    }
+
+    // A parameter column reaches every instance
+    DrumMachineBatch batch(numInstances);
+    batch.prepare(48000.0, blockSize, 1);
+    std::vector<float> swing(numInstances);
+    for (int i = 0; i < numInstances; ++i) swing[i] = 0.1f * i;
+    batch.setParameter(DrumParam::Swing, swing.data());
+    for (int i = 0; i < numInstances; ++i) {
+        if (batch.getInstance(i).getParameter(DrumParam::Swing) != swing[i]) {
+            stats.fail("batch_rendering", "Parameter column not applied per instance");
+            return false;
+        }
+    }
+
+    stats.pass("batch_rendering");
+    return true;
+}
+
+//==============================================================================
+// Test 31: Random Streams
+//==============================================================================
+
+bool testRandomStreams(TestStats& stats) {
+    std::cout << "\n[Test 31] Random Streams" << std::endl;
+
+    // Block fills and jump-ahead land on the same values as single draws
+    const uint32_t key = RandomStream::makeKey(7u, 3u, 11u);
+    float filled[37];
+    uint32_t counter = 5;
+    RandomStream::fillSigned(key, counter, filled, 37);
+    bool streamOk = counter == 42;
+    for (int i = 0; i < 37; ++i)
+        streamOk = streamOk && filled[i] == RandomStream::toSigned(RandomStream::at(key, 5u + i));
+
+    DeterministicRng sequential(key);
+    for (int i = 0; i < 40; ++i) sequential.nextU32();
+    DeterministicRng jumped;
+    jumped.seek(key, 40);
+    for (int i = 0; i < 40; ++i)
+        streamOk = streamOk && sequential.nextU32() == jumped.nextU32();
+
+    if (!streamOk) {
+        stats.fail("random_streams", "Block fill or seek disagrees with single draws");
+        return false;
+    }
+
+    // Track 0 rolls a coin per step; adding a second coin-flipping track
+    // must not change which kick hits play
+    DrumPattern alone{};
+    for (int track = 0; track < 16; ++track)
+        alone[track].type = static_cast<Track::DrumType>(track < 15 ? track : 14);
+    for (int step = 0; step < 16; ++step) {
+        alone[0].steps.edit(step).active = true;
+        alone[0].steps.edit(step).probability = 0.5f;
+    }
+    DrumPattern shared = alone;
+    for (int step = 0; step < 16; ++step) {
+        shared[1].steps.edit(step).active = true;
+        shared[1].steps.edit(step).probability = 0.5f;
+    }
+
+    const int numBars = 4;
+    const OfflineChainSlot aloneChain[] = { { &alone, numBars } };
+    const OfflineChainSlot sharedChain[] = { { &shared, numBars } };
+    OfflineRenderSettings settings;
+    settings.sampleRate = 48000.0;
+    settings.blockSize = 512;
+    settings.output = OfflineRenderOutput::TrackStems;
+    settings.chainLength = 1;
+
+    DrumMachinePureDSP dm;
+    CollectingSink aloneStems;
+    CollectingSink sharedStems;
+    settings.chain = aloneChain;
+    bool ok = dm.renderOffline(settings, aloneStems);
+    settings.chain = sharedChain;
+    ok = ok && dm.renderOffline(settings, sharedStems);
+    if (!ok || aloneStems.channels.size() != 32 || sharedStems.channels.size() != 32) {
+        stats.fail("random_streams", "Offline render failed");
+        return false;
+    }
+
+    const std::vector<float>& kickAlone = aloneStems.channels[0];
+    const std::vector<float>& kickShared = sharedStems.channels[0];
+    const size_t length = std::min(kickAlone.size(), kickShared.size());
+    float trackDiff = 0.0f;
+    for (size_t i = 0; i < length; ++i)
+        trackDiff = std::max(trackDiff, std::abs(kickAlone[i] - kickShared[i]));
+
+    // Each bar draws from its own stream: bars differ
+    const size_t barLength = static_cast<size_t>(48000.0 * 60.0 / 120.0 * 4.0);
+    float barDiff = 0.0f;
+    for (size_t i = 0; i < barLength && 2 * barLength <= length; ++i)
+        barDiff = std::max(barDiff, std::abs(kickAlone[i] - kickAlone[i + barLength]));
+
+    std::cout << "    Kick stem diff with second track: " << trackDiff
+              << ", bar 1 vs bar 2: " << barDiff << std::endl;
+    if (trackDiff != 0.0f || barDiff == 0.0f) {
+        stats.fail("random_streams", "Track streams not independent per track and bar");
+        return false;
+    }
+
+    stats.pass("random_streams");
+    return true;
+}
+
+//==============================================================================
+// Test 32: Shared Lookup Tables
+//==============================================================================
+
+bool testLookupTables(TestStats& stats) {
+    std::cout << "\n[Test 32] Shared Lookup Tables" << std::endl;
+
+    // One set per process, whichever thread or instance asks first
+    const DrumLookupTables* fromThread = nullptr;
+    std::thread other([&] { fromThread = &DrumLookupTables::get(); });
+    other.join();
+    DrumMachinePureDSP first;
+    DrumMachinePureDSP second;
+    const DrumLookupTables& tables = DrumLookupTables::get();
+    if (fromThread != &tables) {
+        stats.fail("lookup_tables", "Tables are not shared process-wide");
+        return false;
+    }
+
+    // Interpolated sine across several cycles, negative phases included
+    float sineError = 0.0f;
+    for (int i = -3000; i <= 3000; ++i) {
+        const float cycles = static_cast<float>(i) * 0.001f + 0.0003f;
+        sineError = std::max(sineError, std::abs(tables.sineCycles(cycles) - static_cast<float>(std::sin(2.0 * M_PI * cycles))));
+    }
+
+    // Constant power at every pan point
+    float powerError = 0.0f;
+    for (int i = 0; i < DrumLookupTables::kPanSize; ++i) {
+        const float power = tables.panLeft[i] * tables.panLeft[i] + tables.panRight[i] * tables.panRight[i];
+        powerError = std::max(powerError, std::abs(power - 1.0f));
+    }
+
+    std::cout << "    Sine error: " << sineError << ", pan power error: " << powerError << std::endl;
+    if (sineError > 1.0e-5f || powerError > 1.0e-5f) {
+        stats.fail("lookup_tables", "Table values off");
+        return false;
+    }
+
+    stats.pass("lookup_tables");
+    return true;
+}
+
+//==============================================================================
+// Test 33: Streaming State
+//==============================================================================
+
+// Appends everything written; optionally stops after some writes
+struct CollectingStateSink : StateSink {
+    std::vector<uint8_t> bytes;
+    int writes = 0;
+    int maxWrites = -1;
+
+    bool write(const void* data, int numBytes) override {
+        if (maxWrites >= 0 && writes >= maxWrites) return false;
+        ++writes;
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + numBytes);
+        return true;
+    }
+};
+
+std::vector<uint8_t> savedState(const DrumMachinePureDSP& dm) {
+    std::vector<uint8_t> state(static_cast<size_t>(dm.saveState(nullptr, 0)));
+    dm.saveState(state.data(), static_cast<int>(state.size()));
+    return state;
+}
+
+bool testStreamingState(TestStats& stats) {
+    std::cout << "\n[Test 33] Streaming State" << std::endl;
+
+    // A pattern long enough that both documents take several sink writes
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    SequencerSnapshot pattern;
+    for (int track = 0; track < 16; ++track) {
+        pattern.tracks[track].length = 64;
+        for (int step = track % 4; step < 64; step += 4)
+            pattern.tracks[track].steps.edit(step).active = true;
+    }
+    pattern.parts = SequencerSnapshot::Tracks;
+    pattern.atBar = false;
+    dm.publishPattern(pattern);
+    std::vector<float> left(512), right(512);
+    float* outputs[2] = { left.data(), right.data() };
+    dm.process(outputs, 2, 512);
+
+    // Streams match the buffer saves; the buffer size query is exact
+    CollectingStateSink stateSink;
+    CollectingStateSink presetSink;
+    const bool streamed = dm.saveState(stateSink) && dm.savePreset(presetSink);
+    const std::vector<uint8_t> state = savedState(dm);
+    const int presetSize = dm.getPresetSize();
+    std::vector<char> json(static_cast<size_t>(presetSize));
+    const bool fits = dm.savePresetEx(json.data(), presetSize, PRESET_ALL);
+    const bool sameJson = presetSink.bytes.size() + 1 == json.size()
+        && std::memcmp(presetSink.bytes.data(), json.data(), presetSink.bytes.size()) == 0;
+    const bool tooSmall = dm.savePresetEx(json.data(), presetSize - 1, PRESET_ALL);
+
+    std::cout << "    Preset " << presetSize << " bytes in " << presetSink.writes << " writes, state "
+              << state.size() << " bytes in " << stateSink.writes << " writes" << std::endl;
+    if (!streamed || stateSink.bytes != state || !fits || tooSmall || !sameJson
+        || presetSink.writes < 2 || stateSink.writes < 2) {
+        stats.fail("streaming_state", "Streamed saves differ from buffer saves");
+        return false;
+    }
+
+    // A sink that stops ends the save
+    CollectingStateSink stopping;
+    stopping.maxWrites = 1;
+    if (dm.saveState(stopping) || dm.savePreset(stopping)) {
+        stats.fail("streaming_state", "Save ignored a stopping sink");
+        return false;
+    }
+
+    // Only edited sections are dirty; their delta brings an older copy
+    // up to date
+    DrumMachinePureDSP copy;
+    copy.prepare(48000.0, 512);
+    copy.loadState(state.data(), static_cast<int>(state.size()));
+    copy.process(outputs, 2, 512);
+
+    dm.takeDirtySections();
+    dm.setParameter(DrumParam::Swing, 0.31f);
+    pattern.tracks[2].steps.edit(1).active = true;
+    dm.publishPattern(pattern);
+    dm.process(outputs, 2, 512);
+    const int dirty = dm.takeDirtySections();
+
+    CollectingStateSink delta;
+    dm.saveState(delta, dirty);
+    copy.loadState(delta.bytes.data(), static_cast<int>(delta.bytes.size()));
+    copy.process(outputs, 2, 512);
+
+    std::cout << "    Dirty sections " << dirty << ", delta " << delta.bytes.size() << " bytes" << std::endl;
+    if (dirty != (PRESET_GLOBAL | PRESET_PATTERN) || dm.getDirtySections() != 0
+        || delta.bytes.size() >= state.size() || savedState(copy) != savedState(dm)) {
+        stats.fail("streaming_state", "Dirty-section delta did not reproduce the state");
+        return false;
+    }
+
+    // Instances save concurrently without sharing anything
+    const int numThreads = 4;
+    std::vector<DrumMachinePureDSP> instances(numThreads);
+    std::vector<std::vector<uint8_t>> expected(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        instances[i].setParameter(DrumParam::Tempo, 100.0f + 10.0f * i);
+        expected[i] = savedState(instances[i]);
+    }
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> savers;
+    for (int i = 0; i < numThreads; ++i) {
+        savers.emplace_back([&, i] {
+            for (int n = 0; n < 50; ++n) {
+                CollectingStateSink sink;
+                if (!instances[i].saveState(sink) || sink.bytes != expected[i]) ++mismatches;
+            }
+        });
+    }
+    for (std::thread& saver : savers) saver.join();
+
+    if (mismatches.load() != 0) {
+        stats.fail("streaming_state", "Concurrent saves interfered");
+        return false;
+    }
+
+    stats.pass("streaming_state");
+    return true;
+}
+
+//==============================================================================
+// Test 34: Lookahead Scheduling and Host Transport
+//==============================================================================
+
+// One host block: follow the transport, resolve the block's steps up
+// front, then collect the hits for one track
+void renderHostBlock(StepSequencer& seq, const HostTransport& transport, int64_t blockStart,
+                     int blockSize, int trackIndex, std::vector<int64_t>& onsets) {
+    seq.syncToHost(transport);
+    seq.scheduleAhead(blockSize);
+    BlockHit hits[256];
+    const int numHits = seq.collectBlockHits(blockSize, hits, 256);
+    for (int h = 0; h < numHits; ++h)
+        if (hits[h].trackIndex == trackIndex)
+            onsets.push_back(blockStart + hits[h].sampleOffset);
+}
+
+// Kicks on steps 0 and 8 with no Dilla drift (pocket timing: on the grid)
+void prepareGridSequencer(StepSequencer& seq, int lookahead) {
+    seq.prepare(48000.0, 512);
+    seq.reset();
+    seq.setTempo(120.0f);
+    seq.setLookaheadSteps(lookahead);
+
+    DillaParams dilla;
+    dilla.amount = 0.0f;
+    seq.setDillaParams(dilla);
+
+    Track kick = seq.getTrack(0);
+    kick.steps.edit(0).active = true;
+    kick.steps.edit(8).active = true;
+    seq.setTrack(0, kick);
+}
+
+bool testHostTransport(TestStats& stats) {
+    std::cout << "\n[Test 34] Lookahead Scheduling and Host Transport" << std::endl;
+
+    // Resolving further ahead changes when decisions are made, not what
+    // they are: probability draws and groove offsets match lookahead 1
+    std::vector<int64_t> reference, ahead;
+    for (int lookahead : { 1, StepSequencer::kMaxLookaheadSteps }) {
+        StepSequencer seq;
+        seq.prepare(48000.0, 512);
+        seq.reset();
+        seq.setTempo(120.0f);
+        seq.setLookaheadSteps(lookahead);
+        Track snare = seq.getTrack(1);
+        for (int step = 0; step < 16; ++step) {
+            snare.steps.edit(step).active = true;
+            snare.steps.edit(step).probability = 0.5f;
+        }
+        seq.setTrack(1, snare);
+
+        std::vector<int64_t>& onsets = lookahead == 1 ? reference : ahead;
+        for (int64_t offset = 0; offset < 4 * 16 * 6000; offset += 512)
+            renderHostBlock(seq, HostTransport{}, offset, 512, 1, onsets);
+    }
+    std::cout << "    Hits @lookahead 1: " << reference.size() << ", @"
+              << StepSequencer::kMaxLookaheadSteps << ": " << ahead.size() << std::endl;
+    if (reference.empty() || reference != ahead) {
+        stats.fail("host_transport", "Lookahead changed the resolved hits");
+        return false;
+    }
+
+    // A tempo change mid-step keeps the musical position: half of step 0
+    // at 120 BPM (3000 samples), then 60 BPM puts step 8 at 3000 + 7.5 x 12000
+    {
+        StepSequencer seq;
+        prepareGridSequencer(seq, 1);
+        std::vector<int64_t> onsets;
+        renderHostBlock(seq, HostTransport{}, 0, 3000, 0, onsets);
+        seq.setTempo(60.0f);
+        for (int64_t offset = 3000; offset < 120000; offset += 512)
+            renderHostBlock(seq, HostTransport{}, offset, 512, 0, onsets);
+
+        std::cout << "    Step 8 after tempo change: " << (onsets.size() > 1 ? onsets[1] : -1) << std::endl;
+        if (onsets.size() != 2 || onsets[0] != 0 || std::abs(onsets[1] - 93000) > 1) {
+            stats.fail("host_transport", "Tempo change moved resolved steps off the grid");
+            return false;
+        }
+    }
+
+    // Host clock at 90 BPM (8000 samples per step), looping back to the
+    // start after 100 blocks: step 0 replays at the jump, step 8 after it
+    {
+        StepSequencer seq;
+        prepareGridSequencer(seq, 4);
+        HostTransport transport;
+        transport.valid = true;
+        transport.tempo = 90.0;
+
+        std::vector<int64_t> onsets;
+        for (int block = 0; block < 300; ++block) {
+            const int64_t position = static_cast<int64_t>(block) * 512;
+            transport.ppqPosition = (block < 100 ? position : position - 51200) / 32000.0;
+            renderHostBlock(seq, transport, position, 512, 0, onsets);
+        }
+
+        const std::vector<int64_t> expected = { 0, 51200, 51200 + 64000 };
+        std::cout << "    Looped onsets:";
+        for (int64_t onset : onsets) std::cout << " " << onset;
+        std::cout << std::endl;
+        if (seq.getSamplesPerStep() != 8000.0f || onsets != expected) {
+            stats.fail("host_transport", "Steps do not follow the host tempo and loop");
+            return false;
+        }
+    }
+
+    // Tempo ramp 100 -> 160 BPM, integrated by the host within each block:
+    // the step clock stays locked without re-resolving (no doubled hits)
+    {
+        StepSequencer seq;
+        prepareGridSequencer(seq, 2);
+        HostTransport transport;
+        transport.valid = true;
+
+        std::vector<int64_t> onsets;
+        double ppq = 0.0;
+        double worstDrift = 0.0;
+        for (int block = 0; block < 1000; ++block) {
+            const double startTempo = 100.0 + 60.0 * block / 1000.0;
+            const double endTempo = 100.0 + 60.0 * (block + 1) / 1000.0;
+            transport.tempo = startTempo;
+            transport.ppqPosition = ppq;
+            renderHostBlock(seq, transport, static_cast<int64_t>(block) * 512, 512, 0, onsets);
+
+            // Where the host is at the next block, against the step clock
+            ppq += 512.0 / 48000.0 * (startTempo + endTempo) * 0.5 / 60.0;
+            worstDrift = std::max(worstDrift, std::abs(seq.getStepPosition() - ppq * 4.0));
+        }
+
+        const int expectedHits = static_cast<int>(ppq * 4.0 / 8.0) + 1;
+        std::cout << "    Ramp hits: " << onsets.size() << " (expected " << expectedHits
+                  << "), worst drift " << worstDrift << " steps" << std::endl;
+        if (static_cast<int>(onsets.size()) != expectedHits || worstDrift > 0.01) {
+            stats.fail("host_transport", "Step clock lost the host during a tempo ramp");
+            return false;
+        }
+    }
+
+    stats.pass("host_transport");
+    return true;
+}
+
+//==============================================================================
+// Test 35: Malformed Presets Rejected
+//==============================================================================
+
+// DRMS v1 header plus one chunk
+std::vector<uint8_t> stateBlob(const char* fourcc, const std::vector<uint8_t>& payload) {
+    const uint32_t length = static_cast<uint32_t>(payload.size());
+    std::vector<uint8_t> blob(16 + payload.size());
+    const uint8_t header[8] = { 'D', 'R', 'M', 'S', 1, 0, 0, 0 };
+    std::memcpy(blob.data(), header, 8);
+    std::memcpy(blob.data() + 8, fourcc, 4);
+    for (int i = 0; i < 4; ++i) blob[12 + i] = static_cast<uint8_t>(length >> (8 * i));
+    std::copy(payload.begin(), payload.end(), blob.begin() + 16);
+    return blob;
+}
+
+bool testMalformedPresets(TestStats& stats) {
+    std::cout << "\n[Test 35] Malformed Presets Rejected" << std::endl;
+
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    const std::vector<uint8_t> before = savedState(dm);
+
+    // Drum type 200 (PATN), timing role 7 (PTN2), drill grid 9 (DRIL: after
+    // enabled, eight floats and the burst range)
+    std::vector<uint8_t> badGrid(42, 0);
+    badGrid[41] = 9;
+    const std::vector<std::vector<uint8_t>> blobs = {
+        stateBlob("PATN", { 200 }),
+        stateBlob("PTN2", { 0, 7 }),
+        stateBlob("DRIL", badGrid),
+    };
+    std::cout << "    Bad type blob: " << blobs[0].size() << " bytes" << std::endl;
+    for (const std::vector<uint8_t>& blob : blobs) {
+        if (dm.loadState(blob.data(), static_cast<int>(blob.size()))) {
+            stats.fail("malformed_presets", "Out-of-range enum accepted");
+            return false;
+        }
+    }
+    if (savedState(dm) != before || dm.getPresetSize() <= 0) {
+        stats.fail("malformed_presets", "Rejected state was partly applied");
+        return false;
+    }
+
+    // JSON: an unsupported float rejects the document, a huge count is clamped
+    const char* infiniteVolume = R"({"pattern":{"tracks":[{"volume":1e999}]}})";
+    const char* hugeRoll = R"({"pattern":{"tracks":[{"steps":[{"active":true,"roll":true,"roll_notes":200000000}]}]}})";
+    DecodedPreset roll;
+    const bool rollDecoded = DrumMachinePureDSP::decodePreset(hugeRoll, PRESET_ALL, roll);
+    const int rollNotes = roll.pattern.tracks[0].steps[0].rollNotes;
+    std::cout << "    Roll notes after clamp: " << rollNotes << std::endl;
+    if (dm.loadPattern(infiniteVolume) || savedState(dm) != before) {
+        stats.fail("malformed_presets", "Infinite track volume accepted");
+        return false;
+    }
+    if (!rollDecoded || rollNotes < 1 || rollNotes > 16 || !dm.loadPattern(hugeRoll)) {
+        stats.fail("malformed_presets", "Roll count not clamped");
+        return false;
+    }
+
+    // The clamped roll renders within one block's budget
+    std::vector<float> left(512), right(512);
+    float* outputs[2] = { left.data(), right.data() };
+    const auto start = std::chrono::steady_clock::now();
+    for (int block = 0; block < 8; ++block) dm.process(outputs, 2, 512);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "    8 blocks with the roll: " << ms << " ms" << std::endl;
+    if (ms > 8 * 512 / 48.0) {
+        stats.fail("malformed_presets", "Clamped roll still too slow to render");
+        return false;
+    }
+
+    stats.pass("malformed_presets");
+    return true;
+}
+
 //==============================================================================
 // Main Test Runner
 //==============================================================================
@@ -344,6 +2515,34 @@ int main(int argc, char* argv[]) {
     testSampleRates(stats);
     testParameterChanges(stats);
     testStereoOutput(stats);
+    testSampleAccurateTiming(stats);
+    testVoiceStealing(stats);
+    testBlockKernels(stats);
+    testAllocationFreeRender(stats);
+    testTrackPan(stats);
+    testMidiSampleOffset(stats);
+    testParallelRender(stats);
+    testOfflineRender(stats);
+    testPatternPublish(stats);
+    testMicroHitBudget(stats);
+    testStateRoundTrip(stats);
+    testPresetBank(stats);
+    testStepIndex(stats);
+    testLongPatterns(stats);
+    testBarAutomation(stats);
+    testParameterTelemetry(stats);
+    testRenderProfiling(stats);
+    testIdleFastPath(stats);
+    testOutputBuses(stats);
+    testHitCache(stats);
+    testSampleRateEnvelopes(stats);
+    testVoiceRegistry(stats);
+    testBatchRendering(stats);
+    testRandomStreams(stats);
+    testLookupTables(stats);
+    testStreamingState(stats);
+    testHostTransport(stats);
+    testMalformedPresets(stats);
 
     stats.printSummary();
 
@@ -20,9 +20,7 @@ class DrumMachinePlugin  : public juce::AudioProcessor
 public:
     //==============================================================================
     DrumMachinePlugin()
-        : AudioProcessor (BusesProperties()
-                           .withInput ("Input",  juce::AudioChannelSet::stereo())
-                           .withOutput ("Output",  juce::AudioChannelSet::stereo())),
+        : AudioProcessor (makeBusesProperties()),
           currentPresetIndex (0),
           sampleRate (48000.0)
     {
@@ -30,7 +28,7 @@ public:
         addParameter (tempoParam = new juce::AudioParameterFloat ("tempo", "Tempo", 60.0f, 200.0f, 120.0f));
         addParameter (swingParam = new juce::AudioParameterFloat ("swing", "Swing", 0.0f, 1.0f, 0.0f));
         addParameter (masterVolumeParam = new juce::AudioParameterFloat ("master", "Master", 0.0f, 1.0f, 0.8f));
-        addParameter (patternLengthParam = new juce::AudioParameterFloat ("patternLength", "Pattern Length", 1.0f, 16.0f, 16.0f));
+        addParameter (patternLengthParam = new juce::AudioParameterFloat ("patternLength", "Pattern Length", 1.0f, 128.0f, 16.0f));
 
         // Role timing parameters
         addParameter (pocketOffsetParam = new juce::AudioParameterFloat ("pocketOffset", "Pocket Offset", -0.1f, 0.1f, 0.0f));
@@ -60,6 +58,32 @@ public:
             addParameter (trackVolumeParams[i] = new juce::AudioParameterFloat (paramName, paramLabel, 0.0f, 1.0f, 0.8f));
         }
 
+        // Track -> output bus routing (custom routing comes from the state)
+        addParameter (outputLayoutParam = new juce::AudioParameterChoice ("outputLayout", "Output Layout",
+                                                                          juce::StringArray { "Mix", "Per Track", "Groups" }, 0));
+
+        // Host parameter -> DSP parameter ID (host IDs stay as-is for session compatibility)
+        parameterBindings = {
+            { tempoParam, DSP::DrumParam::Tempo },
+            { swingParam, DSP::DrumParam::Swing },
+            { masterVolumeParam, DSP::DrumParam::MasterVolume },
+            { patternLengthParam, DSP::DrumParam::PatternLength },
+            { pocketOffsetParam, DSP::DrumParam::PocketOffset },
+            { pushOffsetParam, DSP::DrumParam::PushOffset },
+            { pullOffsetParam, DSP::DrumParam::PullOffset },
+            { dillaAmountParam, DSP::DrumParam::DillaAmount },
+            { dillaHatBiasParam, DSP::DrumParam::DillaHatBias },
+            { dillaSnareLateParam, DSP::DrumParam::DillaSnareLate },
+            { dillaKickTightParam, DSP::DrumParam::DillaKickTight },
+            { dillaMaxDriftParam, DSP::DrumParam::DillaMaxDrift },
+            { structureParam, DSP::DrumParam::Structure },
+            { stereoWidthParam, DSP::DrumParam::StereoWidth },
+            { roomWidthParam, DSP::DrumParam::RoomWidth },
+            { effectsWidthParam, DSP::DrumParam::EffectsWidth }
+        };
+        for (int i = 0; i < 16; ++i)
+            parameterBindings.push_back ({ trackVolumeParams[i], DSP::trackVolumeParam (i) });
+
         // Load factory presets
         loadFactoryPresets();
 
@@ -73,6 +97,35 @@ public:
 
     ~DrumMachinePlugin() override = default;
 
+    //==============================================================================
+    // Main stereo output plus one stereo aux per track, off until the host
+    // enables them
+    static BusesProperties makeBusesProperties()
+    {
+        auto buses = BusesProperties()
+                         .withInput ("Input",  juce::AudioChannelSet::stereo())
+                         .withOutput ("Output",  juce::AudioChannelSet::stereo());
+
+        for (int bus = 1; bus < DSP::DrumMachinePureDSP::kMaxOutputBuses; ++bus)
+            buses = buses.withOutput ("Bus " + juce::String (bus + 1), juce::AudioChannelSet::stereo(), false);
+
+        return buses;
+    }
+
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override
+    {
+        if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+            return false;
+
+        for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+        {
+            const auto& set = layouts.outputBuses.getReference (bus);
+            if (! set.isDisabled() && set != juce::AudioChannelSet::stereo())
+                return false;
+        }
+        return true;
+    }
+
     //==============================================================================
     void prepareToPlay (double newSampleRate, int samplesPerBlock) override
     {
@@ -99,35 +152,66 @@ public:
         // Update DSP parameters from host
         updateDSPParameters();
 
-        // Process MIDI for sequencer control
+        // Host clock: steps follow the playhead's tempo, transport and
+        // position (loops, tempo ramps); without one the sequencer free-runs
+        DSP::HostTransport transport;
+        if (auto* playHead = getPlayHead())
+        {
+            if (const auto position = playHead->getPosition())
+            {
+                if (const auto ppq = position->getPpqPosition())
+                {
+                    transport.valid = true;
+                    transport.playing = position->getIsPlaying();
+                    transport.ppqPosition = *ppq;
+                    transport.tempo = position->getBpm().orFallback (0.0);
+                }
+            }
+        }
+        drumMachine.setHostTransport (transport);
+
+        // Note-ons keep their sample position and velocity; the DSP maps the
+        // note to a track and queues it with the sequencer's own hits
         for (const auto metadata : midiMessages)
         {
             const auto message = metadata.getMessage();
 
-            // Note On triggers drums (mapped to tracks)
             if (message.isNoteOn())
             {
-                auto midiNote = message.getNoteNumber();
-                auto velocity = message.getVelocity() / 127.0f;
-
-                // Map MIDI notes to drum tracks
-                int trackIndex = midiNote % 16;
-                drumMachine.setParameter ("trackTrigger", static_cast<float>(trackIndex));
+                DSP::ScheduledEvent event;
+                event.type = DSP::ScheduledEvent::NOTE_ON;
+                event.time = 0.0;
+                event.sampleOffset = static_cast<uint32_t> (juce::jmax (0, metadata.samplePosition));
+                event.data.note.midiNote = message.getNoteNumber();
+                event.data.note.velocity = message.getFloatVelocity();
+                drumMachine.handleEvent (event);
             }
         }
 
-        // Process audio (stereo output)
+        // Process audio: one stereo pair per output bus, null for disabled
+        // buses (their tracks play on the main output)
         auto numSamples = buffer.getNumSamples();
-        auto* outputLeft = buffer.getWritePointer(0);
-        auto* outputRight = buffer.getWritePointer(1);
+        float* outputs[2 * DSP::DrumMachinePureDSP::kMaxOutputBuses] = {};
+        int numOutputChannels = 2;
+
+        const int numBuses = juce::jmin (getBusCount (false), DSP::DrumMachinePureDSP::kMaxOutputBuses);
+        for (int bus = 0; bus < numBuses; ++bus)
+        {
+            if (getChannelCountOfBus (false, bus) != 2)
+                continue;
+
+            const int firstChannel = getChannelIndexInProcessBlockBuffer (false, bus, 0);
+            outputs[2 * bus] = buffer.getWritePointer (firstChannel);
+            outputs[2 * bus + 1] = buffer.getWritePointer (firstChannel + 1);
+            numOutputChannels = 2 * (bus + 1);
+        }
 
-        // Create output array for DSP
-        float* outputs[2] = { outputLeft, outputRight };
-        drumMachine.process (outputs, 2, numSamples);
+        drumMachine.process (outputs, numOutputChannels, numSamples);
 
-        // Clear remaining channels if any
-        for (int channel = 2; channel < totalNumOutputChannels; ++channel)
-            buffer.clear(channel, 0, numSamples);
+        // Idle block: marks the buffer as cleared, so downstream processing
+        // can skip it (AudioBuffer::hasBeenCleared)
+        if (drumMachine.isLastBlockSilent())
+            buffer.clear();
     }
 
     //==============================================================================
@@ -200,68 +284,93 @@ public:
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override
     {
-        // Save current preset and parameters
-        juce::ValueTree state ("state");
-
-        state.setProperty ("tempo", tempoParam->get(), nullptr);
-        state.setProperty ("swing", swingParam->get(), nullptr);
-        state.setProperty ("master", masterVolumeParam->get(), nullptr);
-        state.setProperty ("patternLength", patternLengthParam->get(), nullptr);
-        state.setProperty ("pocketOffset", pocketOffsetParam->get(), nullptr);
-        state.setProperty ("pushOffset", pushOffsetParam->get(), nullptr);
-        state.setProperty ("pullOffset", pullOffsetParam->get(), nullptr);
-        state.setProperty ("dillaAmount", dillaAmountParam->get(), nullptr);
-        state.setProperty ("dillaHatBias", dillaHatBiasParam->get(), nullptr);
-        state.setProperty ("dillaSnareLate", dillaSnareLateParam->get(), nullptr);
-        state.setProperty ("dillaKickTight", dillaKickTightParam->get(), nullptr);
-        state.setProperty ("dillaMaxDrift", dillaMaxDriftParam->get(), nullptr);
-        state.setProperty ("structure", structureParam->get(), nullptr);
-        state.setProperty ("stereoWidth", stereoWidthParam->get(), nullptr);
-        state.setProperty ("roomWidth", roomWidthParam->get(), nullptr);
-        state.setProperty ("effectsWidth", effectsWidthParam->get(), nullptr);
-        state.setProperty ("preset", currentPresetIndex, nullptr);
-
-        juce::MemoryOutputStream stream (destData, false);
-        state.writeToStream (stream);
+        // Preset index plus the DSP's binary state (parameters, pattern,
+        // drill and kit). Streamed in one pass, so an edit landing while
+        // we save cannot leave a header over a state that did not fit.
+        bool saved = false;
+        {
+            juce::MemoryOutputStream stream (destData, false);
+            stream.writeIntBigEndian (static_cast<int> (kStateMagic));
+            stream.writeInt (currentPresetIndex);
+
+            StreamStateSink sink (stream);
+            saved = drumMachine.saveState (sink);
+        }
+
+        if (! saved)
+            destData.reset();
     }
 
     void setStateInformation (const void* data, int sizeInBytes) override
     {
-        auto xml = juce::XmlDocument::parse (juce::String ((const char*) data, sizeInBytes));
+        auto* bytes = static_cast<const uint8_t*> (data);
 
-        if (xml != nullptr)
+        if (sizeInBytes >= 8 && juce::ByteOrder::bigEndianInt (bytes) == kStateMagic)
         {
-            auto state = juce::ValueTree::fromXml (*xml);
+            if (! drumMachine.loadState (bytes + 8, sizeInBytes - 8))
+                return;
 
-            if (state.isValid())
-            {
-                *tempoParam = state.getProperty ("tempo", 120.0f);
-                *swingParam = state.getProperty ("swing", 0.0f);
-                *masterVolumeParam = state.getProperty ("master", 0.8f);
-                *patternLengthParam = state.getProperty ("patternLength", 16.0f);
-                *pocketOffsetParam = state.getProperty ("pocketOffset", 0.0f);
-                *pushOffsetParam = state.getProperty ("pushOffset", -0.04f);
-                *pullOffsetParam = state.getProperty ("pullOffset", 0.06f);
-                *dillaAmountParam = state.getProperty ("dillaAmount", 0.6f);
-                *dillaHatBiasParam = state.getProperty ("dillaHatBias", 0.55f);
-                *dillaSnareLateParam = state.getProperty ("dillaSnareLate", 0.8f);
-                *dillaKickTightParam = state.getProperty ("dillaKickTight", 0.7f);
-                *dillaMaxDriftParam = state.getProperty ("dillaMaxDrift", 0.15f);
-                *structureParam = state.getProperty ("structure", 0.5f);
-                *stereoWidthParam = state.getProperty ("stereoWidth", 0.5f);
-                *roomWidthParam = state.getProperty ("roomWidth", 0.3f);
-                *effectsWidthParam = state.getProperty ("effectsWidth", 0.7f);
-
-                currentPresetIndex = state.getProperty ("preset", 0);
-
-                if (currentPresetIndex >= 0 && currentPresetIndex < static_cast<int>(factoryPresets.size()))
-                {
-                    currentPreset = factoryPresets[currentPresetIndex];
-                }
-            }
+            setCurrentPresetIndex (static_cast<int> (juce::ByteOrder::littleEndianInt (bytes + 4)));
+
+            // Host parameters follow the restored DSP values
+            for (const auto& binding : parameterBindings)
+                *binding.param = drumMachine.getParameter (binding.id);
+
+            // Custom routing has no choice entry; keep it until the host
+            // picks a layout
+            const auto layout = static_cast<int> (drumMachine.getOutputBusLayout());
+            if (layout < outputLayoutParam->choices.size())
+                *outputLayoutParam = layout;
+            appliedOutputLayout = outputLayoutParam->getIndex();
+        }
+        else
+        {
+            setLegacyStateInformation (data, sizeInBytes);
         }
 
-        applyPresetToDSP();
+        // Restored host values win over the preset defaults
+        updateDSPParameters();
+    }
+
+    // Sessions saved before the binary state: a ValueTree stream (or XML)
+    // of the global parameters
+    void setLegacyStateInformation (const void* data, int sizeInBytes)
+    {
+        auto state = juce::ValueTree::readFromData (data, static_cast<size_t> (sizeInBytes));
+
+        if (! state.isValid())
+            if (auto xml = juce::XmlDocument::parse (juce::String ((const char*) data, static_cast<size_t> (sizeInBytes))))
+                state = juce::ValueTree::fromXml (*xml);
+
+        if (! state.isValid())
+            return;
+
+        *tempoParam = state.getProperty ("tempo", 120.0f);
+        *swingParam = state.getProperty ("swing", 0.0f);
+        *masterVolumeParam = state.getProperty ("master", 0.8f);
+        *patternLengthParam = state.getProperty ("patternLength", 16.0f);
+        *pocketOffsetParam = state.getProperty ("pocketOffset", 0.0f);
+        *pushOffsetParam = state.getProperty ("pushOffset", -0.04f);
+        *pullOffsetParam = state.getProperty ("pullOffset", 0.06f);
+        *dillaAmountParam = state.getProperty ("dillaAmount", 0.6f);
+        *dillaHatBiasParam = state.getProperty ("dillaHatBias", 0.55f);
+        *dillaSnareLateParam = state.getProperty ("dillaSnareLate", 0.8f);
+        *dillaKickTightParam = state.getProperty ("dillaKickTight", 0.7f);
+        *dillaMaxDriftParam = state.getProperty ("dillaMaxDrift", 0.15f);
+        *structureParam = state.getProperty ("structure", 0.5f);
+        *stereoWidthParam = state.getProperty ("stereoWidth", 0.5f);
+        *roomWidthParam = state.getProperty ("roomWidth", 0.3f);
+        *effectsWidthParam = state.getProperty ("effectsWidth", 0.7f);
+
+        setCurrentPresetIndex (state.getProperty ("preset", 0));
+    }
+
+    void setCurrentPresetIndex (int index)
+    {
+        currentPresetIndex = index;
+
+        if (currentPresetIndex >= 0 && currentPresetIndex < static_cast<int>(factoryPresets.size()))
+            currentPreset = factoryPresets[currentPresetIndex];
     }
 
 private:
@@ -474,6 +583,30 @@ private:
         minimal.structure = 0.1f;
         minimal.stereoWidth = 0.3f;
         factoryPresets.push_back (minimal);
+
+        // Decode once; program changes then just apply the bank entry
+        presetBank.clear();
+        for (const auto& preset : factoryPresets)
+            presetBank.addDecoded (preset.name.toStdString(), toDecodedPreset (preset));
+    }
+
+    static DSP::DecodedPreset toDecodedPreset (const Preset& preset)
+    {
+        DSP::DecodedPreset decoded;
+        decoded.setParameter (DSP::DrumParam::Tempo, preset.tempo);
+        decoded.setParameter (DSP::DrumParam::Swing, preset.swing);
+        decoded.setParameter (DSP::DrumParam::MasterVolume, preset.masterVolume);
+        decoded.setParameter (DSP::DrumParam::PocketOffset, preset.pocketOffset);
+        decoded.setParameter (DSP::DrumParam::PushOffset, preset.pushOffset);
+        decoded.setParameter (DSP::DrumParam::PullOffset, preset.pullOffset);
+        decoded.setParameter (DSP::DrumParam::DillaAmount, preset.dillaAmount);
+        decoded.setParameter (DSP::DrumParam::DillaHatBias, preset.dillaHatBias);
+        decoded.setParameter (DSP::DrumParam::DillaSnareLate, preset.dillaSnareLate);
+        decoded.setParameter (DSP::DrumParam::DillaKickTight, preset.dillaKickTight);
+        decoded.setParameter (DSP::DrumParam::DillaMaxDrift, preset.dillaMaxDrift);
+        decoded.setParameter (DSP::DrumParam::Structure, preset.structure);
+        decoded.setParameter (DSP::DrumParam::StereoWidth, preset.stereoWidth);
+        return decoded;
     }
 
     //==============================================================================
@@ -482,19 +615,23 @@ private:
     */
     void applyPresetToDSP()
     {
-        drumMachine.setParameter ("tempo", currentPreset.tempo);
-        drumMachine.setParameter ("swing", currentPreset.swing);
-        drumMachine.setParameter ("masterVolume", currentPreset.masterVolume);
-        drumMachine.setParameter ("pocketOffset", currentPreset.pocketOffset);
-        drumMachine.setParameter ("pushOffset", currentPreset.pushOffset);
-        drumMachine.setParameter ("pullOffset", currentPreset.pullOffset);
-        drumMachine.setParameter ("dillaAmount", currentPreset.dillaAmount);
-        drumMachine.setParameter ("dillaHatBias", currentPreset.dillaHatBias);
-        drumMachine.setParameter ("dillaSnareLate", currentPreset.dillaSnareLate);
-        drumMachine.setParameter ("dillaKickTight", currentPreset.dillaKickTight);
-        drumMachine.setParameter ("dillaMaxDrift", currentPreset.dillaMaxDrift);
-        drumMachine.setParameter ("structure", currentPreset.structure);
-        drumMachine.setParameter ("stereoWidth", currentPreset.stereoWidth);
+        // No parsing here: the bank holds the decoded preset, and its
+        // pattern/drill state (if any) swaps in at the next bar
+        auto decoded = presetBank.get (currentPresetIndex);
+        if (decoded == nullptr)
+            return;
+
+        drumMachine.applyPreset (*decoded);
+
+        // Set the host parameters so automation and the DSP agree
+        for (const auto& binding : parameterBindings)
+        {
+            const auto index = static_cast<int> (binding.id);
+            if (decoded->paramMask & (uint64_t (1) << index))
+                *binding.param = decoded->params[static_cast<size_t> (index)];
+        }
+
+        updateDSPParameters();
     }
 
     //==============================================================================
@@ -503,28 +640,15 @@ private:
     */
     void updateDSPParameters()
     {
-        drumMachine.setParameter ("tempo", tempoParam->get());
-        drumMachine.setParameter ("swing", swingParam->get());
-        drumMachine.setParameter ("masterVolume", masterVolumeParam->get());
-        drumMachine.setParameter ("patternLength", patternLengthParam->get());
-        drumMachine.setParameter ("pocketOffset", pocketOffsetParam->get());
-        drumMachine.setParameter ("pushOffset", pushOffsetParam->get());
-        drumMachine.setParameter ("pullOffset", pullOffsetParam->get());
-        drumMachine.setParameter ("dillaAmount", dillaAmountParam->get());
-        drumMachine.setParameter ("dillaHatBias", dillaHatBiasParam->get());
-        drumMachine.setParameter ("dillaSnareLate", dillaSnareLateParam->get());
-        drumMachine.setParameter ("dillaKickTight", dillaKickTightParam->get());
-        drumMachine.setParameter ("dillaMaxDrift", dillaMaxDriftParam->get());
-        drumMachine.setParameter ("structure", structureParam->get());
-        drumMachine.setParameter ("stereoWidth", stereoWidthParam->get());
-        drumMachine.setParameter ("roomWidth", roomWidthParam->get());
-        drumMachine.setParameter ("effectsWidth", effectsWidthParam->get());
-
-        // Update track volumes
-        for (int i = 0; i < 16; ++i)
+        // Integer IDs, no strings; the DSP drops values that did not change
+        for (const auto& binding : parameterBindings)
+            drumMachine.setParameter (binding.id, binding.param->get());
+
+        const int layout = outputLayoutParam->getIndex();
+        if (layout != appliedOutputLayout)
         {
-            auto paramName = "trackVolume_" + std::to_string(i);
-            drumMachine.setParameter (paramName.c_str(), trackVolumeParams[i]->get());
+            drumMachine.setOutputBusLayout (static_cast<DSP::OutputBusLayout> (layout));
+            appliedOutputLayout = layout;
         }
     }
 
@@ -559,8 +683,36 @@ private:
     // Track volumes (16 tracks)
     juce::AudioParameterFloat* trackVolumeParams[16];
 
+    // Output routing; applied only when it changes
+    juce::AudioParameterChoice* outputLayoutParam;
+    int appliedOutputLayout = -1;
+
+    struct ParameterBinding
+    {
+        juce::AudioParameterFloat* param;
+        DSP::DrumParam id;
+    };
+    std::vector<ParameterBinding> parameterBindings;
+
+    // Plugin state header ("DMS1")
+    static constexpr juce::uint32 kStateMagic = 0x444d5331;
+
+    // Feeds a streamed DSP save into a JUCE stream
+    struct StreamStateSink  : public DSP::StateSink
+    {
+        explicit StreamStateSink (juce::OutputStream& s) : stream (s) {}
+
+        bool write (const void* data, int numBytes) override
+        {
+            return stream.write (data, static_cast<size_t> (numBytes));
+        }
+
+        juce::OutputStream& stream;
+    };
+
     // Preset system
     std::vector<Preset> factoryPresets;
+    DSP::PresetBank presetBank;
     Preset currentPreset;
     int currentPresetIndex;
 
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    DrumMachineHitCache.cpp
+    Pre-rendered one-shot hits per voice group and velocity layer, built
+    on a background thread when the kit or sample rate changes
+
+  ==============================================================================
+*/
+
+#include "dsp/DrumMachinePureDSP.h"
+
+namespace DSP {
+
+namespace {
+
+constexpr int kRenderBlock = 256;
+
+// Appends one hit of a freshly prepared voice to samples, until the voice
+// goes quiet (its isActive() threshold) or the length cap
+template <typename Voice>
+HitCacheLayer renderLayer(std::vector<float>& samples, double sampleRate, float velocity)
+{
+    Voice voice;
+    voice.prepare(sampleRate);
+    voice.trigger(velocity);
+
+    const size_t start = samples.size();
+    int length = 0;
+    while (voice.isActive() && length < HitCacheBank::kMaxHitSamples)
+    {
+        samples.resize(start + length + kRenderBlock, 0.0f);
+        voice.processBlock(samples.data() + start + length, kRenderBlock);
+        length += kRenderBlock;
+    }
+
+    // The last block ends in silence once the voice went to sleep
+    while (length > 0 && samples[start + length - 1] == 0.0f)
+        --length;
+    samples.resize(start + length);
+
+    HitCacheLayer layer;
+    layer.length = length;
+    layer.velocity = velocity;
+    return layer;
+}
+
+template <typename Voice>
+void renderGroup(HitCacheBank& bank, int group, double sampleRate)
+{
+    for (int l = 0; l < kHitCacheLayers; ++l)
+        bank.layers[group][l] = renderLayer<Voice>(bank.samples, sampleRate, static_cast<float>(l + 1) / kHitCacheLayers);
+}
+
+} // namespace
+
+//==============================================================================
+// HitCache
+//==============================================================================
+
+void HitCache::render(HitCacheBank& bank, uint32_t generation, double sampleRate)
+{
+    bank.samples.clear();
+
+    // Same registered voice per group as the sequencer's pools
+    forEachDrumVoiceType([&](auto group)
+    {
+        constexpr int index = decltype(group)::value;
+        renderGroup<typename DrumVoiceTraitsAt<index>::Voice>(bank, index, sampleRate);
+    });
+
+    // Every layer is in place: point into the (now stable) buffer
+    size_t offset = 0;
+    for (auto& group : bank.layers)
+    {
+        for (HitCacheLayer& layer : group)
+        {
+            layer.samples = bank.samples.data() + offset;
+            offset += static_cast<size_t>(layer.length);
+        }
+    }
+
+    bank.generation = generation;
+    bank.sampleRate = sampleRate;
+}
+
+void HitCache::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread([this] { run(); });
+}
+
+void HitCache::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void HitCache::request(uint32_t generation, double sampleRate)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requestedGeneration_ = generation;
+        requestedSampleRate_ = sampleRate;
+        pending_ = true;
+    }
+    wake_.notify_all();
+}
+
+void HitCache::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+        wake_.wait(lock, [this] { return pending_ || stopping_; });
+        if (stopping_) break;
+
+        const uint32_t generation = requestedGeneration_;
+        const double sampleRate = requestedSampleRate_;
+        pending_ = false;
+
+        // Still changing (a kit being edited): start over once it settles
+        if (wake_.wait_for(lock, kSettleTime, [this] { return pending_ || stopping_; }))
+            continue;
+
+        lock.unlock();
+        render(banks_.back(), generation, sampleRate);
+        banks_.publish();
+        builds_.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+}
+
+} // namespace DSP
@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    DrumMachinePresetBank.cpp
+    Decoded preset cache with background preloading and an LRU memory bound
+
+  ==============================================================================
+*/
+
+#include "dsp/DrumMachinePureDSP.h"
+
+namespace DSP {
+
+//==============================================================================
+// PresetBank
+//==============================================================================
+
+PresetBank::PresetBank(size_t maxCachedBytes)
+    : maxCachedBytes_(maxCachedBytes)
+{
+}
+
+PresetBank::~PresetBank()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wake_.notify_all();
+
+    if (worker_.joinable())
+        worker_.join();
+}
+
+int PresetBank::addPreset(const std::string& name, const std::string& json, int sections)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    entry.name = name;
+    entry.source = std::make_shared<const std::string>(json);
+    entry.sections = sections;
+    entries_.push_back(std::move(entry));
+    return static_cast<int>(entries_.size()) - 1;
+}
+
+int PresetBank::addState(const std::string& name, const uint8_t* data, int size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    entry.name = name;
+    entry.source = std::make_shared<const std::string>(reinterpret_cast<const char*>(data),
+                                                       data != nullptr ? static_cast<size_t>(std::max(0, size)) : 0);
+    entry.binary = true;
+    entries_.push_back(std::move(entry));
+    return static_cast<int>(entries_.size()) - 1;
+}
+
+int PresetBank::addDecoded(const std::string& name, const DecodedPreset& preset)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    entry.name = name;
+    entry.decoded = std::make_shared<const DecodedPreset>(preset);
+    entries_.push_back(std::move(entry));
+    return static_cast<int>(entries_.size()) - 1;
+}
+
+void PresetBank::clear()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.clear();
+    idle_.wait(lock, [this] { return !decoding_; });
+
+    entries_.clear();
+    lru_.clear();
+    cachedBytes_ = 0;
+}
+
+int PresetBank::getNumPresets() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(entries_.size());
+}
+
+std::string PresetBank::getName(int index) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < 0 || index >= static_cast<int>(entries_.size())) return {};
+    return entries_[index].name;
+}
+
+void PresetBank::preload(int index)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index < 0 || index >= static_cast<int>(entries_.size()) || entries_[index].decoded != nullptr)
+            return;
+
+        queue_.push_back(index);
+        if (!worker_.joinable())
+            worker_ = std::thread([this] { workerLoop(); });
+    }
+    wake_.notify_one();
+}
+
+void PresetBank::preloadAll()
+{
+    const int numPresets = getNumPresets();
+    for (int i = 0; i < numPresets; ++i)
+        preload(i);
+}
+
+void PresetBank::waitForPreload()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && !decoding_; });
+}
+
+std::shared_ptr<const DecodedPreset> PresetBank::get(int index)
+{
+    std::shared_ptr<const std::string> source;
+    bool binary = false;
+    int sections = PRESET_ALL;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index < 0 || index >= static_cast<int>(entries_.size())) return nullptr;
+
+        Entry& entry = entries_[index];
+        if (entry.decoded != nullptr)
+        {
+            ++stats_.hits;
+            touch(index);
+            return entry.decoded;
+        }
+
+        ++stats_.misses;
+        source = entry.source;
+        binary = entry.binary;
+        sections = entry.sections;
+    }
+
+    // Cache miss: decode here, outside the lock
+    std::shared_ptr<const DecodedPreset> decoded = decode(*source, binary, sections);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decoded == nullptr)
+    {
+        ++stats_.decodeErrors;
+        return nullptr;
+    }
+    if (index < static_cast<int>(entries_.size()) && entries_[index].source == source)
+    {
+        // The preload thread may have got there first
+        if (entries_[index].decoded != nullptr)
+            return entries_[index].decoded;
+        store(index, decoded);
+    }
+    return decoded;
+}
+
+bool PresetBank::isCached(int index) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index >= 0 && index < static_cast<int>(entries_.size()) && entries_[index].decoded != nullptr;
+}
+
+void PresetBank::setMaxCachedBytes(size_t maxCachedBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxCachedBytes_ = maxCachedBytes;
+    evictToLimit();
+}
+
+size_t PresetBank::getCachedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cachedBytes_;
+}
+
+PresetBankStats PresetBank::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::shared_ptr<const DecodedPreset> PresetBank::decode(const std::string& source, bool binary, int sections)
+{
+    auto preset = std::make_shared<DecodedPreset>();
+    const bool valid = binary
+        ? DrumMachinePureDSP::decodeState(reinterpret_cast<const uint8_t*>(source.data()), static_cast<int>(source.size()), *preset)
+        : DrumMachinePureDSP::decodePreset(source.c_str(), sections, *preset);
+    return valid ? preset : nullptr;
+}
+
+void PresetBank::touch(int index)
+{
+    Entry& entry = entries_[index];
+    if (entry.inLru)
+        lru_.splice(lru_.begin(), lru_, entry.lruPosition);
+}
+
+void PresetBank::store(int index, std::shared_ptr<const DecodedPreset> decoded)
+{
+    Entry& entry = entries_[index];
+    entry.bytes = decoded->getMemoryUsage();
+    entry.decoded = std::move(decoded);
+    entry.lruPosition = lru_.insert(lru_.begin(), index);
+    entry.inLru = true;
+    cachedBytes_ += entry.bytes;
+    evictToLimit();
+}
+
+void PresetBank::evictToLimit()
+{
+    // The most recent entry always stays, whatever the bound
+    while (cachedBytes_ > maxCachedBytes_ && lru_.size() > 1)
+    {
+        Entry& victim = entries_[lru_.back()];
+        lru_.pop_back();
+        victim.inLru = false;
+        victim.decoded.reset();
+        cachedBytes_ -= victim.bytes;
+        victim.bytes = 0;
+        ++stats_.evictions;
+    }
+}
+
+void PresetBank::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        const int index = queue_.front();
+        queue_.pop_front();
+        if (index >= static_cast<int>(entries_.size()) || entries_[index].decoded != nullptr)
+        {
+            if (queue_.empty()) idle_.notify_all();
+            continue;
+        }
+
+        std::shared_ptr<const std::string> source = entries_[index].source;
+        const bool binary = entries_[index].binary;
+        const int sections = entries_[index].sections;
+        decoding_ = true;
+
+        lock.unlock();
+        std::shared_ptr<const DecodedPreset> decoded = decode(*source, binary, sections);
+        lock.lock();
+
+        decoding_ = false;
+        if (decoded == nullptr)
+            ++stats_.decodeErrors;
+        else if (index < static_cast<int>(entries_.size()) && entries_[index].source == source
+                 && entries_[index].decoded == nullptr)
+            store(index, std::move(decoded));
+
+        if (queue_.empty()) idle_.notify_all();
+    }
+}
+
+} // namespace DSP
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    DrumMachineTelemetry.cpp
+    Parameter change telemetry: wait-free recording on the audio thread,
+    draining and logging on one shared background thread
+
+  ==============================================================================
+*/
+
+#include "dsp/DrumMachinePureDSP.h"
+#include "../../../../include/dsp/DSPLogging.h"
+#include <chrono>
+
+namespace DSP {
+
+namespace {
+
+// Drains every registered ring and logs its records. One thread serves all
+// instances; it starts with the first registration.
+class TelemetryThread
+{
+public:
+    static TelemetryThread& get()
+    {
+        static TelemetryThread thread;
+        return thread;
+    }
+
+    ~TelemetryThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void add(ParameterTelemetry* telemetry)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(telemetry);
+        if (!thread_.joinable())
+            thread_ = std::thread([this] { run(); });
+    }
+
+    // Once this returns the ring is no longer touched (draining holds mutex_)
+    void remove(ParameterTelemetry* telemetry)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.erase(std::remove(rings_.begin(), rings_.end(), telemetry), rings_.end());
+    }
+
+private:
+    static constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_)
+        {
+            wake_.wait_for(lock, kDrainInterval);
+            for (ParameterTelemetry* telemetry : rings_)
+            {
+                telemetry->drain([](const TelemetryRecord& record)
+                {
+                    LOG_PARAMETER_CHANGE("DrumMachine", getDrumParamInfo(record.param).id,
+                                         record.oldValue, record.newValue);
+                });
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<ParameterTelemetry*> rings_;
+    std::thread thread_;
+    bool stopping_ = false;
+};
+
+} // namespace
+
+//==============================================================================
+// ParameterTelemetry
+//==============================================================================
+
+void ParameterTelemetry::push(DrumParam param, float oldValue, float newValue)
+{
+    // One producer at a time; the loser drops rather than waits
+    if (producing_.exchange(true, std::memory_order_acquire))
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (param == lastParam_ && newValue == lastValue_)
+    {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kCapacity)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            records_[head % kCapacity] = TelemetryRecord{ param, oldValue, newValue, 1 };
+            head_.store(head + 1, std::memory_order_release);
+            recorded_.fetch_add(1, std::memory_order_relaxed);
+            lastParam_ = param;
+            lastValue_ = newValue;
+        }
+    }
+
+    producing_.store(false, std::memory_order_release);
+}
+
+void ParameterTelemetry::startLogging()
+{
+    if (logging_) return;
+    logging_ = true;
+    TelemetryThread::get().add(this);
+}
+
+void ParameterTelemetry::stopLogging()
+{
+    if (!logging_) return;
+    logging_ = false;
+    TelemetryThread::get().remove(this);
+}
+
+TelemetryStats ParameterTelemetry::getStats() const
+{
+    TelemetryStats stats;
+    stats.recorded = recorded_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace DSP
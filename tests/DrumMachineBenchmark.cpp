@@ -0,0 +1,351 @@
+/*
+  ==============================================================================
+
+    DrumMachineBenchmark.cpp
+
+    Render-cost benchmarks for Drum Machine: voices, full mix, drill
+    presets, batched instances, parameter dispatch and preset I/O, swept
+    over block sizes and sample rates. Prints one CSV row per measurement.
+
+    Usage: DrumMachineBenchmark [--quick]
+
+  ==============================================================================
+*/
+
+#include "../include/dsp/DrumMachinePureDSP.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DSP;
+
+//==============================================================================
+// Measurement
+//==============================================================================
+
+struct BenchConfig {
+    std::vector<double> sampleRates;
+    std::vector<int> blockSizes;
+    double audioSeconds = 1.0;  // Audio rendered per measurement
+    int repeats = 3;            // Best of
+};
+
+double nowSeconds() {
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+// CSV row. ns_per_op is per call; for render cases a call is one sample and
+// realtime is audio time over render time (how many instances fit).
+void report(const char* group, const std::string& name, double sampleRate, int blockSize,
+            double nsPerOp, double realtime) {
+    std::printf("%s,%s,%.0f,%d,%.3f,%.1f\n", group, name.c_str(), sampleRate, blockSize, nsPerOp, realtime);
+    std::fflush(stdout);
+}
+
+// Best-of-repeats time for rendering config.audioSeconds in blocks
+template <typename RenderBlock>
+void benchRender(const BenchConfig& config, const char* group, const std::string& name,
+                 double sampleRate, int blockSize, RenderBlock&& renderBlock) {
+    const int numBlocks = std::max(1, static_cast<int>(config.audioSeconds * sampleRate / blockSize));
+
+    double best = 1.0e30;
+    for (int r = 0; r < config.repeats; ++r) {
+        const double start = nowSeconds();
+        for (int b = 0; b < numBlocks; ++b)
+            renderBlock(blockSize);
+        best = std::min(best, nowSeconds() - start);
+    }
+
+    const double samples = static_cast<double>(numBlocks) * blockSize;
+    report(group, name, sampleRate, blockSize, best * 1.0e9 / samples, (samples / sampleRate) / best);
+}
+
+// Best-of-repeats time per call of op
+template <typename Op>
+void benchOp(const BenchConfig& config, const char* group, const std::string& name, int iterations, Op&& op) {
+    double best = 1.0e30;
+    for (int r = 0; r < config.repeats; ++r) {
+        const double start = nowSeconds();
+        for (int i = 0; i < iterations; ++i)
+            op(i);
+        best = std::min(best, nowSeconds() - start);
+    }
+    report(group, name, 0.0, 0, best * 1.0e9 / iterations, 0.0);
+}
+
+//==============================================================================
+// Voices: processSample and processBlock per voice type
+//==============================================================================
+
+template <typename Voice>
+void benchVoice(const BenchConfig& config, const char* name, double sampleRate, int blockSize) {
+    std::vector<float> buffer(blockSize);
+
+    // Retrigger every block so every sample is on the sounding path
+    Voice sampleVoice;
+    sampleVoice.prepare(sampleRate);
+    benchRender(config, "voice_sample", name, sampleRate, blockSize, [&](int numSamples) {
+        sampleVoice.trigger(0.9f);
+        for (int i = 0; i < numSamples; ++i)
+            buffer[i] = sampleVoice.processSample();
+    });
+
+    Voice blockVoice;
+    blockVoice.prepare(sampleRate);
+    benchRender(config, "voice_block", name, sampleRate, blockSize, [&](int numSamples) {
+        blockVoice.trigger(0.9f);
+        std::fill(buffer.begin(), buffer.begin() + numSamples, 0.0f);
+        blockVoice.processBlock(buffer.data(), numSamples);
+    });
+}
+
+// Many kick voices one by one vs side by side in a KickVoiceBank (the
+// batch kick kernel); ns_per_op is per sample of all the voices
+void benchKickBank(const BenchConfig& config, int numVoices, double sampleRate, int blockSize) {
+    std::vector<KickVoice> voices(numVoices);
+    std::vector<float> buffers(static_cast<size_t>(numVoices) * blockSize);
+    for (int v = 0; v < numVoices; ++v) {
+        voices[v].prepare(sampleRate);
+        voices[v].setPitch(0.02f * v);
+    }
+    KickVoiceBank bank;
+    bank.allocate(numVoices);
+
+    const std::string name = "kick_x" + std::to_string(numVoices);
+    benchRender(config, "voice_block", name, sampleRate, blockSize, [&](int numSamples) {
+        std::fill(buffers.begin(), buffers.end(), 0.0f);
+        for (int v = 0; v < numVoices; ++v) {
+            voices[v].trigger(0.5f + 0.01f * v);
+            voices[v].processBlock(buffers.data() + static_cast<size_t>(v) * blockSize, numSamples);
+        }
+    });
+    benchRender(config, "voice_bank", name, sampleRate, blockSize, [&](int numSamples) {
+        std::fill(buffers.begin(), buffers.end(), 0.0f);
+        for (int v = 0; v < numVoices; ++v) {
+            voices[v].trigger(0.5f + 0.01f * v);
+            bank.add(voices[v], buffers.data() + static_cast<size_t>(v) * blockSize);
+        }
+        bank.render(numSamples);
+    });
+}
+
+//==============================================================================
+// Full instrument: idle, 16 tracks, process() vs processStereo(), drill presets
+//==============================================================================
+
+SequencerSnapshot denseSnapshot() {
+    SequencerSnapshot snapshot;
+    for (int track = 0; track < 16; ++track) {
+        for (int step = track % 2; step < 16; step += 2)
+            snapshot.tracks[track].steps.edit(step).active = true;
+    }
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = false;
+    return snapshot;
+}
+
+// Kick on every step: the batch kick kernel's best case
+SequencerSnapshot kickSnapshot() {
+    SequencerSnapshot snapshot;
+    for (int step = 0; step < 16; ++step)
+        snapshot.tracks[0].steps.edit(step).active = true;
+    snapshot.tracks[0].type = Track::DrumType::Kick;
+    snapshot.parts = SequencerSnapshot::Tracks;
+    snapshot.atBar = false;
+    return snapshot;
+}
+
+SequencerSnapshot drillSnapshot(const DrillMode& preset) {
+    SequencerSnapshot snapshot = denseSnapshot();
+    snapshot.drillMode = preset;
+    snapshot.drillMode.enabled = true;
+    for (Track& track : snapshot.tracks) {
+        for (int step = 0; step < 16; ++step) {
+            if (track.steps[step].active)
+                track.steps.edit(step).useDrill = true;
+        }
+    }
+    snapshot.parts = SequencerSnapshot::All;
+    return snapshot;
+}
+
+void benchInstrument(const BenchConfig& config, const char* name, const SequencerSnapshot& snapshot,
+                     bool stereo, double sampleRate, int blockSize, bool hitCache = false) {
+    DrumMachinePureDSP dm;
+    dm.setParameter(DrumParam::Tempo, 174.0f);
+    dm.setParameter(DrumParam::StereoWidth, 0.6f);
+    dm.prepare(sampleRate, blockSize);
+    dm.publishPattern(snapshot);
+
+    // Measure playback from the cache, not the synthesis while it builds
+    if (hitCache) {
+        dm.setHitCacheEnabled(true);
+        while (dm.getHitCacheBuildCount() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    std::vector<float> left(blockSize);
+    std::vector<float> right(blockSize);
+    float* outputs[2] = { left.data(), right.data() };
+    benchRender(config, stereo ? "process_stereo" : "process", name, sampleRate, blockSize, [&](int numSamples) {
+        if (stereo)
+            dm.processStereo(outputs, 2, numSamples);
+        else
+            dm.process(outputs, 2, numSamples);
+    });
+}
+
+// Instances rendered serially vs sharded across threads, each with the
+// kicks per instance or in the shared kick kernel; ns_per_op is per sample
+// of one instance
+void benchBatch(const BenchConfig& config, const char* pattern, const SequencerSnapshot& snapshot, int numInstances,
+                int numThreads, bool kickKernel, double sampleRate, int blockSize) {
+    DrumMachineBatch batch(numInstances);
+    for (int i = 0; i < numInstances; ++i) {
+        batch.getInstance(i).setParameter(DrumParam::Tempo, 174.0f);
+        batch.getInstance(i).publishPattern(snapshot);
+    }
+    batch.setKickKernel(kickKernel);
+    batch.prepare(sampleRate, blockSize, numThreads);
+
+    std::vector<float> buffer(static_cast<size_t>(numInstances) * 2 * blockSize);
+    std::vector<float*> outputs(static_cast<size_t>(numInstances) * 2);
+    for (size_t ch = 0; ch < outputs.size(); ++ch)
+        outputs[ch] = buffer.data() + ch * blockSize;
+
+    const std::string name = std::string(pattern) + "_x" + std::to_string(numInstances) + "_t" + std::to_string(numThreads)
+                           + (kickKernel ? "_kick_kernel" : "_sharded");
+    const int numBlocks = std::max(1, static_cast<int>(config.audioSeconds * sampleRate / blockSize));
+    double best = 1.0e30;
+    for (int r = 0; r < config.repeats; ++r) {
+        const double start = nowSeconds();
+        for (int b = 0; b < numBlocks; ++b)
+            batch.process(outputs.data(), 2, blockSize);
+        best = std::min(best, nowSeconds() - start);
+    }
+
+    const double samples = static_cast<double>(numBlocks) * blockSize;
+    report("batch", name, sampleRate, blockSize, best * 1.0e9 / (samples * numInstances),
+           numInstances * (samples / sampleRate) / best);
+}
+
+//==============================================================================
+// Parameter dispatch and preset I/O
+//==============================================================================
+
+void benchParameters(const BenchConfig& config) {
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+
+    // Alternate values so every call is a real change
+    benchOp(config, "set_parameter", "enum", 100000, [&](int i) {
+        dm.setParameter(static_cast<DrumParam>(i % kNumDrumParams), (i & 1) ? 0.25f : 0.75f);
+    });
+    benchOp(config, "set_parameter", "string_id", 100000, [&](int i) {
+        dm.setParameter(getDrumParamInfo(static_cast<DrumParam>(i % kNumDrumParams)).id, (i & 1) ? 0.25f : 0.75f);
+    });
+    benchOp(config, "set_parameter", "unchanged", 100000, [&](int) {
+        dm.setParameter(DrumParam::Swing, 0.5f);
+    });
+}
+
+void benchPresets(const BenchConfig& config) {
+    DrumMachinePureDSP dm;
+    dm.prepare(48000.0, 512);
+    dm.publishPattern(drillSnapshot(StepSequencer::presetTimeGrinder()));
+    std::vector<float> left(512);
+    std::vector<float> right(512);
+    float* outputs[2] = { left.data(), right.data() };
+    dm.process(outputs, 2, 512);
+
+    std::vector<char> json(256 * 1024);
+    dm.savePreset(json.data(), static_cast<int>(json.size()));
+    std::vector<uint8_t> state(dm.saveState(nullptr, 0));
+    dm.saveState(state.data(), static_cast<int>(state.size()));
+
+    DrumMachinePureDSP target;
+    target.prepare(48000.0, 512);
+    std::vector<char> scratch(json.size());
+    benchOp(config, "preset", "json_save", 200, [&](int) {
+        dm.savePreset(scratch.data(), static_cast<int>(scratch.size()));
+    });
+    benchOp(config, "preset", "json_load", 200, [&](int) {
+        target.loadPreset(json.data());
+    });
+    benchOp(config, "preset", "state_save", 200, [&](int) {
+        dm.saveState(state.data(), static_cast<int>(state.size()));
+    });
+    struct DiscardSink : StateSink {
+        bool write(const void*, int) override { return true; }
+    } discard;
+    benchOp(config, "preset", "json_stream", 200, [&](int) {
+        dm.savePreset(discard);
+    });
+    benchOp(config, "preset", "state_stream", 200, [&](int) {
+        dm.saveState(discard);
+    });
+    benchOp(config, "preset", "state_load", 200, [&](int) {
+        target.loadState(state.data(), static_cast<int>(state.size()));
+    });
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.sampleRates = { 44100.0, 48000.0, 96000.0 };
+    config.blockSizes = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            config.sampleRates = { 48000.0 };
+            config.blockSizes = { 32, 512, 4096 };
+            config.audioSeconds = 0.1;
+            config.repeats = 1;
+        }
+    }
+
+    std::printf("group,case,sample_rate,block_size,ns_per_op,realtime\n");
+
+    SequencerSnapshot idle;
+    idle.parts = SequencerSnapshot::Tracks;
+    idle.atBar = false;
+    const SequencerSnapshot dense = denseSnapshot();
+    const SequencerSnapshot kicks = kickSnapshot();
+    const SequencerSnapshot seizure = drillSnapshot(StepSequencer::presetDigitalSeizure());
+    const SequencerSnapshot grinder = drillSnapshot(StepSequencer::presetTimeGrinder());
+
+    for (double sampleRate : config.sampleRates) {
+        for (int blockSize : config.blockSizes) {
+            benchVoice<KickVoice>(config, "kick", sampleRate, blockSize);
+            benchVoice<SnareVoice>(config, "snare", sampleRate, blockSize);
+            benchVoice<HiHatVoice>(config, "hihat", sampleRate, blockSize);
+            benchVoice<ClapVoice>(config, "clap", sampleRate, blockSize);
+            benchVoice<PercVoice>(config, "perc", sampleRate, blockSize);
+            benchVoice<CymbalVoice>(config, "cymbal", sampleRate, blockSize);
+            benchKickBank(config, 32, sampleRate, blockSize);
+
+            benchInstrument(config, "idle", idle, false, sampleRate, blockSize);
+            benchInstrument(config, "full16", dense, false, sampleRate, blockSize);
+            benchInstrument(config, "full16", dense, true, sampleRate, blockSize);
+            benchInstrument(config, "drill_digital_seizure", seizure, false, sampleRate, blockSize);
+            benchInstrument(config, "drill_time_grinder", grinder, false, sampleRate, blockSize);
+            benchInstrument(config, "full16_hit_cache", dense, false, sampleRate, blockSize, true);
+            benchInstrument(config, "drill_time_grinder_hit_cache", grinder, false, sampleRate, blockSize, true);
+
+            const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            for (bool kickKernel : { false, true }) {
+                benchBatch(config, "full16", dense, 64, 1, kickKernel, sampleRate, blockSize);
+                benchBatch(config, "kick16", kicks, 64, 1, kickKernel, sampleRate, blockSize);
+                if (hardwareThreads > 1)
+                    benchBatch(config, "full16", dense, 64, hardwareThreads, kickKernel, sampleRate, blockSize);
+            }
+        }
+    }
+
+    benchParameters(config);
+    benchPresets(config);
+    return 0;
+}